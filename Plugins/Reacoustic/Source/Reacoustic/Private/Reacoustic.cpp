@@ -3,6 +3,74 @@
 
 #include "Reacoustic.h"
 #include "ReacousticSubsystem.h"
+#include "ReacousticComponent.h"
+#include "ReacousticRingBuffer.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogReacoustic);
+
+#if !UE_BUILD_SHIPPING
+/** Compares the ring buffer used for the hit history against the array based history it replaced.
+ *	Both histories are capped at UReacousticComponent::HitHistorySize elements and queried for their sum after every push,
+ *	like in UReacousticComponent::FilterImpact. */
+static void BenchmarkHitHistory(const TArray<FString>& Args)
+{
+	const int32 Iterations {Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000000};
+	if (Iterations <= 0) { return; }
+
+	constexpr int32 HistorySize {UReacousticComponent::HitHistorySize};
+
+	FRandomStream RandomStream {1337};
+	TArray<float> Values;
+	Values.SetNumUninitialized(1024);
+	for (float& Value : Values)
+	{
+		Value = RandomStream.FRandRange(0.0f, 2.0f);
+	}
+
+	double ArrayChecksum {0.0};
+	const double ArrayStartTime {FPlatformTime::Seconds()};
+	{
+		TArray<float> History;
+		History.Reserve(HistorySize);
+		for (int32 Index {0}; Index < Iterations; ++Index)
+		{
+			if (History.Num() == HistorySize)
+			{
+				History.RemoveAt(0);
+			}
+			History.Add(Values[Index & 1023]);
+			float Sum {0.0f};
+			for (const float Element : History)
+			{
+				Sum += Element;
+			}
+			ArrayChecksum += Sum;
+		}
+	}
+	const double ArrayTime {FPlatformTime::Seconds() - ArrayStartTime};
+
+	double RingBufferChecksum {0.0};
+	const double RingBufferStartTime {FPlatformTime::Seconds()};
+	{
+		TStaticRingBuffer<float, HistorySize> History;
+		for (int32 Index {0}; Index < Iterations; ++Index)
+		{
+			History.Push(Values[Index & 1023]);
+			RingBufferChecksum += History.GetSum();
+		}
+	}
+	const double RingBufferTime {FPlatformTime::Seconds() - RingBufferStartTime};
+
+	UE_LOG(LogReacoustic, Display, TEXT("Reacoustic hit history, %d pushes: TArray %.3f ms (checksum %.1f), TStaticRingBuffer %.3f ms (checksum %.1f)."),
+		Iterations, ArrayTime * 1000.0, ArrayChecksum, RingBufferTime * 1000.0, RingBufferChecksum);
+}
+
+static FAutoConsoleCommand BenchmarkHitHistoryCommand(
+	TEXT("Reacoustic.BenchmarkHitHistory"),
+	TEXT("Benchmarks the ring buffer used for the Reacoustic hit history against a TArray. Optional argument: iteration count."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkHitHistory));
+#endif
 
 void FReacousticModule::StartupModule()
 {
@@ -3,24 +3,36 @@
 
 #include "ReacousticAudioComponentManager.h"
 #include "ReacousticSubsystem.h"
+#include "ReacousticSettings.h"
 #include "Components/AudioComponent.h"
+#include "GameFramework/PlayerController.h"
 
 DEFINE_LOG_CATEGORY_CLASS(UReacousticAudioComponentManager, LogReacousticAudioComponentManager);
 
 void UReacousticAudioComponentManager::Initialize(UReacousticSubsystem* Subsystem)
 {
 	Super::Initialize(Subsystem);
+
+	UWorld* World {Subsystem ? Subsystem->GetWorld() : nullptr};
+	if (!World) { return; }
 	
-	constexpr int32 AudioComponentAmount {32};
+	const int32 AudioComponentAmount {FMath::Max(1, GetDefault<UReacousticProjectSettings>()->VoicePoolSize)};
 	
 	for (int32 i {0}; i < AudioComponentAmount; ++i)
 	{
 		if (UAudioComponent* NewAudioComponent {NewObject<UAudioComponent>(Owner)})
 		{
+			NewAudioComponent->bAutoActivate = false;
+			NewAudioComponent->bAutoDestroy = false;
+			NewAudioComponent->OnAudioFinishedNative.AddUObject(this, &UReacousticAudioComponentManager::HandleAudioFinished);
+			NewAudioComponent->RegisterComponentWithWorld(World);
 			AvailableAudioComponents.Add(NewAudioComponent);
 		}
 	}
 
+	ActiveAudioComponents.Reserve(AudioComponentAmount);
+	ActiveVoiceStates.Reserve(AudioComponentAmount);
+
 	if (AvailableAudioComponents.Num() != AudioComponentAmount)
 	{
 		UE_LOG(LogReacousticAudioComponentManager, Warning, TEXT("Failed to populate AudioComponent pool. Expected: '%d', Created: '%d'"), AudioComponentAmount, AvailableAudioComponents.Num());
@@ -30,3 +42,133 @@ void UReacousticAudioComponentManager::Initialize(UReacousticSubsystem* Subsyste
 		UE_LOG(LogReacousticAudioComponentManager, Log, TEXT("Successfully initialized ReacousticAudioComponentManager"));
 	}
 }
+
+void UReacousticAudioComponentManager::Deinitialize(UReacousticSubsystem* Subsystem)
+{
+	for (UAudioComponent* AudioComponent : ActiveAudioComponents)
+	{
+		AvailableAudioComponents.Add(AudioComponent);
+	}
+	ActiveAudioComponents.Empty();
+	ActiveVoiceStates.Empty();
+
+	for (UAudioComponent* AudioComponent : AvailableAudioComponents)
+	{
+		if (AudioComponent)
+		{
+			AudioComponent->OnAudioFinishedNative.RemoveAll(this);
+			AudioComponent->Stop();
+			AudioComponent->DestroyComponent();
+		}
+	}
+	AvailableAudioComponents.Empty();
+
+	Super::Deinitialize(Subsystem);
+}
+
+UAudioComponent* UReacousticAudioComponentManager::AcquireAudioComponent(const FVector& Location, const float Priority)
+{
+	const UWorld* World {Owner ? Owner->GetWorld() : nullptr};
+	if (!World) { return nullptr; }
+	
+	const double Time {World->GetTimeSeconds()};
+	UAudioComponent* AudioComponent {nullptr};
+
+	while (!AvailableAudioComponents.IsEmpty() && !AudioComponent)
+	{
+		AudioComponent = AvailableAudioComponents.Pop(false);
+	}
+
+	if (AudioComponent)
+	{
+		ActiveAudioComponents.Add(AudioComponent);
+		FReacousticVoiceState& State {ActiveVoiceStates.AddDefaulted_GetRef()};
+		State.Priority = Priority;
+		State.StartTime = Time;
+	}
+	else
+	{
+		/** The pool is exhausted, so we steal the quietest voice. Older voices have decayed more, so they are stolen first. */
+		int32 StealIndex {INDEX_NONE};
+		float LowestPriority {Priority};
+		for (int32 Index {0}; Index < ActiveAudioComponents.Num(); ++Index)
+		{
+			const float EffectivePriority {GetEffectivePriority(Index, Time)};
+			if (EffectivePriority < LowestPriority
+				|| (StealIndex != INDEX_NONE && EffectivePriority == LowestPriority && ActiveVoiceStates[Index].StartTime < ActiveVoiceStates[StealIndex].StartTime))
+			{
+				LowestPriority = EffectivePriority;
+				StealIndex = Index;
+			}
+		}
+
+		if (StealIndex == INDEX_NONE)
+		{
+			UE_LOG(LogReacousticAudioComponentManager, VeryVerbose, TEXT("Culled voice request with priority '%f'. All voices are more important."), Priority);
+			return nullptr;
+		}
+
+		AudioComponent = ActiveAudioComponents[StealIndex];
+		AudioComponent->Stop();
+		ActiveVoiceStates[StealIndex].Priority = Priority;
+		ActiveVoiceStates[StealIndex].StartTime = Time;
+	}
+
+	AudioComponent->SetWorldLocation(Location);
+	return AudioComponent;
+}
+
+void UReacousticAudioComponentManager::ReleaseAudioComponent(UAudioComponent* AudioComponent)
+{
+	const int32 Index {ActiveAudioComponents.Find(AudioComponent)};
+	if (Index == INDEX_NONE) { return; }
+
+	ActiveAudioComponents.RemoveAtSwap(Index, 1, false);
+	ActiveVoiceStates.RemoveAtSwap(Index, 1, false);
+	AvailableAudioComponents.Add(AudioComponent);
+
+	if (AudioComponent && AudioComponent->IsPlaying())
+	{
+		AudioComponent->Stop();
+	}
+}
+
+float UReacousticAudioComponentManager::CalculateVoicePriority(const float ImpactStrength, const FVector& Location) const
+{
+	float Distance {0.0f};
+	if (const UWorld* World {Owner ? Owner->GetWorld() : nullptr})
+	{
+		if (const APlayerController* PlayerController {World->GetFirstPlayerController()})
+		{
+			FVector ListenerLocation;
+			FVector ListenerFront;
+			FVector ListenerRight;
+			PlayerController->GetAudioListenerPosition(ListenerLocation, ListenerFront, ListenerRight);
+			Distance = FVector::Dist(ListenerLocation, Location);
+		}
+	}
+
+	/** Loudness roughly falls off linearly with distance. Everything within a meter of the listener is considered equally close. */
+	constexpr float ReferenceDistance {100.0f};
+	return FMath::Max(0.0f, ImpactStrength) / FMath::Max(1.0f, Distance / ReferenceDistance);
+}
+
+float UReacousticAudioComponentManager::GetEffectivePriority(const int32 ActiveIndex, const double Time) const
+{
+	const UAudioComponent* AudioComponent {ActiveAudioComponents[ActiveIndex]};
+
+	/** A voice that was acquired but never started playing is always free to steal. */
+	if (!AudioComponent || !AudioComponent->IsPlaying()) { return 0.0f; }
+
+	/** Impact sounds decay quickly, so we assume the loudness of a voice halves roughly every quarter second. */
+	constexpr float DecayTime {0.36f};
+	const FReacousticVoiceState& State {ActiveVoiceStates[ActiveIndex]};
+	return State.Priority * FMath::Exp(-static_cast<float>(Time - State.StartTime) / DecayTime);
+}
+
+void UReacousticAudioComponentManager::HandleAudioFinished(UAudioComponent* AudioComponent)
+{
+	/** A stolen voice may report the end of its previous sound after it has already started playing a new one. */
+	if (!AudioComponent || AudioComponent->IsPlaying()) { return; }
+	ReleaseAudioComponent(AudioComponent);
+}
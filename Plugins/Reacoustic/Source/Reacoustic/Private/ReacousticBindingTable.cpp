@@ -0,0 +1,94 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#include "ReacousticBindingTable.h"
+#include "ReacousticDataTypes.h"
+#include "ReacousticSubsystem.h"
+#include "Engine/Level.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "UObject/ObjectSaveContext.h"
+
+DEFINE_LOG_CATEGORY_CLASS(AReacousticBindingTable, LogReacousticBindingTable);
+
+AReacousticBindingTable::AReacousticBindingTable()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	SetCanBeDamaged(false);
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void AReacousticBindingTable::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const UWorld* World {GetWorld()};
+	if (UReacousticSubsystem* Subsystem {World ? World->GetSubsystem<UReacousticSubsystem>() : nullptr})
+	{
+		Subsystem->InstantiateBindings(this);
+	}
+}
+
+void AReacousticBindingTable::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	const UWorld* World {GetWorld()};
+	if (UReacousticSubsystem* Subsystem {World ? World->GetSubsystem<UReacousticSubsystem>() : nullptr})
+	{
+		Subsystem->RemoveBindings(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AReacousticBindingTable::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+#if WITH_EDITOR
+	if (!IsTemplate())
+	{
+		BakeBindings();
+	}
+#endif
+}
+
+#if WITH_EDITOR
+void AReacousticBindingTable::BakeBindings()
+{
+	const ULevel* Level {GetLevel()};
+	if (!Level) { return; }
+
+	Bindings.Reset();
+
+	/** The first entry for a mesh wins, which matches the lookup tables of the subsystem. */
+	TMap<const UStaticMesh*, int32> MeshSoundDataIndices;
+	if (ReferenceMap)
+	{
+		for (const FMeshToAudioMapEntry& Entry : ReferenceMap->MeshMapEntries)
+		{
+			if (Entry.Mesh && !MeshSoundDataIndices.Contains(Entry.Mesh))
+			{
+				MeshSoundDataIndices.Add(Entry.Mesh, Entry.ReacousticSoundDataRef);
+			}
+		}
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		const AStaticMeshActor* StaticMeshActor {Cast<AStaticMeshActor>(Actor)};
+		if (!StaticMeshActor) { continue; }
+
+		UStaticMeshComponent* MeshComponent {UReacousticSubsystem::FindCompatibleMeshComponent(StaticMeshActor)};
+		if (!MeshComponent) { continue; }
+
+		FReacousticBinding& Binding {Bindings.AddDefaulted_GetRef()};
+		Binding.MeshComponent = MeshComponent;
+		if (const int32* Index {MeshSoundDataIndices.Find(MeshComponent->GetStaticMesh())})
+		{
+			Binding.SoundDataIndex = *Index;
+		}
+	}
+
+	UE_LOG(LogReacousticBindingTable, Verbose, TEXT("Baked %d Reacoustic bindings for %s."), Bindings.Num(), *GetName());
+}
+#endif
@@ -4,7 +4,10 @@
 #include "ReacousticComponent.h"
 
 #include "ReacousticSubsystem.h"
+#include "ReacousticAudioComponentManager.h"
 #include "Chaos/Utilities.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Algo/BinarySearch.h"
 
 DEFINE_LOG_CATEGORY_CLASS(UReacousticComponent, LogReacousticComponent);
 
@@ -60,7 +63,13 @@ void UReacousticComponent::BeginPlay()
 
 	if(MeshComponent)
 	{
-		MeshComponent->OnComponentHit.AddDynamic(this, &UReacousticComponent::HandleOnComponentHit);
+		/** Collisions are forwarded by the subsystem if it listens to the collision events of the solver. */
+		const UWorld* World {GetWorld()};
+		UReacousticSubsystem* Subsystem {World ? World->GetSubsystem<UReacousticSubsystem>() : nullptr};
+		if (!Subsystem || !Subsystem->RegisterBody(this, MeshComponent))
+		{
+			MeshComponent->OnComponentHit.AddDynamic(this, &UReacousticComponent::HandleOnComponentHit);
+		}
 	}
 	else
 	{
@@ -74,28 +83,51 @@ inline void UReacousticComponent::Initialize_Implementation(USoundBase* SoundBas
 {
 	if(const UWorld* World {GetWorld()})
 	{
-		if(UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()})
+		UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()};
+		if(Subsystem && !HasTransferredData)
 		{
-			TransferData(Subsystem->ReacousticSoundDataAsset,Subsystem->ReacousticSoundDataRefMap,Subsystem->GetMeshSoundData(MeshComponent));
+			MeshSoundDataIndex = MeshComponent ? Subsystem->GetMeshSoundDataIndex(MeshComponent->GetStaticMesh()) : INDEX_NONE;
+			const FReacousticSoundData* SoundData {Subsystem->GetSoundDataAtIndex(MeshSoundDataIndex)};
+			TransferData(Subsystem->ReacousticSoundDataAsset,Subsystem->ReacousticSoundDataRefMap,SoundData ? *SoundData : FReacousticSoundData {});
 		}
 	}
 	
-	if(!AudioComponent)
+	/** Voices are acquired from the subsystem's pool per hit, so we only need to remember which sound to play. */
+	ImpactSound = SoundBase;
+}
+
+UAudioComponent* UReacousticComponent::AcquireVoice(const FVector& Location, const float ImpactStrength)
+{
+	AudioComponent = nullptr;
+
+	const UWorld* World {GetWorld()};
+	const UReacousticSubsystem* Subsystem {World ? World->GetSubsystem<UReacousticSubsystem>() : nullptr};
+	UReacousticAudioComponentManager* Manager {Subsystem ? Subsystem->GetAudioComponentManager() : nullptr};
+	if (!Manager) { return nullptr; }
+
+	AudioComponent = Manager->AcquireAudioComponent(Location, Manager->CalculateVoicePriority(ImpactStrength, Location));
+	if (!AudioComponent) { return nullptr; }
+
+	/** A voice only returns to the pool when it finishes playing, so a voice without a sound is released right away. */
+	if (!ImpactSound)
 	{
-		AudioComponent = NewObject<UAudioComponent>(GetOwner());
-		AudioComponent->RegisterComponent();
-		AudioComponent->SetSound(SoundBase);
+		Manager->ReleaseAudioComponent(AudioComponent);
+		AudioComponent = nullptr;
+		return nullptr;
 	}
-	
-	/** Set the attenuation settings */
-	AudioComponent->AttenuationSettings = MeshAudioData.Attenuation;
 
-	/** Set the parameters.*/
+	/** Pooled voices are shared between components, so every setting has to be applied on acquisition. */
+	AudioComponent->SetSound(ImpactSound);
+	AudioComponent->AttenuationSettings = MeshAudioData.Attenuation;
+	AudioComponent->ConcurrencySet.Reset();
+	if (MeshAudioData.Concurrency)
+	{
+		AudioComponent->ConcurrencySet.Add(MeshAudioData.Concurrency);
+	}
 	AudioComponent->SetFloatParameter(TEXT("Obj_Length"), MeshAudioData.ImpulseLength);
 	AudioComponent->SetWaveParameter(TEXT("Obj_WaveAsset"), MeshAudioData.ImpactWaveAsset);
-
-	/** Add the audio component to the parent actor */
-	AudioComponent->AttachToComponent(GetOwner()->GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	AudioComponent->Play();
+	return AudioComponent;
 }
 
 float UReacousticComponent::CalculateImpactValue(const FVector& NormalImpulse, const UPrimitiveComponent* HitComponent,
@@ -113,23 +145,89 @@ float UReacousticComponent::CalculateImpactValue(const FVector& NormalImpulse, c
 
 FReacousticSoundData UReacousticComponent::GetSurfaceHitSoundX(const AActor* Actor, const UPhysicalMaterial* PhysicalMaterial)
 {
-	return FReacousticSoundData();
+	FReacousticSoundData SoundData;
+	if (Actor && PhysicalMaterial)
+	{
+		if (const UWorld* World {Actor->GetWorld()})
+		{
+			if (const UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()})
+			{
+				Subsystem->GetSurfaceSoundData(PhysicalMaterial->SurfaceType, SoundData);
+			}
+		}
+	}
+	return SoundData;
 }
 
 void UReacousticComponent::HandleOnComponentHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
-	if(FilterImpact(HitComp,OtherActor,OtherComp,NormalImpulse,Hit))
+	/** Hits are queued to the subsystem, which merges, filters and plays them once per frame. */
+	if (const UWorld* World {GetWorld()})
 	{
-		OnComponentHit(HitComp, OtherActor, OtherComp, NormalImpulse, Hit);
+		if (UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()})
+		{
+			/** Impacts that the listener can't hear are culled before any per-hit work is done. */
+			const UStaticMeshComponent* StaticMeshComponent {Cast<UStaticMeshComponent>(HitComp)};
+			const int32 SoundDataIndex {StaticMeshComponent ? Subsystem->GetMeshSoundDataIndex(StaticMeshComponent->GetStaticMesh()) : INDEX_NONE};
+			if (!Subsystem->IsImpactInRange(SoundDataIndex, Hit.ImpactPoint)) { return; }
+
+			Subsystem->SubmitImpact(this, HitComp, OtherActor, OtherComp, NormalImpulse, Hit, CalculateImpactValue(NormalImpulse, HitComp, OtherActor));
+			return;
+		}
 	}
 	
+	if(FilterImpact(HitComp,OtherActor,OtherComp,NormalImpulse,Hit))
+	{
+		PlayImpact(HitComp, OtherActor, OtherComp, NormalImpulse, Hit);
+	}
 }
 
+void UReacousticComponent::PlayImpact(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	/** Resolve the sound data of the surface that was hit, so that both the mesh and the surface can be heard. */
+	HasSurfaceAudioData = false;
+	SurfaceSoundDataIndex = INDEX_NONE;
+	if (const UPhysicalMaterial* PhysicalMaterial {Hit.PhysMaterial.Get()})
+	{
+		if (const UWorld* World {GetWorld()})
+		{
+			if (const UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()})
+			{
+				SurfaceSoundDataIndex = Subsystem->GetSurfaceSoundDataIndex(PhysicalMaterial->SurfaceType);
+				HasSurfaceAudioData = Subsystem->GetSoundDataAtIndex(SurfaceSoundDataIndex) != nullptr;
+			}
+		}
+	}
+	AcquireVoice(Hit.ImpactPoint, ImpactForce);
+	OnComponentHit(HitComp, OtherActor, OtherComp, NormalImpulse, Hit);
+}
 
+const FReacousticSoundData* UReacousticComponent::GetSurfaceSoundData() const
+{
+	const UWorld* World {GetWorld()};
+	const UReacousticSubsystem* Subsystem {World ? World->GetSubsystem<UReacousticSubsystem>() : nullptr};
+	return HasSurfaceAudioData && Subsystem ? Subsystem->GetSoundDataAtIndex(SurfaceSoundDataIndex) : nullptr;
+}
 
+bool UReacousticComponent::GetSurfaceAudioData(FReacousticSoundData& OutSoundData) const
+{
+	if (const FReacousticSoundData* SoundData {GetSurfaceSoundData()})
+	{
+		OutSoundData = *SoundData;
+		return true;
+	}
+	return false;
+}
 
-/** This implementation will likely allways be ovewrriden by a blueprint or function that needs to trigger a custom hit.*/
-void UReacousticComponent::TriggerManualHit_Implementation(float Strength){}
+/** This implementation will likely allways be ovewrriden by a blueprint or function that needs to trigger a custom hit.
+ *	Overrides should call the parent implementation, or AcquireVoice, to get a voice to play the hit on. */
+void UReacousticComponent::TriggerManualHit_Implementation(float Strength)
+{
+	if (const AActor* Owner {GetOwner()})
+	{
+		AcquireVoice(Owner->GetActorLocation(), Strength);
+	}
+}
 
 
 void UReacousticComponent::OnComponentHit_Implementation(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
@@ -153,6 +251,7 @@ void UReacousticComponent::TransferData(UReacousticSoundDataAsset* SoundDataArra
 		ReacousticSoundDataAsset = SoundDataArray;
 		UReacousticSoundDataRefMap = ReferenceMap;
 		MeshAudioData = MeshSoundDataIn;
+		HasTransferredData = true;
 	}
 	else
 	{
@@ -161,24 +260,19 @@ void UReacousticComponent::TransferData(UReacousticSoundDataAsset* SoundDataArra
 	
 }
 
-inline static float GetArraySum(const TArray<float>& Array)
-{
-	float Sum {0.0};
-	for (const float Element : Array)
-	{
-		Sum += Element;
-	}
-	return Sum;
-}
-
 /** Filter the hit events so that the system only triggers at appropriate impacts.*/
 //TODO: i'm passing a lot of values that i might not need. So i'll delete them later.
 bool UReacousticComponent::FilterImpact(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	return FilterImpact(CalculateImpactValue(NormalImpulse,HitComp,OtherActor), Hit);
+}
+
+bool UReacousticComponent::FilterImpact(const float ImpactValue, const FHitResult& Hit)
 {
 	bool HitIsValid{false};
-	ImpactForce = CalculateImpactValue(NormalImpulse,HitComp,OtherActor);
+	ImpactForce = ImpactValue;
 	/** We perform a lot of filtering to prevent hitsounds from playing in unwanted situations.*/
-	if( ImpactForce > 30)
+	if( ImpactForce > MinImpactValue)
 	{
 		DeltaLocationDistance = abs(FVector::Distance(LatestLocation, Hit.Location));
 		LatestLocation = Hit.ImpactPoint;
@@ -193,7 +287,7 @@ bool UReacousticComponent::FilterImpact(UPrimitiveComponent* HitComp, AActor* Ot
 			/** If there's a considerable time between hits, remove the hit state history.*/
 			if(DeltaHitTime > 1.0)
 			{
-				DeltaStateArray.Empty();
+				DeltaStateArray.Reset();
 			}
 			
 			if(DeltaHitTime > 0.05)
@@ -211,75 +305,115 @@ bool UReacousticComponent::FilterImpact(UPrimitiveComponent* HitComp, AActor* Ot
 				if(DeltaDirectionVector >0.1)
 				{
 					/** Prevent more erratic hits happening for a long time in the same location. Eg: An object glitching behind the wall.*/
-					DeltaStateArray.Add(DeltaLocationDistance * DeltaHitTime + 100*DeltaDirectionVector);
-					UE_LOG(LogReacousticComponent, Verbose, TEXT("DeltaStateArray Array Sum: %f"),(GetArraySum(DeltaStateArray)));
-					if(GetArraySum(DeltaStateArray) > 0.5f || DeltaStateArray.Num() <= 20)
+					/** Once the history is full, the new state and the last 20 states are summed before the oldest state is overwritten. */
+					const float DeltaState {DeltaLocationDistance * DeltaHitTime + 100*DeltaDirectionVector};
+					const float DeltaStateSum {DeltaStateArray.GetSum() + DeltaState};
+					UE_LOG(LogReacousticComponent, Verbose, TEXT("DeltaStateArray Array Sum: %f"), DeltaStateSum);
+					if(DeltaStateSum > 0.5f || !DeltaStateArray.IsFull())
 					{
 							HitIsValid = true;
 					}
 					else{UE_LOG(LogReacousticComponent,Verbose,TEXT("Prevented hit by: STATE ARRAY"))}
+					DeltaStateArray.Push(DeltaState);
 				}
 				else{UE_LOG(LogReacousticComponent,Verbose,TEXT("Prevented hit by: DELTA FORWARD VECTOR"))}
 			}
 			else{UE_LOG(LogReacousticComponent,Verbose,TEXT("Prevented hit by: DELTA HIT TIME"))}
 		}
 		else{UE_LOG(LogReacousticComponent,Verbose,TEXT("Prevented hit by: LOCATION DISTANCE"))}
-		
-		/** Remove the oldest delta location distance from the array if it exceeds the limit. */
-		if (DeltaStateArray.Num() > 20)
-		{
-			DeltaStateArray.RemoveAt(0);
-		}
 	}
 	return HitIsValid;
 }
 
 
-/**Iterate through SounData.OnsetDataMap(timestamp,volume) to find a timestamp related to a volume matching the impact value.*/
-int UReacousticComponent::FindTimeStampEntry(FReacousticSoundData SoundData, float ImpactValue)
+/**Search SoundData.SortedOnsets(volume,timestamp) to find a timestamp related to a volume matching the impact value.*/
+int UReacousticComponent::FindTimeStampEntry(const FReacousticSoundData& SoundData, float ImpactValue)
 {
 	
 	float BestDifference = FLT_MAX; 
 	int BestTimeStamp = -1;
 
-	/** Iterate over TMap and find the key asociated with the volume value closest to impact value */
-	for(auto& Elem : SoundData.OnsetDataMap)
+	/** Values outside of this range can't be close to any of the latest matching elements, so we don't have to iterate through them. */
+	const float ExclusionMargin {SoundData.ImpulseLength * 2};
+	const float ExclusionMin {LatestMatchingElements.GetMin() - ExclusionMargin};
+	const float ExclusionMax {LatestMatchingElements.GetMax() + ExclusionMargin};
+
+	auto IsExcluded = [&](const float Value)
 	{
-		/** If this element is in LatestMatchingElements, skip to the next iteration */
-		/** Iterate throug the recorded sound timestamps.*/
-		bool next{false};
+		if (LatestMatchingElements.IsEmpty() || Value <= ExclusionMin || Value >= ExclusionMax) { return false; }
 		for (int32 j = 0; j < LatestMatchingElements.Num(); j++)
 		{
-			float LatestMatchingElement = LatestMatchingElements[j];
-			/** if any of them don't fit, break and test the next timestamp.*/
-			if (FMath::Abs(Elem.Value - LatestMatchingElement) < SoundData.ImpulseLength*2)
+			if (FMath::Abs(Value - LatestMatchingElements[j]) < ExclusionMargin)
 			{
-				next = true;
-				break;
+				return true;
 			}
 		}
-		if(next)
+		return false;
+	};
+
+	if (SoundData.HasSortedOnsets())
+	{
+		const TArray<FReacousticOnsetEntry>& Onsets {SoundData.SortedOnsets};
+		const int32 InsertIndex {Algo::LowerBoundBy(Onsets, ImpactValue, &FReacousticOnsetEntry::Volume)};
+
+		/** Mark the onsets around the insertion point that are close to the latest matches. The sorted order means that
+		 *	every latest match excludes a contiguous range, which we find with two binary searches. */
+		constexpr int32 WindowSize {64};
+		const int32 WindowStart {FMath::Clamp(InsertIndex - WindowSize / 2, 0, FMath::Max(0, Onsets.Num() - WindowSize))};
+		const int32 WindowEnd {FMath::Min(WindowStart + WindowSize, Onsets.Num())};
+		uint64 ExcludedMask {0};
+		for (int32 j = 0; j < LatestMatchingElements.Num(); j++)
 		{
-			continue;
+			const float LatestMatchingElement {LatestMatchingElements[j]};
+			const int32 RangeStart {FMath::Max(WindowStart, static_cast<int32>(Algo::UpperBoundBy(Onsets, LatestMatchingElement - ExclusionMargin, &FReacousticOnsetEntry::Volume)))};
+			const int32 RangeEnd {FMath::Min(WindowEnd, static_cast<int32>(Algo::LowerBoundBy(Onsets, LatestMatchingElement + ExclusionMargin, &FReacousticOnsetEntry::Volume)))};
+			if (RangeStart >= RangeEnd) { continue; }
+			const int32 RangeLength {RangeEnd - RangeStart};
+			const uint64 RangeBits {RangeLength >= WindowSize ? ~uint64 {0} : (uint64 {1} << RangeLength) - 1};
+			ExcludedMask |= RangeBits << (RangeStart - WindowStart);
 		}
-		const float CurrentDifference = FMath::Abs(ImpactValue - Elem.Value);
-		if(CurrentDifference < BestDifference)
+
+		/** Walk outwards from the insertion point, taking the closest onset that isn't excluded. */
+		int32 Lower {InsertIndex - 1};
+		int32 Upper {InsertIndex};
+		while (Lower >= 0 || Upper < Onsets.Num())
 		{
-			BestDifference = CurrentDifference;
-			BestTimeStamp = Elem.Value;
+			const bool TakeLower {Upper >= Onsets.Num()
+				|| (Lower >= 0 && ImpactValue - Onsets[Lower].Volume <= Onsets[Upper].Volume - ImpactValue)};
+			const int32 Index {TakeLower ? Lower-- : Upper++};
+			const bool IsInWindow {Index >= WindowStart && Index < WindowEnd};
+			const bool IsIndexExcluded {IsInWindow ? (ExcludedMask & (uint64 {1} << (Index - WindowStart))) != 0 : IsExcluded(Onsets[Index].Volume)};
+			if (!IsIndexExcluded)
+			{
+				BestTimeStamp = Onsets[Index].Volume;
+				break;
+			}
+		}
+	}
+	else
+	{
+		/** Iterate over TMap and find the key asociated with the volume value closest to impact value */
+		for(auto& Elem : SoundData.OnsetDataMap)
+		{
+			/** If this element is close to one of the LatestMatchingElements, skip to the next iteration */
+			if(IsExcluded(Elem.Value))
+			{
+				continue;
+			}
+			const float CurrentDifference = FMath::Abs(ImpactValue - Elem.Value);
+			if(CurrentDifference < BestDifference)
+			{
+				BestDifference = CurrentDifference;
+				BestTimeStamp = Elem.Value;
+			}
 		}
 	}
 
 	/** If we found a matching timestamp, update LatestMatchingElements */
 	if(BestTimeStamp != -1)
 	{
-		LatestMatchingElements.Add(BestTimeStamp);
-        
-		/** If we now have more than 10 elements, remove the oldest one */
-		if(LatestMatchingElements.Num() > 10)
-		{
-			LatestMatchingElements.RemoveAt(0);
-		}
+		/** The buffer holds the latest 10 elements, and overwrites the oldest one when it is full. */
+		LatestMatchingElements.Push(BestTimeStamp);
 	}
 
 	return BestTimeStamp;
@@ -288,11 +422,15 @@ int UReacousticComponent::FindTimeStampEntry(FReacousticSoundData SoundData, flo
 
 void UReacousticComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	/** The voice is owned by the pool and will be released when it finishes playing. */
+	AudioComponent = nullptr;
+
 	if(const UWorld* World {GetWorld()})
 	{
 		if(UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()})
 		{
 			Subsystem->UnregisterComponent(this);
+			Subsystem->UnregisterBody(this);
 		}
 	}
 	Super::EndPlay(EndPlayReason);
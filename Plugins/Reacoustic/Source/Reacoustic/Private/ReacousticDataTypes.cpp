@@ -0,0 +1,83 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#include "ReacousticDataTypes.h"
+#include "ReacousticOnsetAnalysis.h"
+#include "UObject/ObjectSaveContext.h"
+
+void FReacousticSoundData::BuildSortedOnsets()
+{
+	SortedOnsets.Reset(OnsetDataMap.Num());
+	for (const TPair<float, float>& Onset : OnsetDataMap)
+	{
+		FReacousticOnsetEntry& Entry {SortedOnsets.AddDefaulted_GetRef()};
+		Entry.TimeStamp = Onset.Key;
+		Entry.Volume = Onset.Value;
+	}
+	SortedOnsets.Sort([](const FReacousticOnsetEntry& A, const FReacousticOnsetEntry& B)
+	{
+		return A.Volume < B.Volume;
+	});
+	SortedOnsetsHash = GetOnsetDataHash();
+}
+
+uint32 FReacousticSoundData::GetOnsetDataHash() const
+{
+	/** The hashes of the entries are summed, so that maps with the same contents in a different order have the same hash. */
+	uint32 Hash {0};
+	for (const TPair<float, float>& Onset : OnsetDataMap)
+	{
+		Hash += HashCombineFast(GetTypeHash(Onset.Key), GetTypeHash(Onset.Value));
+	}
+	return Hash;
+}
+
+void UReacousticSoundDataAsset::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+	for (FReacousticSoundData& SoundData : AudioData)
+	{
+		SoundData.BuildSortedOnsets();
+	}
+}
+
+/** Assets that were saved before the sorted onsets existed are sorted on load, until they are resaved. */
+void UReacousticSoundDataAsset::PostLoad()
+{
+	Super::PostLoad();
+	for (FReacousticSoundData& SoundData : AudioData)
+	{
+		if (!SoundData.HasSortedOnsets())
+		{
+			SoundData.BuildSortedOnsets();
+		}
+	}
+}
+
+#if WITH_EDITOR
+UReacousticSoundDataAsset::FOnSoundDataAssetChanged UReacousticSoundDataAsset::OnSoundDataAssetChanged;
+
+void UReacousticSoundDataAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	for (FReacousticSoundData& SoundData : AudioData)
+	{
+		SoundData.BuildSortedOnsets();
+	}
+	OnSoundDataAssetChanged.Broadcast(this);
+}
+
+void UReacousticSoundDataAsset::AnalyzeOnsets()
+{
+	UReacousticSoundDataAsset* Asset {this};
+	FReacousticOnsetAnalyzer::AnalyzeAssets(MakeArrayView(&Asset, 1), FReacousticOnsetAnalysisSettings());
+}
+
+UReacousticSoundDataRef_Map::FOnReferenceMapChanged UReacousticSoundDataRef_Map::OnReferenceMapChanged;
+
+void UReacousticSoundDataRef_Map::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	OnReferenceMapChanged.Broadcast(this);
+}
+#endif
@@ -0,0 +1,283 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#include "ReacousticOnsetAnalysis.h"
+#include "ReacousticComponent.h"
+#include "Async/ParallelFor.h"
+#include "DSP/FFTAlgorithm.h"
+#include "DSP/FloatArrayMath.h"
+
+DEFINE_LOG_CATEGORY_CLASS(FReacousticOnsetAnalyzer, LogReacousticOnsetAnalysis);
+
+/** Returns the peak absolute value of a block of samples. The amount of samples must be a multiple of 4. */
+static float GetBlockPeak(const float* Samples, const int32 NumSamples)
+{
+	VectorRegister4Float Peak {VectorZeroFloat()};
+	for (int32 Index {0}; Index < NumSamples; Index += 4)
+	{
+		Peak = VectorMax(Peak, VectorAbs(VectorLoad(Samples + Index)));
+	}
+	alignas(16) float Lanes[4];
+	VectorStoreAligned(Peak, Lanes);
+	return FMath::Max(FMath::Max(Lanes[0], Lanes[1]), FMath::Max(Lanes[2], Lanes[3]));
+}
+
+/** Returns the sum of the positive differences between two spectra. The amount of bins must be a multiple of 4. */
+static float GetRectifiedDifferenceSum(const float* Current, const float* Previous, const int32 NumBins)
+{
+	VectorRegister4Float Sum {VectorZeroFloat()};
+	for (int32 Index {0}; Index < NumBins; Index += 4)
+	{
+		const VectorRegister4Float Difference {VectorSubtract(VectorLoad(Current + Index), VectorLoad(Previous + Index))};
+		Sum = VectorAdd(Sum, VectorMax(Difference, VectorZeroFloat()));
+	}
+	alignas(16) float Lanes[4];
+	VectorStoreAligned(Sum, Lanes);
+	return Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+}
+
+/** Multiplies a block of samples with a window. The amount of samples must be a multiple of 4. */
+static void ApplyWindow(const float* Samples, const float* Window, float* OutSamples, const int32 NumSamples)
+{
+	for (int32 Index {0}; Index < NumSamples; Index += 4)
+	{
+		VectorStore(VectorMultiply(VectorLoad(Samples + Index), VectorLoad(Window + Index)), OutSamples + Index);
+	}
+}
+
+void FReacousticOnsetAnalyzer::AnalyzeSamples(TArrayView<const float> Samples, const int32 SampleRate,
+	const FReacousticOnsetAnalysisSettings& Settings, TArray<FReacousticOnsetEntry>& OutOnsets)
+{
+	OutOnsets.Reset();
+
+	const int32 FFTSize {1 << FMath::Clamp(Settings.FFTLog2Size, 6, 14)};
+	const int32 HopSize {FMath::Clamp(Settings.HopSize & ~3, 4, FFTSize)};
+	if (SampleRate <= 0 || Samples.Num() < FFTSize) { return; }
+
+	const int32 NumFrames {(Samples.Num() - FFTSize) / HopSize + 1};
+	const float HopDuration {static_cast<float>(HopSize) / SampleRate};
+
+	/** Follow the envelope of the per hop peaks. The attack and release coefficients are applied per hop. */
+	TArray<float> Envelope;
+	Envelope.SetNumUninitialized(NumFrames);
+	const float AttackCoefficient {FMath::Exp(-HopDuration / FMath::Max(Settings.EnvelopeAttackTime, KINDA_SMALL_NUMBER))};
+	const float ReleaseCoefficient {FMath::Exp(-HopDuration / FMath::Max(Settings.EnvelopeReleaseTime, KINDA_SMALL_NUMBER))};
+	float EnvelopeValue {0.0f};
+	float PeakEnvelopeValue {0.0f};
+	for (int32 Frame {0}; Frame < NumFrames; ++Frame)
+	{
+		const float Peak {GetBlockPeak(Samples.GetData() + Frame * HopSize, HopSize)};
+		const float Coefficient {Peak > EnvelopeValue ? AttackCoefficient : ReleaseCoefficient};
+		EnvelopeValue = Peak + Coefficient * (EnvelopeValue - Peak);
+		Envelope[Frame] = EnvelopeValue;
+		PeakEnvelopeValue = FMath::Max(PeakEnvelopeValue, EnvelopeValue);
+	}
+	if (PeakEnvelopeValue <= KINDA_SMALL_NUMBER) { return; }
+
+	Audio::FFFTSettings FFTSettings;
+	FFTSettings.Log2Size = FMath::FloorLog2(FFTSize);
+	FFTSettings.bArrays128BitAligned = true;
+	FFTSettings.bEnableHardwareAcceleration = true;
+	const TUniquePtr<Audio::IFFTAlgorithm> FFT {Audio::FFFTFactory::NewFFTAlgorithm(FFTSettings)};
+	if (!FFT.IsValid()) { return; }
+
+	TArray<float> Window;
+	Window.SetNumUninitialized(FFTSize);
+	for (int32 Index {0}; Index < FFTSize; ++Index)
+	{
+		Window[Index] = 0.5f - 0.5f * FMath::Cos(2.0f * PI * Index / FFTSize);
+	}
+
+	/** The spectra are padded to a multiple of 4 bins, so that the flux can be summed four bins at a time. */
+	const int32 NumBins {FFT->NumOutputFloats() / 2};
+	const int32 NumPaddedBins {Align(NumBins, 4)};
+	TArray<float> WindowedFrame;
+	TArray<float> ComplexSpectrum;
+	TArray<float> PowerSpectrum;
+	TArray<float> Spectrum;
+	TArray<float> PreviousSpectrum;
+	WindowedFrame.SetNumUninitialized(FFTSize);
+	ComplexSpectrum.SetNumUninitialized(FFT->NumOutputFloats());
+	PowerSpectrum.SetNumUninitialized(NumBins);
+	Spectrum.SetNumZeroed(NumPaddedBins);
+	PreviousSpectrum.SetNumZeroed(NumPaddedBins);
+
+	TArray<float> Flux;
+	Flux.SetNumUninitialized(NumFrames);
+	for (int32 Frame {0}; Frame < NumFrames; ++Frame)
+	{
+		ApplyWindow(Samples.GetData() + Frame * HopSize, Window.GetData(), WindowedFrame.GetData(), FFTSize);
+		FFT->ForwardRealToComplex(WindowedFrame.GetData(), ComplexSpectrum.GetData());
+		Audio::ArrayComplexToPowerInterleaved(ComplexSpectrum, PowerSpectrum);
+
+		/** Log compression keeps quiet high frequency transients from being drowned out by the low end. */
+		for (int32 Bin {0}; Bin < NumBins; ++Bin)
+		{
+			Spectrum[Bin] = FMath::Loge(1.0f + 100.0f * FMath::Sqrt(PowerSpectrum[Bin]));
+		}
+		Flux[Frame] = GetRectifiedDifferenceSum(Spectrum.GetData(), PreviousSpectrum.GetData(), NumPaddedBins);
+		Swap(Spectrum, PreviousSpectrum);
+	}
+
+	/** Pick the local maxima of the flux that rise above the local mean. */
+	constexpr int32 PeakRadius {2};
+	constexpr int32 MeanRadius {8};
+	constexpr int32 VolumeFrames {4};
+	float LatestOnsetTime {-FLT_MAX};
+	for (int32 Frame {0}; Frame < NumFrames; ++Frame)
+	{
+		const float Value {Flux[Frame]};
+		if (Value <= KINDA_SMALL_NUMBER) { continue; }
+
+		bool IsLocalMaximum {true};
+		for (int32 Other {FMath::Max(0, Frame - PeakRadius)}; Other <= FMath::Min(NumFrames - 1, Frame + PeakRadius); ++Other)
+		{
+			if (Flux[Other] > Value)
+			{
+				IsLocalMaximum = false;
+				break;
+			}
+		}
+		if (!IsLocalMaximum) { continue; }
+
+		const int32 MeanStart {FMath::Max(0, Frame - MeanRadius)};
+		const int32 MeanEnd {FMath::Min(NumFrames - 1, Frame + MeanRadius)};
+		float Mean {0.0f};
+		for (int32 Other {MeanStart}; Other <= MeanEnd; ++Other)
+		{
+			Mean += Flux[Other];
+		}
+		Mean /= (MeanEnd - MeanStart + 1);
+		if (Value < Mean * Settings.Sensitivity) { continue; }
+
+		/** The flux peaks once the transient has moved into the middle of the window, so the start of the window is too early.
+		 *	Refine the onset to the loudest sample within a hop of the window centre. */
+		const int32 CentreSample {Frame * HopSize + FFTSize / 2};
+		const int32 SearchEnd {FMath::Min(Samples.Num(), CentreSample + HopSize)};
+		int32 OnsetSample {CentreSample};
+		float OnsetPeak {0.0f};
+		for (int32 Sample {FMath::Max(0, CentreSample - HopSize)}; Sample < SearchEnd; ++Sample)
+		{
+			if (FMath::Abs(Samples[Sample]) > OnsetPeak)
+			{
+				OnsetPeak = FMath::Abs(Samples[Sample]);
+				OnsetSample = Sample;
+			}
+		}
+
+		const float Time {static_cast<float>(OnsetSample) / SampleRate};
+		if (Time - LatestOnsetTime < Settings.MinOnsetInterval) { continue; }
+		LatestOnsetTime = Time;
+
+		float Volume {0.0f};
+		const int32 VolumeFrame {FMath::Min(NumFrames - 1, OnsetSample / HopSize)};
+		for (int32 Other {VolumeFrame}; Other <= FMath::Min(NumFrames - 1, VolumeFrame + VolumeFrames); ++Other)
+		{
+			Volume = FMath::Max(Volume, Envelope[Other]);
+		}
+
+		/** Scale the volume to the range of impact values that can be played, so that it can be compared to the impact value of a hit. */
+		FReacousticOnsetEntry& Onset {OutOnsets.AddDefaulted_GetRef()};
+		Onset.TimeStamp = Time;
+		Onset.Volume = FMath::Lerp(UReacousticComponent::MinImpactValue, FMath::Max(Settings.MaxImpactValue, UReacousticComponent::MinImpactValue),
+			Volume / PeakEnvelopeValue);
+	}
+}
+
+#if WITH_EDITOR
+bool FReacousticOnsetAnalyzer::GetMonoSamples(const USoundWave* SoundWave, TArray<float>& OutSamples, int32& OutSampleRate)
+{
+	OutSamples.Reset();
+	if (!SoundWave) { return false; }
+
+	TArray<uint8> RawPCMData;
+	uint32 SampleRate {0};
+	uint16 NumChannels {0};
+	if (!SoundWave->GetImportedSoundWaveData(RawPCMData, SampleRate, NumChannels) || NumChannels == 0 || SampleRate == 0) { return false; }
+
+	/** The imported data is interleaved 16 bit PCM. */
+	const int16* PCMData {reinterpret_cast<const int16*>(RawPCMData.GetData())};
+	const int32 NumFrames {RawPCMData.Num() / static_cast<int32>(sizeof(int16) * NumChannels)};
+	const float Scale {1.0f / (32768.0f * NumChannels)};
+	OutSamples.SetNumUninitialized(NumFrames);
+	for (int32 Frame {0}; Frame < NumFrames; ++Frame)
+	{
+		int32 Sum {0};
+		for (int32 Channel {0}; Channel < NumChannels; ++Channel)
+		{
+			Sum += PCMData[Frame * NumChannels + Channel];
+		}
+		OutSamples[Frame] = Sum * Scale;
+	}
+	OutSampleRate = static_cast<int32>(SampleRate);
+	return true;
+}
+
+int32 FReacousticOnsetAnalyzer::AnalyzeAssets(TArrayView<UReacousticSoundDataAsset* const> Assets, const FReacousticOnsetAnalysisSettings& Settings)
+{
+	struct FOnsetAnalysisJob
+	{
+		UReacousticSoundDataAsset* Asset {nullptr};
+		int32 Index {INDEX_NONE};
+		int32 SampleRate {0};
+		TArray<float> Samples;
+		TArray<FReacousticOnsetEntry> Onsets;
+	};
+
+	/** The PCM data is read on the game thread, since reading bulk data is not thread safe. Only the analysis runs in parallel. */
+	TArray<FOnsetAnalysisJob> Jobs;
+	for (UReacousticSoundDataAsset* Asset : Assets)
+	{
+		if (!Asset) { continue; }
+		for (int32 Index {0}; Index < Asset->AudioData.Num(); ++Index)
+		{
+			const USoundWave* SoundWave {Asset->AudioData[Index].ImpactWaveAsset};
+			if (!SoundWave) { continue; }
+
+			FOnsetAnalysisJob& Job {Jobs.AddDefaulted_GetRef()};
+			Job.Asset = Asset;
+			Job.Index = Index;
+			if (!GetMonoSamples(SoundWave, Job.Samples, Job.SampleRate))
+			{
+				UE_LOG(LogReacousticOnsetAnalysis, Warning, TEXT("Failed to read the PCM data of %s."), *SoundWave->GetName());
+				Jobs.Pop(false);
+			}
+		}
+	}
+
+	ParallelFor(Jobs.Num(), [&Jobs, &Settings](const int32 JobIndex)
+	{
+		FOnsetAnalysisJob& Job {Jobs[JobIndex]};
+		AnalyzeSamples(Job.Samples, Job.SampleRate, Settings, Job.Onsets);
+		Job.Samples.Empty();
+	});
+
+	TSet<UReacousticSoundDataAsset*> ChangedAssets;
+	for (const FOnsetAnalysisJob& Job : Jobs)
+	{
+		if (!ChangedAssets.Contains(Job.Asset))
+		{
+			Job.Asset->Modify();
+			ChangedAssets.Add(Job.Asset);
+		}
+
+		FReacousticSoundData& SoundData {Job.Asset->AudioData[Job.Index]};
+		SoundData.OnsetTimingData.Reset(Job.Onsets.Num());
+		SoundData.OnsetVolumeData.Reset(Job.Onsets.Num());
+		SoundData.OnsetDataMap.Reset();
+		for (const FReacousticOnsetEntry& Onset : Job.Onsets)
+		{
+			SoundData.OnsetTimingData.Add(Onset.TimeStamp);
+			SoundData.OnsetVolumeData.Add(Onset.Volume);
+			SoundData.OnsetDataMap.Add(Onset.TimeStamp, Onset.Volume);
+		}
+		SoundData.BuildSortedOnsets();
+	}
+
+	for (UReacousticSoundDataAsset* Asset : ChangedAssets)
+	{
+		Asset->MarkPackageDirty();
+	}
+	return Jobs.Num();
+}
+#endif
@@ -0,0 +1,76 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#include "ReacousticOnsetAnalysisCommandlet.h"
+#include "ReacousticOnsetAnalysis.h"
+#include "ReacousticDataTypes.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/SavePackage.h"
+
+DEFINE_LOG_CATEGORY_CLASS(UReacousticOnsetAnalysisCommandlet, LogReacousticOnsetAnalysisCommandlet);
+
+UReacousticOnsetAnalysisCommandlet::UReacousticOnsetAnalysisCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UReacousticOnsetAnalysisCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString SearchPath {TEXT("/Game")};
+	FParse::Value(*Params, TEXT("path="), SearchPath);
+	FReacousticOnsetAnalysisSettings Settings;
+	FParse::Value(*Params, TEXT("sensitivity="), Settings.Sensitivity);
+	FParse::Value(*Params, TEXT("maximpactvalue="), Settings.MaxImpactValue);
+	const bool CanSave {!FParse::Param(*Params, TEXT("nosave"))};
+
+	IAssetRegistry& AssetRegistry {FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get()};
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UReacousticSoundDataAsset::StaticClass()->GetClassPathName());
+	Filter.PackagePaths.Add(FName(*SearchPath));
+	Filter.bRecursivePaths = true;
+	TArray<FAssetData> AssetDataList;
+	AssetRegistry.GetAssets(Filter, AssetDataList);
+
+	TArray<UReacousticSoundDataAsset*> Assets;
+	for (const FAssetData& AssetData : AssetDataList)
+	{
+		if (UReacousticSoundDataAsset* Asset {Cast<UReacousticSoundDataAsset>(AssetData.GetAsset())})
+		{
+			Assets.Add(Asset);
+		}
+	}
+
+	const double StartTime {FPlatformTime::Seconds()};
+	const int32 AnalyzedCount {FReacousticOnsetAnalyzer::AnalyzeAssets(Assets, Settings)};
+	UE_LOG(LogReacousticOnsetAnalysisCommandlet, Display, TEXT("Analyzed %d sounds in %d assets in %.2f seconds."),
+		AnalyzedCount, Assets.Num(), FPlatformTime::Seconds() - StartTime);
+
+	if (!CanSave) { return 0; }
+
+	int32 FailedCount {0};
+	for (UReacousticSoundDataAsset* Asset : Assets)
+	{
+		UPackage* Package {Asset->GetOutermost()};
+		if (!Package->IsDirty()) { continue; }
+
+		const FString Filename {FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension())};
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		if (!UPackage::SavePackage(Package, Asset, *Filename, SaveArgs))
+		{
+			UE_LOG(LogReacousticOnsetAnalysisCommandlet, Error, TEXT("Failed to save %s."), *Filename);
+			++FailedCount;
+		}
+	}
+	return FailedCount > 0 ? 1 : 0;
+#else
+	return 0;
+#endif
+}
@@ -2,31 +2,216 @@
 // Written by Tim Verberne.
 
 #include "ReacousticSlidingAudioComponent.h"
+#include "ReacousticSlidingVoiceManager.h"
+#include "ReacousticSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "Components/StaticMeshComponent.h"
 
+DEFINE_LOG_CATEGORY_CLASS(UReacousticSlidingAudioComponent, LogReacousticSlidingAudioComponent);
 
 UReacousticSlidingAudioComponent::UReacousticSlidingAudioComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
-	
 }
 
-
-// Called when the game starts
 void UReacousticSlidingAudioComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	TArray<UStaticMeshComponent*> Components;
+	if (GetOwner())
+	{
+		GetOwner()->GetComponents<UStaticMeshComponent>(Components);
+	}
+	for (UStaticMeshComponent* Component : Components)
+	{
+		if (Component->IsSimulatingPhysics())
+		{
+			MeshComponent = Component;
+			break;
+		}
+	}
+	if (!MeshComponent)
+	{
+		UE_LOG(LogReacousticSlidingAudioComponent, Warning, TEXT("%s has no static mesh component with physics simulation enabled."), *GetNameSafe(GetOwner()));
+		return;
+	}
+
+	const UWorld* World {GetWorld()};
+	UReacousticSubsystem* Subsystem {World ? World->GetSubsystem<UReacousticSubsystem>() : nullptr};
+	if (Subsystem)
+	{
+		const FReacousticSoundData SoundData {Subsystem->GetMeshSoundData(Cast<UStaticMeshComponent>(MeshComponent))};
+		SlidingWaveAsset = SoundData.SlidingWaveAsset;
+		Attenuation = SoundData.Attenuation;
+		Concurrency = SoundData.Concurrency;
+		IsRegisteredToSubsystem = Subsystem->RegisterSlidingBody(this, MeshComponent);
+	}
+	if (!SlidingWaveAsset)
+	{
+		UE_LOG(LogReacousticSlidingAudioComponent, Verbose, TEXT("%s has no sliding wave asset."), *GetNameSafe(GetOwner()));
+	}
+	if (!IsRegisteredToSubsystem)
+	{
+		/** OnComponentHit is only broadcast for meshes that have hit notifications enabled. */
+		if (!MeshComponent->BodyInstance.bNotifyRigidBodyCollision)
+		{
+			MeshComponent->SetNotifyRigidBodyCollision(true);
+			HasEnabledHitNotifications = true;
+		}
+		MeshComponent->OnComponentHit.AddDynamic(this, &UReacousticSlidingAudioComponent::HandleComponentHit);
+	}
+
+	/** Wake events let us stop ticking entirely while the body is asleep. */
+	MeshComponent->BodyInstance.bGenerateWakeEvents = true;
+	MeshComponent->OnComponentWake.AddDynamic(this, &UReacousticSlidingAudioComponent::HandleComponentWake);
+	MeshComponent->OnComponentSleep.AddDynamic(this, &UReacousticSlidingAudioComponent::HandleComponentSleep);
+	SetComponentTickEnabled(MeshComponent->RigidBodyIsAwake());
 }
 
+void UReacousticSlidingAudioComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopSliding();
+	if (const UWorld* World {GetWorld()})
+	{
+		if (UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()})
+		{
+			Subsystem->UnregisterSlidingBody(this);
+		}
+	}
+	if (MeshComponent)
+	{
+		MeshComponent->OnComponentWake.RemoveDynamic(this, &UReacousticSlidingAudioComponent::HandleComponentWake);
+		MeshComponent->OnComponentSleep.RemoveDynamic(this, &UReacousticSlidingAudioComponent::HandleComponentSleep);
+		MeshComponent->OnComponentHit.RemoveDynamic(this, &UReacousticSlidingAudioComponent::HandleComponentHit);
+		if (HasEnabledHitNotifications)
+		{
+			MeshComponent->SetNotifyRigidBodyCollision(false);
+			HasEnabledHitNotifications = false;
+		}
+	}
+	Super::EndPlay(EndPlayReason);
+}
 
-// Called every frame
 void UReacousticSlidingAudioComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	// ...
+	const UWorld* World {GetWorld()};
+	if (!World || !MeshComponent || !SlidingWaveAsset) { return; }
+
+	if (ContactCount > 0)
+	{
+		ContactLocation = ContactLocationSum / ContactCount;
+		ContactVelocity = ContactVelocitySum / ContactCount;
+		ContactNormal = ContactNormalSum.GetSafeNormal(UE_SMALL_NUMBER, ContactNormal);
+		LatestContactTime = World->GetTimeSeconds();
+		ContactLocationSum = ContactNormalSum = ContactVelocitySum = FVector::ZeroVector;
+		ContactCount = 0;
+	}
+
+	const bool HasContact {LatestContactTime >= 0.0 && World->GetTimeSeconds() - LatestContactTime <= ContactTimeout};
+	ContactPersistence = HasContact ? ContactPersistence + DeltaTime : 0.0f;
+
+	SlidingSpeed = 0.0f;
+	RollingSpeed = 0.0f;
+	Gain = 0.0f;
+	if (HasContact)
+	{
+		/** The normal is oriented towards the center of the body, so that the contact offset points into the surface. */
+		const FVector Center {MeshComponent->GetCenterOfMass()};
+		const FVector Normal {FVector::DotProduct(ContactNormal, Center - ContactLocation) < 0.0 ? -ContactNormal : ContactNormal};
+		const FVector AngularVelocity {MeshComponent->GetPhysicsAngularVelocityInRadians()};
+
+		/** Sliding is the slip of the contact point over the surface. A rolling body has a stationary contact point. */
+		const FVector ContactPointVelocity {MeshComponent->GetPhysicsLinearVelocity() - ContactVelocity
+			+ FVector::CrossProduct(AngularVelocity, ContactLocation - Center)};
+		SlidingSpeed = FVector::VectorPlaneProject(ContactPointVelocity, Normal).Size();
+		RollingSpeed = FVector::VectorPlaneProject(AngularVelocity, Normal).Size() * FVector::Dist(Center, ContactLocation);
+
+		const float SlidingAmount {FMath::GetRangePct(MinSlidingSpeed, FMath::Max(MinSlidingSpeed + 1.0f, FullSlidingSpeed), SlidingSpeed)};
+		const float RollingAmount {RollingSpeed / FullRollingSpeed * RollingGain};
+		const float PersistenceAmount {ContactPersistenceTime > 0.0f ? ContactPersistence / ContactPersistenceTime : 1.0f};
+		Gain = FMath::Clamp(FMath::Max(SlidingAmount, RollingAmount), 0.0f, 1.0f) * FMath::Clamp(PersistenceAmount, 0.0f, 1.0f);
+	}
+
+	const UReacousticSubsystem* Subsystem {World->GetSubsystem<UReacousticSubsystem>()};
+	if (UReacousticSlidingVoiceManager* Manager {Subsystem ? Subsystem->GetSlidingVoiceManager() : nullptr})
+	{
+		Manager->UpdateSource(this, ContactLocation, Gain);
+	}
+}
+
+void UReacousticSlidingAudioComponent::AddContact(const FVector& Location, const FVector& Normal, const FVector& OtherVelocity)
+{
+	ContactLocationSum += Location;
+	ContactNormalSum += Normal;
+	ContactVelocitySum += OtherVelocity;
+	++ContactCount;
+}
+
+void UReacousticSlidingAudioComponent::ConfigureVoice(UAudioComponent* AudioComponent) const
+{
+	if (!AudioComponent) { return; }
+
+	/** Pooled voices are shared between components, so every setting has to be applied on acquisition. */
+	AudioComponent->SetSound(SlidingSound ? SlidingSound : SlidingWaveAsset);
+	AudioComponent->AttenuationSettings = Attenuation;
+	AudioComponent->ConcurrencySet.Reset();
+	if (Concurrency)
+	{
+		AudioComponent->ConcurrencySet.Add(Concurrency);
+	}
+	if (SlidingSound)
+	{
+		AudioComponent->SetWaveParameter(TEXT("Obj_WaveAsset"), SlidingWaveAsset);
+	}
+	UpdateVoice(AudioComponent);
+}
+
+void UReacousticSlidingAudioComponent::UpdateVoice(UAudioComponent* AudioComponent) const
+{
+	if (!AudioComponent) { return; }
+
+	const float SpeedAmount {FMath::Clamp(FMath::Max(SlidingSpeed / FullSlidingSpeed, RollingSpeed / FullRollingSpeed), 0.0f, 1.0f)};
+	AudioComponent->SetPitchMultiplier(FMath::Lerp(PitchRange.X, PitchRange.Y, SpeedAmount));
+	if (SlidingSound)
+	{
+		AudioComponent->SetFloatParameter(TEXT("Obj_SlidingSpeed"), SlidingSpeed);
+		AudioComponent->SetFloatParameter(TEXT("Obj_RollingSpeed"), RollingSpeed);
+	}
 }
 
+void UReacousticSlidingAudioComponent::HandleComponentWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	SetComponentTickEnabled(true);
+}
+
+void UReacousticSlidingAudioComponent::HandleComponentSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	SetComponentTickEnabled(false);
+	StopSliding();
+}
+
+void UReacousticSlidingAudioComponent::HandleComponentHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp,
+	FVector NormalImpulse, const FHitResult& Hit)
+{
+	AddContact(Hit.ImpactPoint, Hit.ImpactNormal, OtherComp ? OtherComp->GetComponentVelocity() : FVector::ZeroVector);
+}
+
+void UReacousticSlidingAudioComponent::StopSliding()
+{
+	ContactLocationSum = ContactNormalSum = ContactVelocitySum = FVector::ZeroVector;
+	ContactCount = 0;
+	ContactPersistence = 0.0f;
+	LatestContactTime = -1.0;
+	SlidingSpeed = RollingSpeed = Gain = 0.0f;
+
+	const UWorld* World {GetWorld()};
+	const UReacousticSubsystem* Subsystem {World ? World->GetSubsystem<UReacousticSubsystem>() : nullptr};
+	if (UReacousticSlidingVoiceManager* Manager {Subsystem ? Subsystem->GetSlidingVoiceManager() : nullptr})
+	{
+		Manager->RemoveSource(this);
+	}
+}
@@ -0,0 +1,179 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Tim Verberne.
+
+#include "ReacousticSlidingVoiceManager.h"
+#include "ReacousticSlidingAudioComponent.h"
+#include "ReacousticAudioComponentManager.h"
+#include "ReacousticSubsystem.h"
+#include "ReacousticSettings.h"
+#include "Components/AudioComponent.h"
+
+DEFINE_LOG_CATEGORY_CLASS(UReacousticSlidingVoiceManager, LogReacousticSlidingVoiceManager);
+
+void UReacousticSlidingVoiceManager::Initialize(UReacousticSubsystem* Subsystem)
+{
+	Super::Initialize(Subsystem);
+
+	UWorld* World {Subsystem ? Subsystem->GetWorld() : nullptr};
+	if (!World) { return; }
+
+	const int32 VoiceAmount {FMath::Max(1, GetDefault<UReacousticProjectSettings>()->MaxSlidingVoices)};
+	for (int32 i {0}; i < VoiceAmount; ++i)
+	{
+		if (UAudioComponent* NewAudioComponent {NewObject<UAudioComponent>(Owner)})
+		{
+			NewAudioComponent->bAutoActivate = false;
+			NewAudioComponent->bAutoDestroy = false;
+			NewAudioComponent->RegisterComponentWithWorld(World);
+			Voices.AddDefaulted_GetRef().AudioComponent = NewAudioComponent;
+		}
+	}
+	Sources.Reserve(VoiceAmount * 4);
+}
+
+void UReacousticSlidingVoiceManager::Deinitialize(UReacousticSubsystem* Subsystem)
+{
+	for (FReacousticSlidingVoice& Voice : Voices)
+	{
+		if (Voice.AudioComponent)
+		{
+			Voice.AudioComponent->Stop();
+			Voice.AudioComponent->DestroyComponent();
+		}
+	}
+	Voices.Empty();
+	Sources.Empty();
+
+	Super::Deinitialize(Subsystem);
+}
+
+void UReacousticSlidingVoiceManager::UpdateSource(UReacousticSlidingAudioComponent* Component, const FVector& Location, const float Gain)
+{
+	if (!Component) { return; }
+	if (Gain <= 0.0f)
+	{
+		RemoveSource(Component);
+		return;
+	}
+
+	FReacousticSlidingSource* Source {Sources.FindByPredicate([Component](const FReacousticSlidingSource& Other) { return Other.Component == Component; })};
+	if (!Source)
+	{
+		Source = &Sources.AddDefaulted_GetRef();
+		Source->Component = Component;
+	}
+	Source->Location = Location;
+	Source->Gain = Gain;
+}
+
+void UReacousticSlidingVoiceManager::RemoveSource(const UReacousticSlidingAudioComponent* Component)
+{
+	const int32 SourceIndex {Sources.IndexOfByPredicate([Component](const FReacousticSlidingSource& Other) { return Other.Component == Component; })};
+	if (SourceIndex != INDEX_NONE)
+	{
+		Sources.RemoveAtSwap(SourceIndex, 1, false);
+	}
+
+	const int32 VoiceIndex {FindVoice(Component)};
+	if (VoiceIndex != INDEX_NONE)
+	{
+		ReleaseVoice(Voices[VoiceIndex]);
+	}
+}
+
+void UReacousticSlidingVoiceManager::Update()
+{
+	const UReacousticAudioComponentManager* AudioComponentManager {Owner ? Owner->GetAudioComponentManager() : nullptr};
+	for (int32 Index {Sources.Num() - 1}; Index >= 0; --Index)
+	{
+		FReacousticSlidingSource& Source {Sources[Index]};
+		if (!Source.Component.IsValid())
+		{
+			Sources.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+		Source.Priority = AudioComponentManager ? AudioComponentManager->CalculateVoicePriority(Source.Gain, Source.Location) : Source.Gain;
+	}
+
+	Sources.Sort([](const FReacousticSlidingSource& A, const FReacousticSlidingSource& B)
+	{
+		return A.Priority > B.Priority;
+	});
+
+	/** Voices of sources that dropped out of the most audible set, or that were destroyed, are faded out first so they can be reused. */
+	const int32 AudibleCount {FMath::Min(Sources.Num(), Voices.Num())};
+	for (FReacousticSlidingVoice& Voice : Voices)
+	{
+		if (!Voice.Source.IsValid())
+		{
+			if (!Voice.Source.IsExplicitlyNull())
+			{
+				ReleaseVoice(Voice);
+			}
+			continue;
+		}
+
+		bool IsAudible {false};
+		for (int32 Index {0}; Index < AudibleCount; ++Index)
+		{
+			if (Sources[Index].Component == Voice.Source)
+			{
+				IsAudible = true;
+				break;
+			}
+		}
+		if (!IsAudible)
+		{
+			ReleaseVoice(Voice);
+		}
+	}
+
+	const float FadeTime {GetDefault<UReacousticProjectSettings>()->SlidingFadeTime};
+	for (int32 Index {0}; Index < AudibleCount; ++Index)
+	{
+		const FReacousticSlidingSource& Source {Sources[Index]};
+		UReacousticSlidingAudioComponent* Component {Source.Component.Get()};
+
+		int32 VoiceIndex {FindVoice(Component)};
+		if (VoiceIndex == INDEX_NONE)
+		{
+			/** Prefer a voice that has finished fading out, so that fade outs are not cut short. */
+			VoiceIndex = Voices.IndexOfByPredicate([](const FReacousticSlidingVoice& Voice)
+			{
+				return Voice.Source.IsExplicitlyNull() && Voice.AudioComponent && !Voice.AudioComponent->IsPlaying();
+			});
+			if (VoiceIndex == INDEX_NONE)
+			{
+				VoiceIndex = Voices.IndexOfByPredicate([](const FReacousticSlidingVoice& Voice) { return Voice.Source.IsExplicitlyNull() && Voice.AudioComponent; });
+			}
+			if (VoiceIndex == INDEX_NONE) { continue; }
+
+			FReacousticSlidingVoice& Voice {Voices[VoiceIndex]};
+			Voice.Source = Component;
+			Voice.AudioComponent->SetWorldLocation(Source.Location);
+			Voice.AudioComponent->SetVolumeMultiplier(Source.Gain);
+			Component->ConfigureVoice(Voice.AudioComponent);
+			Voice.AudioComponent->FadeIn(FadeTime);
+		}
+
+		UAudioComponent* AudioComponent {Voices[VoiceIndex].AudioComponent};
+		AudioComponent->SetWorldLocation(Source.Location);
+		AudioComponent->SetVolumeMultiplier(Source.Gain);
+		Component->UpdateVoice(AudioComponent);
+	}
+}
+
+int32 UReacousticSlidingVoiceManager::FindVoice(const UReacousticSlidingAudioComponent* Component) const
+{
+	if (!Component) { return INDEX_NONE; }
+	return Voices.IndexOfByPredicate([Component](const FReacousticSlidingVoice& Voice) { return Voice.Source == Component; });
+}
+
+void UReacousticSlidingVoiceManager::ReleaseVoice(FReacousticSlidingVoice& Voice)
+{
+	Voice.Source.Reset();
+	if (Voice.AudioComponent && Voice.AudioComponent->IsPlaying())
+	{
+		Voice.AudioComponent->FadeOut(GetDefault<UReacousticProjectSettings>()->SlidingFadeTime, 0.0f);
+	}
+}
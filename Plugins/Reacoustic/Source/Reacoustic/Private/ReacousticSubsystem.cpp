@@ -3,11 +3,32 @@
 
 #include "ReacousticSubsystem.h"
 #include "ReacousticComponent.h"
+#include "ReacousticAudioComponentManager.h"
+#include "ReacousticSlidingAudioComponent.h"
+#include "ReacousticSlidingVoiceManager.h"
+#include "ReacousticBindingTable.h"
+#include "EngineUtils.h"
+#include "Chaos/EventManager.h"
+#include "Chaos/EventsData.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PBDRigidsSolver.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "GameFramework/PlayerController.h"
 #include "Components/SceneComponent.h"
 #include "Engine/StaticMeshActor.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/SceneComponent.h"
 #include "ReacousticDataTypes.h"
+#include "Reacoustic.h"
+
+DECLARE_CYCLE_STAT(TEXT("Process Impacts"), STAT_ReacousticProcessImpacts, STATGROUP_Reacoustic);
+DECLARE_CYCLE_STAT(TEXT("Handle Collision Events"), STAT_ReacousticHandleCollisionEvents, STATGROUP_Reacoustic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Collisions Received"), STAT_ReacousticCollisionsReceived, STATGROUP_Reacoustic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impacts Out Of Range"), STAT_ReacousticImpactsOutOfRange, STATGROUP_Reacoustic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impacts Submitted"), STAT_ReacousticImpactsSubmitted, STATGROUP_Reacoustic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impacts Merged"), STAT_ReacousticImpactsMerged, STATGROUP_Reacoustic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impacts Culled"), STAT_ReacousticImpactsCulled, STATGROUP_Reacoustic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impacts Played"), STAT_ReacousticImpactsPlayed, STATGROUP_Reacoustic);
 
 DEFINE_LOG_CATEGORY_CLASS(UReacousticSubsystem, LogReacousticSubsystem);
 
@@ -35,6 +56,366 @@ void UReacousticSubsystem::PostInitProperties()
 	}
 }
 
+void UReacousticSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+#if WITH_EDITOR
+	ReferenceMapChangedHandle = UReacousticSoundDataRef_Map::OnReferenceMapChanged.AddUObject(this, &UReacousticSubsystem::HandleReferenceMapChanged);
+	SoundDataAssetChangedHandle = UReacousticSoundDataAsset::OnSoundDataAssetChanged.AddUObject(this, &UReacousticSubsystem::HandleSoundDataAssetChanged);
+#endif
+
+	RebuildLookupTables();
+}
+
+void UReacousticSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	/** The voice pool is only needed in worlds that actually play sound, so we create it here rather than in Initialize. */
+	AudioComponentManager = NewObject<UReacousticAudioComponentManager>(this);
+	if (AudioComponentManager)
+	{
+		AudioComponentManager->Initialize(this);
+	}
+	SlidingVoiceManager = NewObject<UReacousticSlidingVoiceManager>(this);
+	if (SlidingVoiceManager)
+	{
+		SlidingVoiceManager->Initialize(this);
+	}
+
+	/** Collisions are received in bulk from the solver, rather than through a delegate on every component. */
+	if (FPhysScene* PhysicsScene {InWorld.GetPhysicsScene()})
+	{
+		if (Chaos::FPhysicsSolver* Solver {PhysicsScene->GetSolver()})
+		{
+			Solver->SetGenerateCollisionData(true);
+			Solver->GetEventManager()->RegisterHandler<Chaos::FCollisionEventData>(Chaos::EEventType::Collision, this, &UReacousticSubsystem::HandleCollisionEvents);
+			IsListeningToCollisionEvents = true;
+		}
+	}
+}
+
+TStatId UReacousticSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UReacousticSubsystem, STATGROUP_Reacoustic);
+}
+
+void UReacousticSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	ProcessPendingImpacts();
+	if (SlidingVoiceManager && SlidingVoiceManager->HasSources())
+	{
+		SlidingVoiceManager->Update();
+	}
+}
+
+bool UReacousticSubsystem::IsTickable() const
+{
+	return !PendingImpacts.IsEmpty() || (SlidingVoiceManager && SlidingVoiceManager->HasSources());
+}
+
+void UReacousticSubsystem::SubmitImpact(UReacousticComponent* Component, UPrimitiveComponent* HitComponent, AActor* OtherActor,
+	UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit, const float ImpactValue)
+{
+	if (!Component) { return; }
+	INC_DWORD_STAT(STAT_ReacousticImpactsSubmitted);
+
+	/** Hits between the same pair of bodies in a single frame are near duplicates, so we only keep the strongest one.
+	 *	The pair is ordered, which also catches the case where both bodies have a Reacoustic component and report the same contact. */
+	const TObjectKey<UPrimitiveComponent> HitKey {HitComponent};
+	const TObjectKey<UPrimitiveComponent> OtherKey {OtherComponent};
+	const TPair<TObjectKey<UPrimitiveComponent>, TObjectKey<UPrimitiveComponent>> PairKey {HitKey < OtherKey
+		? MakeTuple(HitKey, OtherKey) : MakeTuple(OtherKey, HitKey)};
+
+	if (const int32* PendingIndex {PendingImpactIndices.Find(PairKey)})
+	{
+		INC_DWORD_STAT(STAT_ReacousticImpactsMerged);
+		FReacousticQueuedImpact& Pending {PendingImpacts[*PendingIndex]};
+		if (ImpactValue > Pending.ImpactValue)
+		{
+			Pending.Component = Component;
+			Pending.HitComponent = HitComponent;
+			Pending.OtherActor = OtherActor;
+			Pending.OtherComponent = OtherComponent;
+			Pending.NormalImpulse = NormalImpulse;
+			Pending.Hit = Hit;
+			Pending.ImpactValue = ImpactValue;
+		}
+		return;
+	}
+
+	PendingImpactIndices.Add(PairKey, PendingImpacts.Num());
+	FReacousticQueuedImpact& Impact {PendingImpacts.AddDefaulted_GetRef()};
+	Impact.Component = Component;
+	Impact.HitComponent = HitComponent;
+	Impact.OtherActor = OtherActor;
+	Impact.OtherComponent = OtherComponent;
+	Impact.NormalImpulse = NormalImpulse;
+	Impact.Hit = Hit;
+	Impact.ImpactValue = ImpactValue;
+}
+
+bool UReacousticSubsystem::RegisterBody(UReacousticComponent* Component, UPrimitiveComponent* MeshComponent)
+{
+	if (!IsListeningToCollisionEvents || !Component || !MeshComponent) { return false; }
+
+	const FBodyInstance* BodyInstance {MeshComponent->GetBodyInstance()};
+	if (!BodyInstance || !BodyInstance->GetPhysicsActorHandle()) { return false; }
+	if (BodyIndices.Contains(MeshComponent)) { return true; }
+
+	BodyIndices.Add(MeshComponent, Bodies.Num());
+	FReacousticBody& Body {Bodies.AddDefaulted_GetRef()};
+	Body.Component = Component;
+	Body.MeshComponent = MeshComponent;
+	Body.MeshComponentKey = MeshComponent;
+	if (Component->GetMeshSoundDataIndex() != INDEX_NONE)
+	{
+		Body.SoundDataIndex = Component->GetMeshSoundDataIndex();
+	}
+	else if (const UStaticMeshComponent* StaticMeshComponent {Cast<UStaticMeshComponent>(MeshComponent)})
+	{
+		Body.SoundDataIndex = GetMeshSoundDataIndex(StaticMeshComponent->GetStaticMesh());
+	}
+	return true;
+}
+
+void UReacousticSubsystem::UnregisterBody(const UReacousticComponent* Component)
+{
+	const int32 Index {Bodies.IndexOfByPredicate([Component](const FReacousticBody& Body) { return Body.Component == Component; })};
+	if (Index == INDEX_NONE) { return; }
+
+	/** Keep the array dense by moving the last body into the freed slot. */
+	BodyIndices.Remove(Bodies[Index].MeshComponentKey);
+	Bodies.RemoveAtSwap(Index, 1, false);
+	if (Bodies.IsValidIndex(Index))
+	{
+		BodyIndices.Add(Bodies[Index].MeshComponentKey, Index);
+	}
+}
+
+bool UReacousticSubsystem::RegisterSlidingBody(UReacousticSlidingAudioComponent* Component, UPrimitiveComponent* MeshComponent)
+{
+	if (!IsListeningToCollisionEvents || !Component || !MeshComponent) { return false; }
+
+	const FBodyInstance* BodyInstance {MeshComponent->GetBodyInstance()};
+	if (!BodyInstance || !BodyInstance->GetPhysicsActorHandle()) { return false; }
+
+	SlidingBodies.Add(MeshComponent, Component);
+	return true;
+}
+
+void UReacousticSubsystem::UnregisterSlidingBody(const UReacousticSlidingAudioComponent* Component)
+{
+	for (auto It {SlidingBodies.CreateIterator()}; It; ++It)
+	{
+		if (It.Value() == Component)
+		{
+			It.RemoveCurrent();
+			return;
+		}
+	}
+}
+
+bool UReacousticSubsystem::IsImpactInRange(const int32 SoundDataIndex, const FVector& Location)
+{
+	if (!CullDistancesSquared.IsValidIndex(SoundDataIndex)) { return true; }
+
+	if (ListenerLocationFrame != GFrameCounter)
+	{
+		ListenerLocationFrame = GFrameCounter;
+		HasListenerLocation = false;
+		const UWorld* World {GetWorld()};
+		if (const APlayerController* PlayerController {World ? World->GetFirstPlayerController() : nullptr})
+		{
+			FVector ListenerFront;
+			FVector ListenerRight;
+			PlayerController->GetAudioListenerPosition(ListenerLocation, ListenerFront, ListenerRight);
+			HasListenerLocation = true;
+		}
+	}
+	if (!HasListenerLocation) { return true; }
+
+	if (FVector::DistSquared(ListenerLocation, Location) > CullDistancesSquared[SoundDataIndex])
+	{
+		INC_DWORD_STAT(STAT_ReacousticImpactsOutOfRange);
+		return false;
+	}
+	return true;
+}
+
+void UReacousticSubsystem::HandleCollisionEvents(const Chaos::FCollisionEventData& CollisionEventData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ReacousticHandleCollisionEvents);
+	if (Bodies.IsEmpty() && SlidingBodies.IsEmpty()) { return; }
+
+	const UWorld* World {GetWorld()};
+	FPhysScene* PhysicsScene {World ? World->GetPhysicsScene() : nullptr};
+	if (!PhysicsScene) { return; }
+
+	const Chaos::FCollisionDataArray& Collisions {CollisionEventData.CollisionData.AllCollisionsArray};
+	INC_DWORD_STAT_BY(STAT_ReacousticCollisionsReceived, Collisions.Num());
+
+	for (const Chaos::FCollidingData& Collision : Collisions)
+	{
+		/** The proxies are resolved through the physics scene, which forgets a proxy as soon as the physics state of its component is destroyed. */
+		UPrimitiveComponent* Component1 {PhysicsScene->GetOwningComponent<UPrimitiveComponent>(Collision.Proxy1)};
+		UPrimitiveComponent* Component2 {PhysicsScene->GetOwningComponent<UPrimitiveComponent>(Collision.Proxy2)};
+
+		/** Sliding bodies receive every contact, including the soft ones that are too weak to be heard as an impact. */
+		if (!SlidingBodies.IsEmpty())
+		{
+			if (const TWeakObjectPtr<UReacousticSlidingAudioComponent>* SlidingBody {SlidingBodies.Find(Component1)})
+			{
+				if (UReacousticSlidingAudioComponent* SlidingComponent {SlidingBody->Get()})
+				{
+					SlidingComponent->AddContact(FVector(Collision.Location), FVector(Collision.Normal), FVector(Collision.Velocity2));
+				}
+			}
+			if (const TWeakObjectPtr<UReacousticSlidingAudioComponent>* SlidingBody {SlidingBodies.Find(Component2)})
+			{
+				if (UReacousticSlidingAudioComponent* SlidingComponent {SlidingBody->Get()})
+				{
+					SlidingComponent->AddContact(FVector(Collision.Location), -FVector(Collision.Normal), FVector(Collision.Velocity1));
+				}
+			}
+		}
+
+		const int32* Index1 {BodyIndices.Find(Component1)};
+		const int32* Index2 {BodyIndices.Find(Component2)};
+		if (!Index1 && !Index2) { continue; }
+
+		/** A collision between two registered bodies is submitted for both of them. The subsystem merges them later. */
+		for (int32 Side {0}; Side < 2; ++Side)
+		{
+			const int32* Index {Side == 0 ? Index1 : Index2};
+			if (!Index) { continue; }
+
+			const FReacousticBody& Body {Bodies[*Index]};
+			UReacousticComponent* Component {Body.Component.Get()};
+			UPrimitiveComponent* MeshComponent {Body.MeshComponent.Get()};
+			if (!Component || !MeshComponent) { continue; }
+			if (!IsImpactInRange(Body.SoundDataIndex, FVector(Collision.Location))) { continue; }
+
+			/** This is the same impact value as UReacousticComponent::CalculateImpactValue: the relative velocity along the contact normal. */
+			const FVector RelativeVelocity {Side == 0 ? FVector(Collision.Velocity1 - Collision.Velocity2) : FVector(Collision.Velocity2 - Collision.Velocity1)};
+			const FVector Normal {Side == 0 ? FVector(Collision.Normal) : -FVector(Collision.Normal)};
+			const float ImpactValue {static_cast<float>(FMath::Abs(FVector::DotProduct(RelativeVelocity, Normal)))};
+			if (ImpactValue <= UReacousticComponent::MinImpactValue) { continue; }
+
+			UPrimitiveComponent* OtherComponent {Side == 0 ? Component2 : Component1};
+			AActor* OtherActor {OtherComponent ? OtherComponent->GetOwner() : nullptr};
+			const FVector NormalImpulse {Side == 0 ? FVector(Collision.AccumulatedImpulse) : -FVector(Collision.AccumulatedImpulse)};
+
+			FHitResult Hit;
+			Hit.bBlockingHit = true;
+			Hit.Location = Hit.ImpactPoint = FVector(Collision.Location);
+			Hit.Normal = Hit.ImpactNormal = Normal;
+			Hit.Component = OtherComponent;
+			Hit.HitObjectHandle = FActorInstanceHandle(OtherActor);
+			if (const FBodyInstance* OtherBodyInstance {OtherComponent ? OtherComponent->GetBodyInstance() : nullptr})
+			{
+				Hit.PhysMaterial = OtherBodyInstance->GetSimplePhysicalMaterial();
+			}
+
+			SubmitImpact(Component, MeshComponent, OtherActor, OtherComponent, NormalImpulse, Hit, ImpactValue);
+		}
+	}
+}
+
+void UReacousticSubsystem::ProcessPendingImpacts()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ReacousticProcessImpacts);
+	if (PendingImpacts.IsEmpty()) { return; }
+
+	/** The impacts are reordered below, so the merge indices are no longer valid. */
+	PendingImpactIndices.Reset();
+
+	/** Run the per-component filters first, so that the budget is only spent on impacts that would actually play. */
+	for (int32 Index {PendingImpacts.Num() - 1}; Index >= 0; --Index)
+	{
+		FReacousticQueuedImpact& Impact {PendingImpacts[Index]};
+		UReacousticComponent* Component {Impact.Component.Get()};
+		if (!Component || !Component->FilterImpact(Impact.ImpactValue, Impact.Hit))
+		{
+			INC_DWORD_STAT(STAT_ReacousticImpactsCulled);
+			PendingImpacts.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+		Impact.Priority = AudioComponentManager ? AudioComponentManager->CalculateVoicePriority(Impact.ImpactValue, Impact.Hit.ImpactPoint) : Impact.ImpactValue;
+	}
+
+	PendingImpacts.Sort([](const FReacousticQueuedImpact& A, const FReacousticQueuedImpact& B)
+	{
+		return A.Priority > B.Priority;
+	});
+
+	const int32 Budget {FMath::Max(1, GetDefault<UReacousticProjectSettings>()->MaxImpactsPerFrame)};
+	for (int32 Index {0}; Index < PendingImpacts.Num(); ++Index)
+	{
+		if (Index >= Budget)
+		{
+			INC_DWORD_STAT_BY(STAT_ReacousticImpactsCulled, PendingImpacts.Num() - Budget);
+			break;
+		}
+
+		const FReacousticQueuedImpact& Impact {PendingImpacts[Index]};
+		if (UReacousticComponent* Component {Impact.Component.Get()})
+		{
+			Component->PlayImpact(Impact.HitComponent.Get(), Impact.OtherActor.Get(), Impact.OtherComponent.Get(), Impact.NormalImpulse, Impact.Hit);
+			INC_DWORD_STAT(STAT_ReacousticImpactsPlayed);
+		}
+	}
+
+	PendingImpacts.Reset();
+}
+
+void UReacousticSubsystem::Deinitialize()
+{
+	PendingImpacts.Empty();
+	PendingImpactIndices.Empty();
+
+	if (IsListeningToCollisionEvents)
+	{
+		const UWorld* World {GetWorld()};
+		FPhysScene* PhysicsScene {World ? World->GetPhysicsScene() : nullptr};
+		if (Chaos::FPhysicsSolver* Solver {PhysicsScene ? PhysicsScene->GetSolver() : nullptr})
+		{
+			Solver->GetEventManager()->UnregisterHandler(Chaos::EEventType::Collision, this);
+		}
+		IsListeningToCollisionEvents = false;
+	}
+	Bodies.Empty();
+	BodyIndices.Empty();
+	SlidingBodies.Empty();
+
+	if (SlidingVoiceManager)
+	{
+		SlidingVoiceManager->Deinitialize(this);
+		SlidingVoiceManager->MarkAsGarbage();
+		SlidingVoiceManager = nullptr;
+	}
+
+	if (AudioComponentManager)
+	{
+		AudioComponentManager->Deinitialize(this);
+		AudioComponentManager->MarkAsGarbage();
+		AudioComponentManager = nullptr;
+	}
+
+#if WITH_EDITOR
+	UReacousticSoundDataRef_Map::OnReferenceMapChanged.Remove(ReferenceMapChangedHandle);
+	UReacousticSoundDataAsset::OnSoundDataAssetChanged.Remove(SoundDataAssetChangedHandle);
+#endif
+
+	MeshSoundDataIndices.Empty();
+	SurfaceSoundDataIndices.Empty();
+	CullDistancesSquared.Empty();
+	BakedLevels.Empty();
+
+	Super::Deinitialize();
+}
 
 void UReacousticSubsystem::OnActorSpawned(AActor* Actor)
 {
@@ -71,6 +452,69 @@ bool UReacousticSubsystem::IsReacousticCompatible(AActor* Actor)
 	return false;
 }
 
+UStaticMeshComponent* UReacousticSubsystem::FindCompatibleMeshComponent(const AActor* Actor)
+{
+	if (!Actor) { return nullptr; }
+
+	const UPrimitiveComponent* RootPrimitive {Cast<UPrimitiveComponent>(Actor->GetRootComponent())};
+	if (!RootPrimitive || !(RootPrimitive->IsSimulatingPhysics() || RootPrimitive->BodyInstance.bSimulatePhysics)) { return nullptr; }
+
+	TArray<UStaticMeshComponent*> Components;
+	Actor->GetComponents<UStaticMeshComponent>(Components);
+	for (UStaticMeshComponent* Component : Components)
+	{
+		if (Component->BodyInstance.bNotifyRigidBodyCollision)
+		{
+			return Component;
+		}
+	}
+	return nullptr;
+}
+
+void UReacousticSubsystem::InstantiateBindings(const AReacousticBindingTable* BindingTable)
+{
+	if (!BindingTable) { return; }
+	if (!BindingTable->ComponentClass)
+	{
+		UE_LOG(LogReacousticSubsystem, Warning, TEXT("%s has no component class set."), *BindingTable->GetName());
+		return;
+	}
+
+	if (BindingTable->SoundDataAsset && BindingTable->ReferenceMap)
+	{
+		SetSoundDataAssets(BindingTable->SoundDataAsset, BindingTable->ReferenceMap);
+	}
+	if (!ReacousticSoundDataRefMap || !ReacousticSoundDataAsset) { return; }
+
+	const FReacousticSoundData EmptySoundData {};
+	for (const FReacousticBinding& Binding : BindingTable->GetBindings())
+	{
+		const UStaticMeshComponent* MeshComponent {Binding.MeshComponent.Get()};
+		AActor* Actor {MeshComponent ? MeshComponent->GetOwner() : nullptr};
+		if (!Actor || Actor->FindComponentByClass(BindingTable->ComponentClass)) { continue; }
+
+		UReacousticComponent* Component {Cast<UReacousticComponent>(Actor->AddComponentByClass(BindingTable->ComponentClass, false, FTransform(), true))};
+		if (!Component) { continue; }
+
+		/** The data is transferred before the component is registered, so that it does not look up its mesh again when it begins play. */
+		const FReacousticSoundData* SoundData {GetSoundDataAtIndex(Binding.SoundDataIndex)};
+		Component->TransferData(ReacousticSoundDataAsset, ReacousticSoundDataRefMap, SoundData ? *SoundData : EmptySoundData);
+		Component->SetMeshSoundDataIndex(SoundData ? Binding.SoundDataIndex : INDEX_NONE);
+		Component->RegisterComponent();
+	}
+
+	BakedLevels.Add(BindingTable->GetLevel());
+	UE_LOG(LogReacousticSubsystem, Log, TEXT("Instantiated %d baked Reacoustic bindings from %s."), BindingTable->GetBindings().Num(), *BindingTable->GetName());
+}
+
+void UReacousticSubsystem::RemoveBindings(const AReacousticBindingTable* BindingTable)
+{
+	if (BindingTable)
+	{
+		BakedLevels.Remove(BindingTable->GetLevel());
+	}
+}
+
 /* Adds a reacousticComponent derived component to an actor. and returns the pointer to this component.*/
 void UReacousticSubsystem::AddBPReacousticComponentToActor(AActor* Actor, TSubclassOf<UReacousticComponent> ComponentClass, FReacousticSoundData MeshSoundData)
 {
@@ -141,11 +585,19 @@ void UReacousticSubsystem::PopulateWorldWithBPReacousticComponents(TSubclassOf<c
 		return;
 	}
 
-	if (!ReacousticSoundDataRefMap || !ReacousticSoundDataAsset)
+	UWorld* World {GetWorld()};
+	if (!World || !ReacousticSoundDataRefMap || !ReacousticSoundDataAsset)
 	{
 		return;
 	}
 
+	/** Binding tables may not have begun play yet, so the levels that have one are collected here as well. */
+	for (TActorIterator<AReacousticBindingTable> It(World); It; ++It)
+	{
+		BakedLevels.Add(It->GetLevel());
+	}
+
+	int32 SkippedActorCount {0};
 	TArray<AActor*> CompatibleActors {GetCompatibleActorsOfClass(AStaticMeshActor::StaticClass())};
 	for (AActor* Actor : CompatibleActors)
 	{
@@ -154,6 +606,12 @@ void UReacousticSubsystem::PopulateWorldWithBPReacousticComponents(TSubclassOf<c
 			continue;
 		}
 
+		if (BakedLevels.Contains(Actor->GetLevel()))
+		{
+			++SkippedActorCount;
+			continue;
+		}
+
 		TArray<UActorComponent*> Components{};
 		Actor->GetComponents(Components);
 		for (UActorComponent* ActorComponent : Components)
@@ -170,24 +628,127 @@ void UReacousticSubsystem::PopulateWorldWithBPReacousticComponents(TSubclassOf<c
 			}
 		}
 	}
+
+	if (SkippedActorCount > 0)
+	{
+		UE_LOG(LogReacousticSubsystem, Log, TEXT("Skipped populating %d actors in levels with a baked binding table."), SkippedActorCount);
+	}
 }
 
-FReacousticSoundData UReacousticSubsystem::GetMeshSoundData(const UStaticMeshComponent* StaticMeshComponent) const
+void UReacousticSubsystem::SetSoundDataAssets(UReacousticSoundDataAsset* SoundDataAsset, UReacousticSoundDataRef_Map* ReferenceMap)
 {
-	if (!StaticMeshComponent || !ReacousticSoundDataRefMap || !ReacousticSoundDataAsset)
+	ReacousticSoundDataAsset = SoundDataAsset;
+	ReacousticSoundDataRefMap = ReferenceMap;
+	RebuildLookupTables();
+
+	/** The sound data indices of registered bodies refer to the previous assets. */
+	for (FReacousticBody& Body : Bodies)
 	{
-		return FReacousticSoundData{};
+		const UStaticMeshComponent* StaticMeshComponent {Cast<UStaticMeshComponent>(Body.MeshComponent.Get())};
+		Body.SoundDataIndex = StaticMeshComponent ? GetMeshSoundDataIndex(StaticMeshComponent->GetStaticMesh()) : INDEX_NONE;
+	}
+}
+
+void UReacousticSubsystem::RebuildLookupTables()
+{
+	MeshSoundDataIndices.Reset();
+	SurfaceSoundDataIndices.Reset();
+	CullDistancesSquared.Reset();
+
+	/** Sound data without attenuation can be heard anywhere, so it is never culled. */
+	if (ReacousticSoundDataAsset)
+	{
+		CullDistancesSquared.Reserve(ReacousticSoundDataAsset->AudioData.Num());
+		for (const FReacousticSoundData& SoundData : ReacousticSoundDataAsset->AudioData)
+		{
+			const USoundAttenuation* Attenuation {SoundData.Attenuation};
+			const float CullDistance {Attenuation && Attenuation->Attenuation.bAttenuate ? Attenuation->Attenuation.GetMaxDimension() : 0.0f};
+			CullDistancesSquared.Add(CullDistance > 0.0f ? FMath::Square(CullDistance) : MAX_flt);
+		}
 	}
 
-	for (const auto& [Mesh, SoundDataRef] : ReacousticSoundDataRefMap->MeshMapEntries)
+	if (!ReacousticSoundDataRefMap) { return; }
+
+	MeshSoundDataIndices.Reserve(ReacousticSoundDataRefMap->MeshMapEntries.Num());
+	for (const FMeshToAudioMapEntry& Entry : ReacousticSoundDataRefMap->MeshMapEntries)
 	{
-		UStaticMesh* MeshPtr {Mesh};
-		const int32 SoundDataRefValue {SoundDataRef};
+		/** The first entry for a mesh wins, which matches the behavior of the previous linear search. */
+		if (Entry.Mesh && !MeshSoundDataIndices.Contains(Entry.Mesh))
+		{
+			MeshSoundDataIndices.Add(Entry.Mesh, Entry.ReacousticSoundDataRef);
+		}
+	}
 
-		if (StaticMeshComponent->GetStaticMesh() == MeshPtr)
+	SurfaceSoundDataIndices.Reserve(ReacousticSoundDataRefMap->PhysicalMaterialMapEntries.Num());
+	for (const FPhysicalMaterialToAudioMapEntry& Entry : ReacousticSoundDataRefMap->PhysicalMaterialMapEntries)
+	{
+		if (!SurfaceSoundDataIndices.Contains(Entry.SurfaceType))
 		{
-			return ReacousticSoundDataAsset->AudioData[SoundDataRefValue];
+			SurfaceSoundDataIndices.Add(Entry.SurfaceType, Entry.ReacousticSoundDataRef);
 		}
 	}
+
+	UE_LOG(LogReacousticSubsystem, Verbose, TEXT("Built Reacoustic lookup tables with %d meshes and %d surfaces."), MeshSoundDataIndices.Num(), SurfaceSoundDataIndices.Num());
+}
+
+#if WITH_EDITOR
+void UReacousticSubsystem::HandleReferenceMapChanged(UReacousticSoundDataRef_Map* ReferenceMap)
+{
+	if (ReferenceMap == ReacousticSoundDataRefMap)
+	{
+		SetSoundDataAssets(ReacousticSoundDataAsset, ReacousticSoundDataRefMap);
+	}
+}
+
+void UReacousticSubsystem::HandleSoundDataAssetChanged(UReacousticSoundDataAsset* SoundDataAsset)
+{
+	if (SoundDataAsset == ReacousticSoundDataAsset)
+	{
+		SetSoundDataAssets(ReacousticSoundDataAsset, ReacousticSoundDataRefMap);
+	}
+}
+#endif
+
+int32 UReacousticSubsystem::GetMeshSoundDataIndex(const UStaticMesh* Mesh) const
+{
+	if (!Mesh) { return INDEX_NONE; }
+
+	const int32* Index {MeshSoundDataIndices.Find(Mesh)};
+	return Index ? *Index : INDEX_NONE;
+}
+
+int32 UReacousticSubsystem::GetSurfaceSoundDataIndex(const EPhysicalSurface SurfaceType) const
+{
+	const int32* Index {SurfaceSoundDataIndices.Find(SurfaceType)};
+	return Index ? *Index : INDEX_NONE;
+}
+
+const FReacousticSoundData* UReacousticSubsystem::GetSoundDataAtIndex(const int32 Index) const
+{
+	if (!ReacousticSoundDataAsset || !ReacousticSoundDataAsset->AudioData.IsValidIndex(Index)) { return nullptr; }
+	return &ReacousticSoundDataAsset->AudioData[Index];
+}
+
+FReacousticSoundData UReacousticSubsystem::GetMeshSoundData(const UStaticMeshComponent* StaticMeshComponent) const
+{
+	if (!StaticMeshComponent || !ReacousticSoundDataRefMap || !ReacousticSoundDataAsset)
+	{
+		return FReacousticSoundData{};
+	}
+
+	if (const FReacousticSoundData* SoundData {GetSoundDataAtIndex(GetMeshSoundDataIndex(StaticMeshComponent->GetStaticMesh()))})
+	{
+		return *SoundData;
+	}
 	return FReacousticSoundData{};
-}
\ No newline at end of file
+}
+
+bool UReacousticSubsystem::GetSurfaceSoundData(const EPhysicalSurface SurfaceType, FReacousticSoundData& OutSoundData) const
+{
+	if (const FReacousticSoundData* SoundData {GetSoundDataAtIndex(GetSurfaceSoundDataIndex(SurfaceType))})
+	{
+		OutSoundData = *SoundData;
+		return true;
+	}
+	return false;
+}
@@ -9,6 +9,11 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 #include "Engine/StaticMesh.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Reacoustic"), STATGROUP_Reacoustic, STATCAT_Advanced);
+
+REACOUSTIC_API DECLARE_LOG_CATEGORY_EXTERN(LogReacoustic, Log, All);
 
 class FReacousticModule : public IModuleInterface
 {
@@ -7,6 +7,21 @@
 #include "ReacousticSubsystemComponent.h"
 #include "ReacousticAudioComponentManager.generated.h"
 
+class UAudioComponent;
+
+/** Bookkeeping for an AudioComponent that is currently acquired from the pool. */
+USTRUCT()
+struct FReacousticVoiceState
+{
+	GENERATED_BODY()
+
+	/** The priority the voice was acquired with. */
+	float Priority {0.0f};
+
+	/** The world time at which the voice was acquired. */
+	double StartTime {0.0};
+};
+
 UCLASS()
 class UReacousticAudioComponentManager : public UReacousticSubsystemComponent
 {
@@ -25,9 +40,36 @@ private:
 	UPROPERTY(Transient)
 	TArray<UAudioComponent*> ActiveAudioComponents;
 
-protected:
+	/** The state of every active AudioComponent, indexed the same as ActiveAudioComponents. */
+	UPROPERTY(Transient)
+	TArray<FReacousticVoiceState> ActiveVoiceStates;
+
+public:
 	virtual void Initialize(UReacousticSubsystem* Subsystem) override;
+	virtual void Deinitialize(UReacousticSubsystem* Subsystem) override;
+
+	/** Acquires an AudioComponent from the pool and moves it to a location.
+	 *	If the pool is exhausted, the voice with the lowest priority is stolen, as long as its priority is lower than the requested priority.
+	 *	The AudioComponent is returned to the pool automatically when it finishes playing.
+	 *	@Location The world location to play the sound at.
+	 *	@Priority The priority of the sound. Use CalculateVoicePriority to derive it from an impact.
+	 *	@Return The acquired AudioComponent, or nullptr if every voice is more important than the request.
+	 */
+	UAudioComponent* AcquireAudioComponent(const FVector& Location, const float Priority);
+
+	/** Stops an AudioComponent and returns it to the pool. */
+	void ReleaseAudioComponent(UAudioComponent* AudioComponent);
+
+	/** Returns the priority for an impact of a given strength at a location, based on the distance to the listener. */
+	float CalculateVoicePriority(const float ImpactStrength, const FVector& Location) const;
+
+private:
+	/** Returns the priority of an active voice, decayed by the time it has been playing. */
+	float GetEffectivePriority(const int32 ActiveIndex, const double Time) const;
+
+	/** Called when a pooled AudioComponent has finished playing. */
+	void HandleAudioFinished(UAudioComponent* AudioComponent);
 
 public:
 	FORCEINLINE TArray<UAudioComponent*> GetActiveAudioComponents() const { return ActiveAudioComponents; }
-};
\ No newline at end of file
+};
@@ -0,0 +1,74 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ReacousticBindingTable.generated.h"
+
+class UReacousticComponent;
+class UReacousticSoundDataAsset;
+class UReacousticSoundDataRef_Map;
+class UStaticMeshComponent;
+
+/** A single baked binding between a static mesh component in the level and its Reacoustic sound data. */
+USTRUCT()
+struct FReacousticBinding
+{
+	GENERATED_BODY()
+
+	/** The mesh component that generates the hit events. The Reacoustic component is added to its owner. */
+	UPROPERTY(VisibleAnywhere, Category = "Reacoustic")
+	TObjectPtr<UStaticMeshComponent> MeshComponent {nullptr};
+
+	/** Index into the audio data of the sound data asset, or INDEX_NONE if the mesh has no sound data. */
+	UPROPERTY(VisibleAnywhere, Category = "Reacoustic")
+	int32 SoundDataIndex {INDEX_NONE};
+};
+
+/** Holds the Reacoustic bindings of a level. The bindings are baked whenever the level is saved or cooked,
+ *	so that the subsystem can add Reacoustic components at level start without scanning the world.
+ *	Place a single binding table in every level that contains Reacoustic compatible actors. */
+UCLASS(NotBlueprintable, ClassGroup = "Reacoustic", HideCategories = (Rendering, Replication, Collision, Input, LOD, Cooking),
+	Meta = (DisplayName = "Reacoustic Binding Table"))
+class REACOUSTIC_API AReacousticBindingTable : public AActor
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogReacousticBindingTable, Log, All)
+
+public:
+	/** The Reacoustic component class that is added to every bound actor. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Reacoustic")
+	TSubclassOf<UReacousticComponent> ComponentClass;
+
+	/** The sound data asset that the binding indices refer to. Passed to the subsystem at level start. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Reacoustic")
+	UReacousticSoundDataAsset* SoundDataAsset {nullptr};
+
+	/** The reference map that is used to resolve the sound data of the bound meshes. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Reacoustic")
+	UReacousticSoundDataRef_Map* ReferenceMap {nullptr};
+
+private:
+	/** The baked bindings. */
+	UPROPERTY(VisibleAnywhere, Category = "Reacoustic")
+	TArray<FReacousticBinding> Bindings;
+
+public:
+	AReacousticBindingTable();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+
+	/** Returns the baked bindings. */
+	FORCEINLINE const TArray<FReacousticBinding>& GetBindings() const { return Bindings; }
+
+#if WITH_EDITOR
+	/** Rebakes the bindings from the actors in the level of this table. */
+	UFUNCTION(CallInEditor, Category = "Reacoustic")
+	void BakeBindings();
+#endif
+};
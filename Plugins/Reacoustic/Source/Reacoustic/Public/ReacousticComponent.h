@@ -6,6 +6,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "ReacousticDataTypes.h"
+#include "ReacousticRingBuffer.h"
 #include "components/AudioComponent.h"
 #include "ReacousticComponent.generated.h"
 
@@ -18,10 +19,20 @@ class REACOUSTIC_API UReacousticComponent : public UActorComponent
 
 	DECLARE_LOG_CATEGORY_CLASS(LogReacousticComponent, Log, All)
 
+public:
+	/** The amount of hit states kept in the hit history. */
+	static constexpr int32 HitHistorySize {20};
+
 protected:
+	/** The pooled AudioComponent that was acquired for the most recent hit. This is owned by the Reacoustic subsystem,
+	 *	and is returned to the pool when it finishes playing. Can be nullptr if the hit was not important enough to get a voice. */
 	UPROPERTY(Transient, BlueprintReadOnly)
 	UAudioComponent* AudioComponent {nullptr};
 
+	/** The sound that is played on acquired voices. */
+	UPROPERTY(Transient, BlueprintReadOnly)
+	USoundBase* ImpactSound {nullptr};
+
 	UPROPERTY(Transient, BlueprintReadWrite, Meta = (DisplayName = "Sound Data Asset"))
 	UReacousticSoundDataAsset* ReacousticSoundDataAsset {nullptr};
 
@@ -30,7 +41,22 @@ protected:
 
 	UPROPERTY(BlueprintReadWrite)
 	FReacousticSoundData MeshAudioData;
+
+	/** The index in the sound data asset of the surface that was hit most recently. Only valid if HasSurfaceAudioData is true. */
+	UPROPERTY(BlueprintReadOnly)
+	int32 SurfaceSoundDataIndex {INDEX_NONE};
+
+	/** Whether sound data was found for the surface that was hit most recently. */
+	UPROPERTY(BlueprintReadOnly)
+	bool HasSurfaceAudioData {false};
 	
+	/** The index of MeshAudioData in the sound data asset, or INDEX_NONE if it is not known. */
+	int32 MeshSoundDataIndex {INDEX_NONE};
+
+	/** Whether sound data was transferred to this component before it began play, for example from a baked binding table.
+	 *	If so, the component does not look up the sound data of its mesh when it is initialized. */
+	bool HasTransferredData {false};
+
 	/** Used to choose the impact sound during a hit.*/
 	UPROPERTY(BlueprintReadOnly, Category = Default, Meta = (DisplayName = "Impact Force"))	
 	float ImpactForce;
@@ -54,14 +80,17 @@ private:
 	FVector LatestRightVector;
 	FVector LatestUpVector;
 	
-	TArray<float> DeltaStateArray;
+	/** History of the latest hit states, used to detect erratic hits in the same location. */
+	TStaticRingBuffer<float, HitHistorySize> DeltaStateArray;
 	
-	/** Array used to store the latest hit values so that we can prevent multiple triggers of the same sound.*/
-	UPROPERTY(BlueprintReadOnly, Meta = (DisplayName = "Latest Hit Results", AllowPrivateAccess = "true"))
-	TArray<float> LatestMatchingElements;
+	/** Buffer used to store the latest hit values so that we can prevent multiple triggers of the same sound.*/
+	TStaticRingBuffer<float, 10> LatestMatchingElements;
 
 public:	
 	UReacousticComponent();
+
+	/** Impacts with an impact value at or below this value are never played. */
+	static constexpr float MinImpactValue {30.0f};
 	
 	/** Callback function for the OnHit event delegate of a physics enabled static mesh component.
 	 *	@HitComp The component that was hit.
@@ -87,6 +116,18 @@ public:
 	UFUNCTION(BlueprintGetter, Category = Reacoustic, Meta = (DisplayName = "Get Owner StaticMeshComponent"))
 	FORCEINLINE UStaticMeshComponent* GetOwnerMeshComponent() const {return MeshComponent; }
 	
+	/** Returns the sound data of the surface that was hit most recently, or nullptr if the surface has no sound data. */
+	const FReacousticSoundData* GetSurfaceSoundData() const;
+
+	/** Copies the sound data of the surface that was hit most recently.
+	 *	@Return False if the surface has no sound data. */
+	UFUNCTION(BlueprintPure, Category = "Reacoustic", Meta = (DisplayName = "Get Surface Audio Data"))
+	bool GetSurfaceAudioData(FReacousticSoundData& OutSoundData) const;
+
+	/** Returns the latest hit values, from oldest to newest. */
+	UFUNCTION(BlueprintPure, Meta = (DisplayName = "Get Latest Hit Results"))
+	FORCEINLINE TArray<float> GetLatestMatchingElements() const { return LatestMatchingElements.ToArray(); }
+	
 	/** Get the time interval between hits */
 	UFUNCTION(BlueprintPure)
 	double ReturnDeltaTime();
@@ -95,14 +136,37 @@ public:
 	UFUNCTION(BlueprintPure)
 	double ReturnDeltaLocationDistance();
 	
+	/** Sets the index of the transferred mesh sound data in the sound data asset. */
+	FORCEINLINE void SetMeshSoundDataIndex(const int32 Index) { MeshSoundDataIndex = Index; }
+
+	/** Returns the index of the mesh sound data in the sound data asset, or INDEX_NONE if it is not known. */
+	FORCEINLINE int32 GetMeshSoundDataIndex() const { return MeshSoundDataIndex; }
+
 	UFUNCTION()
 	void TransferData(UReacousticSoundDataAsset* SoundDataArray, UReacousticSoundDataRef_Map* ReferenceMap, FReacousticSoundData MeshSoundDataIn);
 
 	bool FilterImpact(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 	                  FVector NormalImpulse, const FHitResult& Hit);
 
+	/** Filters an impact of which the impact value was already calculated at the time of the hit. */
+	bool FilterImpact(const float ImpactValue, const FHitResult& Hit);
+
+	/** Acquires a voice for a hit that passed filtering and calls OnComponentHit. Called by the subsystem when it processes its impact queue. */
+	void PlayImpact(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	/** Finds the onset with a volume closest to the impact value, skipping onsets close to the latest matches.
+	 *	Uses a binary search on the sorted onsets of the sound data, or a linear search if they haven't been built. */
 	UFUNCTION(BlueprintCallable)
-	int FindTimeStampEntry(FReacousticSoundData SoundData, float ImpactValue);
+	int FindTimeStampEntry(const FReacousticSoundData& SoundData, float ImpactValue);
+
+	/** Acquires a pooled voice for an impact, configures it with this component's sound data and starts playing it.
+	 *	The acquired voice is also stored in AudioComponent, and returns to the pool when it finishes playing.
+	 *	@Location The world location of the impact.
+	 *	@ImpactStrength The strength of the impact, used to prioritize the voice.
+	 *	@Return The acquired AudioComponent, or nullptr if the impact was not important enough to get a voice.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Reacoustic", Meta = (DisplayName = "Acquire Voice"))
+	UAudioComponent* AcquireVoice(const FVector& Location, const float ImpactStrength);
 
 
 protected:
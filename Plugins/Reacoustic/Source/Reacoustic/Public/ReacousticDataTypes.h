@@ -9,6 +9,19 @@
 #include "Sound/SoundAttenuation.h"
 #include "ReacousticDataTypes.generated.h"
 
+/** A single onset in a sound wave, stored in an array sorted by volume. */
+USTRUCT(BlueprintType)
+struct FReacousticOnsetEntry
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Analysis)
+	float Volume {0.0f};
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Analysis)
+	float TimeStamp {0.0f};
+};
+
 USTRUCT(BlueprintType)
 struct FReacousticSoundData
 {
@@ -32,6 +45,14 @@ struct FReacousticSoundData
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Analysis)
 	TArray<float> OnsetVolumeData;
 
+	/** The entries of OnsetDataMap sorted by volume. Built when the owning asset is saved. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = Analysis)
+	TArray<FReacousticOnsetEntry> SortedOnsets;
+
+	/** The hash of the contents of OnsetDataMap at the time SortedOnsets was built. */
+	UPROPERTY()
+	uint32 SortedOnsetsHash {0};
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Sounds)
 	USoundWave* ImpactWaveAsset {nullptr};
 
@@ -53,6 +74,15 @@ struct FReacousticSoundData
 	
 
 	FReacousticSoundData(){}
+
+	/** Rebuilds SortedOnsets from OnsetDataMap. */
+	void BuildSortedOnsets();
+
+	/** Returns a hash of the contents of OnsetDataMap, independent of the order of its entries. */
+	uint32 GetOnsetDataHash() const;
+
+	/** Returns whether SortedOnsets is in sync with OnsetDataMap. */
+	FORCEINLINE bool HasSortedOnsets() const { return SortedOnsets.Num() == OnsetDataMap.Num() && SortedOnsetsHash == GetOnsetDataHash(); }
 	
 };
 
@@ -65,6 +95,22 @@ public:
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = ReacousticSoundData)
 	TArray<FReacousticSoundData> AudioData;
+
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	/** Broadcast when a sound data asset is edited, so that lookup tables built from it can be rebuilt. */
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnSoundDataAssetChanged, UReacousticSoundDataAsset*);
+	static FOnSoundDataAssetChanged OnSoundDataAssetChanged;
+
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	/** Analyzes the impact wave assets and overwrites the onset tables of every entry.
+	 *	Use the ReacousticOnsetAnalysis commandlet to analyze every asset in the project at once. */
+	UFUNCTION(CallInEditor, Category = Analysis)
+	void AnalyzeOnsets();
+#endif
 	
 };
 
@@ -104,6 +150,14 @@ public:
  
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = MaterialToAudioMap)
 	TArray<FPhysicalMaterialToAudioMapEntry> PhysicalMaterialMapEntries;
+
+#if WITH_EDITOR
+	/** Broadcast when a reference map is edited, so that lookup tables built from it can be rebuilt. */
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnReferenceMapChanged, UReacousticSoundDataRef_Map*);
+	static FOnReferenceMapChanged OnReferenceMapChanged;
+
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 };
 
 USTRUCT(BlueprintType)
@@ -0,0 +1,52 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReacousticDataTypes.h"
+
+/** Settings for the offline onset analysis of impact sounds. */
+struct FReacousticOnsetAnalysisSettings
+{
+	/** The log2 of the amount of samples per analysis frame. */
+	int32 FFTLog2Size {10};
+
+	/** The amount of samples between analysis frames. Must be a multiple of 4. */
+	int32 HopSize {256};
+
+	/** The attack and release time of the envelope follower, in seconds. */
+	float EnvelopeAttackTime {0.001f};
+	float EnvelopeReleaseTime {0.08f};
+
+	/** How far the spectral flux has to rise above its local mean to count as an onset. */
+	float Sensitivity {1.5f};
+
+	/** The minimum time between two onsets, in seconds. */
+	float MinOnsetInterval {0.03f};
+
+	/** The impact value that the loudest point of a sound is matched with. Quieter onsets are scaled down towards the minimum impact value. */
+	float MaxImpactValue {1000.0f};
+};
+
+/** Detects onsets in impact sounds and writes them to the onset tables of Reacoustic sound data.
+ *	Onsets are detected with a spectral flux detector, and the volume of each onset is read from an envelope follower.
+ *	Volumes are stored in the same units as impact values, so that FindTimeStampEntry can match them directly. */
+class REACOUSTIC_API FReacousticOnsetAnalyzer
+{
+	DECLARE_LOG_CATEGORY_CLASS(LogReacousticOnsetAnalysis, Log, All)
+
+public:
+	/** Detects the onsets in a mono signal. The onsets are sorted by time. */
+	static void AnalyzeSamples(TArrayView<const float> Samples, const int32 SampleRate, const FReacousticOnsetAnalysisSettings& Settings,
+		TArray<FReacousticOnsetEntry>& OutOnsets);
+
+#if WITH_EDITOR
+	/** Reads the imported PCM data of a sound wave and downmixes it to mono. */
+	static bool GetMonoSamples(const USoundWave* SoundWave, TArray<float>& OutSamples, int32& OutSampleRate);
+
+	/** Analyzes the impact wave asset of every sound data entry in the assets in parallel, and writes the onset tables back.
+	 *	Assets that were changed are marked dirty. Returns the amount of sound data entries that were analyzed. */
+	static int32 AnalyzeAssets(TArrayView<UReacousticSoundDataAsset* const> Assets, const FReacousticOnsetAnalysisSettings& Settings);
+#endif
+};
@@ -0,0 +1,23 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ReacousticOnsetAnalysisCommandlet.generated.h"
+
+/** Re-analyzes the onsets of every Reacoustic sound data asset in the project and saves the assets.
+ *	Usage: UnrealEditor-Cmd.exe <Project> -run=ReacousticOnsetAnalysis [-path=/Game/Audio] [-sensitivity=1.5] [-maximpactvalue=1000] [-nosave] */
+UCLASS()
+class REACOUSTIC_API UReacousticOnsetAnalysisCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogReacousticOnsetAnalysisCommandlet, Log, All)
+
+public:
+	UReacousticOnsetAnalysisCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
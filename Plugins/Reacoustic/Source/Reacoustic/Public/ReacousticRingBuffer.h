@@ -0,0 +1,117 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Nino Saglia.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Fixed capacity ring buffer that keeps a running sum, minimum and maximum of its elements.
+ *	Pushing to a full buffer overwrites the oldest element. The buffer never allocates, which makes it suitable for
+ *	short histories that are updated on every hit. Index 0 is the oldest element. */
+template <typename T, int32 N>
+class TStaticRingBuffer
+{
+	static_assert(N > 0, "TStaticRingBuffer requires a capacity larger than zero.");
+
+public:
+	TStaticRingBuffer()
+	{
+		Reset();
+	}
+
+	/** Adds an element to the buffer, overwriting the oldest element if the buffer is full. */
+	void Push(const T& Element)
+	{
+		if (Count == N)
+		{
+			const T Evicted {Elements[Head]};
+			Elements[Head] = Element;
+			Head = (Head + 1) % N;
+			Sum = Sum - Evicted + Element;
+
+			/** Rescan the buffer if the evicted element was an extreme. We also rebuild the sum once per full cycle,
+			 *	so that floating point error can't accumulate. */
+			if (!(Min < Evicted) || !(Evicted < Max) || Head == 0)
+			{
+				UpdateAggregates();
+			}
+			else
+			{
+				Min = Element < Min ? Element : Min;
+				Max = Max < Element ? Element : Max;
+			}
+			return;
+		}
+
+		Elements[(Head + Count) % N] = Element;
+		Sum = Count == 0 ? Element : Sum + Element;
+		Min = Count == 0 || Element < Min ? Element : Min;
+		Max = Count == 0 || Max < Element ? Element : Max;
+		++Count;
+	}
+
+	/** Removes all elements from the buffer. */
+	void Reset()
+	{
+		Head = 0;
+		Count = 0;
+		Sum = T {};
+		Min = T {};
+		Max = T {};
+	}
+
+	FORCEINLINE int32 Num() const { return Count; }
+	FORCEINLINE bool IsEmpty() const { return Count == 0; }
+	FORCEINLINE bool IsFull() const { return Count == N; }
+	FORCEINLINE static constexpr int32 Capacity() { return N; }
+
+	/** Returns the sum of all elements, or a default value if the buffer is empty. */
+	FORCEINLINE T GetSum() const { return Sum; }
+
+	/** Returns the smallest element, or a default value if the buffer is empty. */
+	FORCEINLINE T GetMin() const { return Min; }
+
+	/** Returns the largest element, or a default value if the buffer is empty. */
+	FORCEINLINE T GetMax() const { return Max; }
+
+	/** Returns the element at the index, where 0 is the oldest element. */
+	FORCEINLINE const T& operator[](const int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		return Elements[(Head + Index) % N];
+	}
+
+	/** Copies the elements to an array, from oldest to newest. */
+	TArray<T> ToArray() const
+	{
+		TArray<T> Array;
+		Array.Reserve(Count);
+		for (int32 Index {0}; Index < Count; ++Index)
+		{
+			Array.Add((*this)[Index]);
+		}
+		return Array;
+	}
+
+private:
+	/** Recalculates the sum, minimum and maximum from the stored elements. */
+	void UpdateAggregates()
+	{
+		if (Count == 0) { return; }
+		Sum = Min = Max = (*this)[0];
+		for (int32 Index {1}; Index < Count; ++Index)
+		{
+			const T& Element {(*this)[Index]};
+			Sum = Sum + Element;
+			Min = Element < Min ? Element : Min;
+			Max = Max < Element ? Element : Max;
+		}
+	}
+
+	T Elements[N];
+	int32 Head {0};
+	int32 Count {0};
+	T Sum {};
+	T Min {};
+	T Max {};
+};
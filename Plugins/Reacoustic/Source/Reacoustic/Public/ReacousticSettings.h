@@ -32,6 +32,22 @@ public:
 	UPROPERTY(Config, EditAnywhere, Meta = (AllowedClasses = UReacousticComponent))
 	FSoftObjectPath ReacousticComponent;
 
+	/** The amount of pooled AudioComponents that impact sounds can play on. When every voice is in use, the quietest voice is stolen. */
+	UPROPERTY(Config, EditAnywhere, Category = "Voices", Meta = (ClampMin = "1", ClampMax = "256", UIMin = "1", UIMax = "128"))
+	int32 VoicePoolSize {32};
+
+	/** The maximum amount of impacts that can start playing in a single frame. The least audible impacts are culled first. */
+	UPROPERTY(Config, EditAnywhere, Category = "Voices", Meta = (ClampMin = "1", ClampMax = "64", UIMin = "1", UIMax = "32"))
+	int32 MaxImpactsPerFrame {8};
+
+	/** The amount of pooled AudioComponents that sliding and rolling loops can play on. Only the most audible sliding objects get a voice. */
+	UPROPERTY(Config, EditAnywhere, Category = "Voices", Meta = (ClampMin = "1", ClampMax = "32", UIMin = "1", UIMax = "16"))
+	int32 MaxSlidingVoices {4};
+
+	/** The time it takes for a sliding loop to fade in or out when it gains or loses its voice. */
+	UPROPERTY(Config, EditAnywhere, Category = "Voices", Meta = (Units = "Seconds", ClampMin = "0", UIMax = "1"))
+	float SlidingFadeTime {0.15f};
+
 protected:
 	/** The GENERATED data used by the reacoustic subsystem.#1#*/
 	UReacousticSoundDataAsset* ReacousticSoundDataAsset;
@@ -7,22 +7,134 @@
 #include "Components/ActorComponent.h"
 #include "ReacousticSlidingAudioComponent.generated.h"
 
-UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
-class UReacousticSlidingAudioComponent : public UActorComponent
+class UAudioComponent;
+class USoundAttenuation;
+class USoundConcurrency;
+
+/** Plays a sliding or rolling loop while the physics body of the owner is in sustained contact with something.
+ *	Contacts are received from the Reacoustic subsystem and aggregated per frame. The loop is played on a voice from the
+ *	subsystem's sliding voice pool, which only the most audible sliding objects get. The component only ticks while its body is awake. */
+UCLASS(Blueprintable, ClassGroup = "Reacoustic", Meta = (BlueprintSpawnableComponent))
+class REACOUSTIC_API UReacousticSlidingAudioComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
-public:	
-	// Sets default values for this component's properties
+	DECLARE_LOG_CATEGORY_CLASS(LogReacousticSlidingAudioComponent, Log, All)
+
+protected:
+	/** The sound to play the loop with. The sliding wave asset of the mesh is passed to it as Obj_WaveAsset.
+	 *	If not set, the sliding wave asset is played directly, in which case it should be set to loop. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding")
+	USoundBase* SlidingSound {nullptr};
+
+	/** The speed at which the contact point has to slip before the loop is heard. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding", Meta = (Units = "CentimetersPerSecond", ClampMin = "0"))
+	float MinSlidingSpeed {10.0f};
+
+	/** The slip speed at which the loop reaches full volume. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding", Meta = (Units = "CentimetersPerSecond", ClampMin = "1"))
+	float FullSlidingSpeed {300.0f};
+
+	/** The rolling speed at which the loop reaches full volume. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding", Meta = (Units = "CentimetersPerSecond", ClampMin = "1"))
+	float FullRollingSpeed {400.0f};
+
+	/** How loud rolling is compared to sliding. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding", Meta = (ClampMin = "0", ClampMax = "1"))
+	float RollingGain {0.6f};
+
+	/** The time the body has to be in contact before the loop reaches full volume. Short contacts are heard as impacts instead. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding", Meta = (Units = "Seconds", ClampMin = "0"))
+	float ContactPersistenceTime {0.15f};
+
+	/** The time after the last contact after which the body is no longer considered to be in contact. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding", Meta = (Units = "Seconds", ClampMin = "0"))
+	float ContactTimeout {0.1f};
+
+	/** The pitch of the loop at the minimum and full sliding speed. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sliding", Meta = (ClampMin = "0.1"))
+	FVector2D PitchRange {0.8f, 1.2f};
+
+private:
+	/** The physics body that the sliding is detected for. */
+	UPROPERTY(Transient)
+	UPrimitiveComponent* MeshComponent {nullptr};
+
+	/** The sound data of the mesh. */
+	UPROPERTY(Transient)
+	USoundWave* SlidingWaveAsset {nullptr};
+
+	UPROPERTY(Transient)
+	USoundAttenuation* Attenuation {nullptr};
+
+	UPROPERTY(Transient)
+	USoundConcurrency* Concurrency {nullptr};
+
+	/** The contacts that were received since the last tick. */
+	FVector ContactLocationSum {FVector::ZeroVector};
+	FVector ContactNormalSum {FVector::ZeroVector};
+	FVector ContactVelocitySum {FVector::ZeroVector};
+	int32 ContactCount {0};
+
+	/** The averaged contact of the latest frame that had contacts. */
+	FVector ContactLocation {FVector::ZeroVector};
+	FVector ContactNormal {FVector::UpVector};
+	FVector ContactVelocity {FVector::ZeroVector};
+	double LatestContactTime {-1.0};
+
+	/** How long the body has been in uninterrupted contact. */
+	float ContactPersistence {0.0f};
+
+	float SlidingSpeed {0.0f};
+	float RollingSpeed {0.0f};
+	float Gain {0.0f};
+
+	/** Whether the subsystem forwards collisions of the body, or whether we bound to OnComponentHit ourselves. */
+	bool IsRegisteredToSubsystem {false};
+
+	/** Whether we enabled hit notifications on the mesh for OnComponentHit, so that they are disabled again at the end of play. */
+	bool HasEnabledHitNotifications {false};
+
+public:
 	UReacousticSlidingAudioComponent();
 
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Adds a contact of the body. Contacts are averaged per frame.
+	 *	@Location The world location of the contact.
+	 *	@Normal The contact normal.
+	 *	@OtherVelocity The velocity of the other body at the time of the contact. */
+	void AddContact(const FVector& Location, const FVector& Normal, const FVector& OtherVelocity);
+
+	/** Applies the sound and sound data of this component to a voice that was just assigned to it. */
+	void ConfigureVoice(UAudioComponent* AudioComponent) const;
+
+	/** Updates the parameters of the voice that is assigned to this component. */
+	void UpdateVoice(UAudioComponent* AudioComponent) const;
+
+	/** Returns the speed at which the contact point slips over the surface. */
+	UFUNCTION(BlueprintPure, Category = "Sliding")
+	FORCEINLINE float GetSlidingSpeed() const { return SlidingSpeed; }
+
+	/** Returns the speed at which the body rolls over the surface. */
+	UFUNCTION(BlueprintPure, Category = "Sliding")
+	FORCEINLINE float GetRollingSpeed() const { return RollingSpeed; }
+
 protected:
-	// Called when the game starts
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+private:
+	UFUNCTION()
+	void HandleComponentWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	UFUNCTION()
+	void HandleComponentSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	/** Only used if the subsystem doesn't forward collisions. */
+	UFUNCTION()
+	void HandleComponentHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
-		
+	/** Removes the component from the sliding sources and resets the contact state. */
+	void StopSliding();
 };
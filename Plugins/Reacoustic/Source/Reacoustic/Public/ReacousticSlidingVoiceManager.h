@@ -0,0 +1,77 @@
+// Copyright (c) 2022-present Nino Saglia. All Rights Reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReacousticSubsystemComponent.h"
+#include "ReacousticSlidingVoiceManager.generated.h"
+
+class UAudioComponent;
+class UReacousticSlidingAudioComponent;
+
+/** A looping voice in the sliding voice pool. */
+USTRUCT()
+struct FReacousticSlidingVoice
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	UAudioComponent* AudioComponent {nullptr};
+
+	/** The source the voice is assigned to. Invalid if the voice is free or fading out. */
+	TWeakObjectPtr<UReacousticSlidingAudioComponent> Source;
+};
+
+/** The sliding state of a sliding audio component, as reported by the component every tick. */
+struct FReacousticSlidingSource
+{
+	TWeakObjectPtr<UReacousticSlidingAudioComponent> Component;
+	FVector Location {FVector::ZeroVector};
+
+	/** The loudness of the loop, between 0 and 1. */
+	float Gain {0.0f};
+
+	/** Used to sort the sources. Higher is more audible. */
+	float Priority {0.0f};
+};
+
+/** Owns a small pool of looping voices, and assigns them to the most audible sliding and rolling objects.
+ *	Voices fade in when they are assigned to a source and fade out when the source loses its voice. */
+UCLASS()
+class UReacousticSlidingVoiceManager : public UReacousticSubsystemComponent
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogReacousticSlidingVoiceManager, Log, All)
+
+private:
+	UPROPERTY(Transient)
+	TArray<FReacousticSlidingVoice> Voices;
+
+	/** The sources that are currently in contact with something and want a voice. */
+	TArray<FReacousticSlidingSource> Sources;
+
+public:
+	virtual void Initialize(UReacousticSubsystem* Subsystem) override;
+	virtual void Deinitialize(UReacousticSubsystem* Subsystem) override;
+
+	/** Updates the sliding state of a component. A gain of zero releases the voice of the component. */
+	void UpdateSource(UReacousticSlidingAudioComponent* Component, const FVector& Location, const float Gain);
+
+	/** Removes a component from the sources and fades out its voice. */
+	void RemoveSource(const UReacousticSlidingAudioComponent* Component);
+
+	/** Ranks the sources by audibility and assigns the voices to the most audible ones. */
+	void Update();
+
+	/** Returns whether the manager needs to be updated this frame. */
+	FORCEINLINE bool HasSources() const { return !Sources.IsEmpty(); }
+
+private:
+	/** Returns the index of the voice assigned to a component, or INDEX_NONE. */
+	int32 FindVoice(const UReacousticSlidingAudioComponent* Component) const;
+
+	/** Fades out a voice and frees it. */
+	void ReleaseVoice(FReacousticSlidingVoice& Voice);
+};
@@ -9,20 +9,59 @@
 #include "Subsystems/WorldSubsystem.h"
 #include "ReacousticSubsystem.generated.h"
 
+class UReacousticComponent;
+class AReacousticBindingTable;
+class ULevel;
+
+namespace Chaos
+{
+	struct FCollisionEventData;
+}
+
+/** A physics body that the Reacoustic subsystem listens to collision events for. */
+struct FReacousticBody
+{
+	TWeakObjectPtr<UReacousticComponent> Component;
+	TWeakObjectPtr<UPrimitiveComponent> MeshComponent;
+
+	/** The key of the mesh component in BodyIndices, which is still valid after the component is destroyed. */
+	TObjectKey<UPrimitiveComponent> MeshComponentKey;
+
+	/** Index into the audio data of the sound data asset, used to look up the cull distance of the body. */
+	int32 SoundDataIndex {INDEX_NONE};
+};
+
+/** A hit event that is waiting to be processed by the Reacoustic subsystem at the end of the frame. */
+struct FReacousticQueuedImpact
+{
+	TWeakObjectPtr<UReacousticComponent> Component;
+	TWeakObjectPtr<UPrimitiveComponent> HitComponent;
+	TWeakObjectPtr<AActor> OtherActor;
+	TWeakObjectPtr<UPrimitiveComponent> OtherComponent;
+	FVector NormalImpulse {FVector::ZeroVector};
+	FHitResult Hit;
+
+	/** The impact value at the time of the hit. */
+	float ImpactValue {0.0f};
+
+	/** How audible the impact is at the listener. Used to sort and cap the impacts that are played each frame. */
+	float Priority {0.0f};
+};
+
 UCLASS()
-class REACOUSTIC_API  UReacousticSubsystem : public UWorldSubsystem
+class REACOUSTIC_API  UReacousticSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
 	DECLARE_LOG_CATEGORY_CLASS(LogReacousticSubsystem, Log, All)
 
 public:
-	/** The Reacoustic SoundData Data Asset. */
-	UPROPERTY(BlueprintReadWrite, Meta = (DisplayName = "Sound Data array Asset"))
+	/** The Reacoustic SoundData Data Asset. Use SetSoundDataAssets to change it, so that the lookup tables are rebuilt. */
+	UPROPERTY(BlueprintReadOnly, Meta = (DisplayName = "Sound Data array Asset"))
 	UReacousticSoundDataAsset* ReacousticSoundDataAsset {NewObject<UReacousticSoundDataAsset>()};
 
-	/** The Reacoustic Sound Data Reference Map.*/
-	UPROPERTY(BlueprintReadWrite, Meta = (DisplayName = "Sound Data Asset Reference Map"))	
+	/** The Reacoustic Sound Data Reference Map. Use SetSoundDataAssets to change it, so that the lookup tables are rebuilt. */
+	UPROPERTY(BlueprintReadOnly, Meta = (DisplayName = "Sound Data Asset Reference Map"))	
 	UReacousticSoundDataRef_Map* ReacousticSoundDataRefMap {NewObject<UReacousticSoundDataRef_Map>()};
 
 	/** The internal reference of the global reacoustic settings.*/
@@ -40,11 +79,87 @@ private:
 	/** Array of pointers to all currently active ReacousticComponents. */
 	TArray<class UReacousticComponent*> ReacousticComponents;
 
+	/** Dense array of the bodies that collision events are forwarded for. */
+	TArray<FReacousticBody> Bodies;
+
+	/** Maps the mesh component of a body to its index in Bodies.
+	 *	Bodies are keyed on their component rather than their physics proxy, since the proxy is recreated whenever the physics state of the component is. */
+	TMap<TObjectKey<UPrimitiveComponent>, int32> BodyIndices;
+
+	/** Maps the mesh component of a sliding body to the component that plays its sliding loop. */
+	TMap<TObjectKey<UPrimitiveComponent>, TWeakObjectPtr<class UReacousticSlidingAudioComponent>> SlidingBodies;
+
+	/** Whether the subsystem is registered to the collision events of the physics solver. */
+	bool IsListeningToCollisionEvents {false};
+
+	/** Impacts that were submitted this frame and are processed in the next subsystem tick. */
+	TArray<FReacousticQueuedImpact> PendingImpacts;
+
+	/** Maps the ordered pair of components of a pending impact to its index in PendingImpacts, so that hits between the same pair are merged in constant time. */
+	TMap<TPair<TObjectKey<UPrimitiveComponent>, TObjectKey<UPrimitiveComponent>>, int32> PendingImpactIndices;
+
+	/** The pool of AudioComponents that impact sounds are played on. */
+	UPROPERTY(Transient)
+	class UReacousticAudioComponentManager* AudioComponentManager {nullptr};
+
+	/** The pool of looping voices that sliding and rolling sounds are played on. */
+	UPROPERTY(Transient)
+	class UReacousticSlidingVoiceManager* SlidingVoiceManager {nullptr};
+
+	/** Lookup table from static mesh to an index in the sound data asset. Built from the reference map. */
+	TMap<const UStaticMesh*, int32> MeshSoundDataIndices;
+
+	/** Lookup table from physical surface type to an index in the sound data asset. Built from the reference map. */
+	TMap<uint8, int32> SurfaceSoundDataIndices;
+
+	/** The squared distance beyond which a sound data entry is inaudible, per entry in the sound data asset. Built from the attenuation settings. */
+	TArray<float> CullDistancesSquared;
+
+	/** The listener location, cached once per frame. */
+	FVector ListenerLocation {FVector::ZeroVector};
+	uint64 ListenerLocationFrame {MAX_uint64};
+	bool HasListenerLocation {false};
+
+	/** The levels whose Reacoustic components are added from a baked binding table. These levels are skipped when the world is populated at runtime. */
+	TSet<TObjectKey<ULevel>> BakedLevels;
+
+#if WITH_EDITOR
+	FDelegateHandle ReferenceMapChangedHandle;
+	FDelegateHandle SoundDataAssetChangedHandle;
+#endif
+
 public:
 	UReacousticSubsystem();
 	virtual void PostInitProperties() override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queues a hit for processing at the end of the frame.
+	 *	Hits between the same pair of bodies are merged, and the remaining hits are sorted by audibility and capped to a per-frame budget. */
+	void SubmitImpact(UReacousticComponent* Component, UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComponent,
+		const FVector& NormalImpulse, const FHitResult& Hit, const float ImpactValue);
 	void OnActorSpawned(AActor* Actor);
 
+	/** Registers the physics body of a component, so that its collisions are forwarded from the collision event stream of the solver.
+	 *	@Return False if the subsystem can't listen to collision events, in which case the component has to bind to OnComponentHit itself. */
+	bool RegisterBody(UReacousticComponent* Component, UPrimitiveComponent* MeshComponent);
+
+	/** Unregisters the physics body of a component. */
+	void UnregisterBody(const UReacousticComponent* Component);
+
+	/** Registers the physics body of a sliding audio component, so that its contacts are forwarded from the collision event stream of the solver.
+	 *	@Return False if the subsystem can't listen to collision events, in which case the component has to bind to OnComponentHit itself. */
+	bool RegisterSlidingBody(class UReacousticSlidingAudioComponent* Component, UPrimitiveComponent* MeshComponent);
+
+	/** Unregisters the physics body of a sliding audio component. */
+	void UnregisterSlidingBody(const UReacousticSlidingAudioComponent* Component);
+
 	
 	/** Registers an component to the Reacoustic subsystem. This function is called by a component OnConstruct
 	 *	@Component The component to register.
@@ -64,8 +179,35 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ReacousticSubsystem")
 	void AddBPReacousticComponentToActor(AActor* Actor, TSubclassOf<UReacousticComponent> ComponentClass, FReacousticSoundData MeshSoundData);
 
+	/** Returns the pool of AudioComponents that impact sounds are played on. Only valid after the world has begun play. */
+	FORCEINLINE UReacousticAudioComponentManager* GetAudioComponentManager() const { return AudioComponentManager; }
+
+	/** Returns the pool of voices that sliding loops are played on. Only valid after the world has begun play. */
+	FORCEINLINE UReacousticSlidingVoiceManager* GetSlidingVoiceManager() const { return SlidingVoiceManager; }
+
+	/** Sets the sound data asset and reference map to use, and rebuilds the lookup tables. */
+	UFUNCTION(BlueprintCallable, Category = "ReacousticSubsystem")
+	void SetSoundDataAssets(UReacousticSoundDataAsset* SoundDataAsset, UReacousticSoundDataRef_Map* ReferenceMap);
+
 	/** Gets the sound data associated with a specific mesh.*/
 	FReacousticSoundData GetMeshSoundData(const UStaticMeshComponent* StaticMeshComponent) const;
+
+	/** Gets the sound data associated with a physical surface type.
+	 *	@Return True if sound data is registered for the surface type. */
+	bool GetSurfaceSoundData(const EPhysicalSurface SurfaceType, FReacousticSoundData& OutSoundData) const;
+
+	/** Returns the index in the sound data asset for a mesh, or INDEX_NONE if the mesh has no sound data. */
+	int32 GetMeshSoundDataIndex(const UStaticMesh* Mesh) const;
+
+	/** Returns the index in the sound data asset for a physical surface type, or INDEX_NONE if the surface has no sound data. */
+	int32 GetSurfaceSoundDataIndex(const EPhysicalSurface SurfaceType) const;
+
+	/** Returns whether an impact at a location can be heard by the listener, based on the attenuation of the sound data.
+	 *	Impacts without sound data or attenuation are always considered audible. This is cheap enough to run for every hit. */
+	bool IsImpactInRange(const int32 SoundDataIndex, const FVector& Location);
+
+	/** Returns the sound data at an index in the sound data asset, or nullptr if the index is invalid. */
+	const FReacousticSoundData* GetSoundDataAtIndex(const int32 Index) const;
 	
 	/** Checks whether an actor meets the conditions to be used by Reacoustic.
 	 *	For this, an actor must have IsSimulatingPhysics and a StaticMeshComponent with bNotifyRigidBodyCollision set to true.
@@ -75,7 +217,34 @@ public:
 	UFUNCTION(BlueprintPure, Meta = (DisplayName = "Is Reacoustic Compatible"))
 	bool IsReacousticCompatible(AActor* Actor);
 
+	/** Returns the static mesh component of an actor that Reacoustic would bind to, or nullptr if the actor is not compatible.
+	 *	Uses the authored physics settings, so that it can be used on actors in the editor as well. */
+	static UStaticMeshComponent* FindCompatibleMeshComponent(const AActor* Actor);
+
+	/** Adds Reacoustic components to the actors in a baked binding table in a single pass. Called when the table begins play,
+	 *	so that the tables of streamed levels are instantiated when their level is added to the world. */
+	void InstantiateBindings(const AReacousticBindingTable* BindingTable);
+
+	/** Stops treating the level of a binding table as baked. Called when the table ends play. */
+	void RemoveBindings(const AReacousticBindingTable* BindingTable);
+
 private:
+	/** Filters the collisions of the physics solver and submits the impacts of registered bodies. */
+	void HandleCollisionEvents(const Chaos::FCollisionEventData& CollisionEventData);
+
+	/** Merges, filters, sorts and plays the impacts that were submitted this frame. */
+	void ProcessPendingImpacts();
+
+	/** Rebuilds the mesh and surface lookup tables and the cull distances from the sound data asset and reference map. */
+	void RebuildLookupTables();
+
+#if WITH_EDITOR
+	void HandleReferenceMapChanged(UReacousticSoundDataRef_Map* ReferenceMap);
+	void HandleSoundDataAssetChanged(UReacousticSoundDataAsset* SoundDataAsset);
+#endif
+
+	/** Adds Reacoustic components to every compatible actor in the world. This scans the world, so it is only used
+	 *	for levels without a baked binding table. */
 	UFUNCTION(BlueprintCallable)
 	void PopulateWorldWithBPReacousticComponents(TSubclassOf<UReacousticComponent> ComponentClass);
 };
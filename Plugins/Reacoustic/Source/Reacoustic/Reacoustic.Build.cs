@@ -43,7 +43,10 @@ public class Reacoustic : ModuleRules
 				"SlateCore",
 				"InputCore", 
 				"PhysicsCore",
+				"Chaos",
 				"AudioSynesthesia",
+				"SignalProcessing",
+				"AssetRegistry",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
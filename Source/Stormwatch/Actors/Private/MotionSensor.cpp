@@ -17,82 +17,9 @@ void AMotionSensor::PostInitProperties()
 	DetectionArea->SetCollisionResponseToChannel(ECollisionChannel::ECC_PhysicsBody, ECollisionResponse::ECR_Overlap);
 }
 
-void AMotionSensor::Poll()
+bool AMotionSensor::IsActorDetectable(const AActor* Actor) const
 {
-	IsActorDetected = false;
-
-	if (IsBroken) { return; }
-	
-	if (!OverlappingActors.IsEmpty())
-	{
-		for (const AActor* Actor : OverlappingActors)
-		{
-			if (!IsActorOccluded(Actor) && IsActorMoving(Actor))
-			{
-				IsActorDetected = true;
-				break;
-			}
-		}
-	}
-	
-	if (IsActorDetected)
-	{
-		
-		if (IsTriggered)
-		{
-			return;
-		}
-
-		SetState(ESensorState::Detecting);
-
-		if (const UWorld* World {GetWorld()})
-		{
-			if (World->GetTimerManager().IsTimerActive(CooldownTimerHandle))
-			{
-				World->GetTimerManager().ClearTimer(CooldownTimerHandle);
-			}
-		}
-		
-		DetectionLevel += PollInterval;
-		if (!IsAlerted)
-		{
-			IsAlerted = true;
-		}
-		
-		if (DetectionLevel >= DetectionThreshold)
-		{
-			IsTriggered = true;
-			
-			if (IsManualResetRequired)
-			{
-				if (const UWorld* World {GetWorld()})
-				{
-					if (World->GetTimerManager().IsTimerActive(PollTimerHandle))
-					{
-						World->GetTimerManager().ClearTimer(PollTimerHandle);
-					}
-				}
-			}
-
-			SetState(ESensorState::Triggered);
-		}
-	}
-	else
-	{
-		if (IsAlerted)
-		{
-			SetState(ESensorState::Alerted);
-			
-			if (const UWorld* World {GetWorld()})
-			{
-				if (World->GetTimerManager().IsTimerActive(CooldownTimerHandle))
-				{
-					return;
-				}
-				StartCooldown();
-			}
-		}
-	}
+	return IsActorMoving(Actor);
 }
 
 bool AMotionSensor::IsActorMoving(const AActor* Actor) const
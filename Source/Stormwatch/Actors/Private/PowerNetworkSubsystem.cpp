@@ -0,0 +1,265 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "PowerNetworkSubsystem.h"
+#include "PowerConsumerInterface.h"
+#include "PowerSource.h"
+
+DEFINE_LOG_CATEGORY_CLASS(UPowerNetworkSubsystem, LogPowerNetwork);
+
+void UPowerNetworkSubsystem::Deinitialize()
+{
+	Nodes.Empty();
+	ConsumerSources.Empty();
+	TopologicalOrder.Empty();
+	PendingNotifications.Empty();
+	PendingConsumers.Empty();
+	NextNotificationIndex = 0;
+
+	Super::Deinitialize();
+}
+
+void UPowerNetworkSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (IsTopologyDirty)
+	{
+		RebuildTopologicalOrder();
+	}
+
+	if (IsPowerDirty)
+	{
+		PropagatePower();
+	}
+
+	DispatchNotifications();
+}
+
+TStatId UPowerNetworkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPowerNetworkSubsystem, STATGROUP_Tickables);
+}
+
+void UPowerNetworkSubsystem::RegisterSource(APowerSource* Source)
+{
+	if (!Source) { return; }
+
+	Nodes.FindOrAdd(Source).Source = Source;
+	IsTopologyDirty = true;
+	IsPowerDirty = true;
+}
+
+void UPowerNetworkSubsystem::UnregisterSource(APowerSource* Source)
+{
+	/** Keep the node and its consumers, so that they are connected again if the power source is streamed back in. */
+	FPowerNetworkNode* Node {Nodes.Find(Source)};
+	if (!Node) { return; }
+
+	Node->Source.Reset();
+	IsTopologyDirty = true;
+	IsPowerDirty = true;
+}
+
+void UPowerNetworkSubsystem::RegisterConsumer(APowerSource* Source, UObject* Consumer)
+{
+	if (!Source || !Consumer) { return; }
+
+	const TObjectKey<APowerSource>* CurrentSource {ConsumerSources.Find(Consumer)};
+	if (CurrentSource && *CurrentSource == TObjectKey<APowerSource>(Source))
+	{
+		UE_LOG(LogPowerNetwork, Verbose, TEXT("Consumer '%s' is already connected to '%s'."), *Consumer->GetName(), *Source->GetName());
+		return;
+	}
+
+	if (CurrentSource)
+	{
+		UnregisterConsumer(Consumer);
+	}
+
+	FPowerNetworkNode& Node {Nodes.FindOrAdd(Source)};
+	Node.Consumers.Add(Consumer);
+	ConsumerSources.Add(Consumer, Source);
+
+	QueueNotification(Consumer);
+}
+
+void UPowerNetworkSubsystem::UnregisterConsumer(UObject* Consumer)
+{
+	TObjectKey<APowerSource> Source;
+	if (!ConsumerSources.RemoveAndCopyValue(Consumer, Source)) { return; }
+
+	if (FPowerNetworkNode* Node {Nodes.Find(Source)})
+	{
+		Node->Consumers.RemoveSwap(Consumer);
+	}
+}
+
+void UPowerNetworkSubsystem::MarkSourceDirty(const APowerSource* Source)
+{
+	if (Nodes.Contains(Source))
+	{
+		IsPowerDirty = true;
+	}
+}
+
+bool UPowerNetworkSubsystem::IsSourcePowered(const APowerSource* Source) const
+{
+	const FPowerNetworkNode* Node {Nodes.Find(Source)};
+	return Node && Node->IsPowered;
+}
+
+TArray<UObject*> UPowerNetworkSubsystem::GetConsumers(const APowerSource* Source) const
+{
+	TArray<UObject*> Consumers;
+	if (const FPowerNetworkNode* Node {Nodes.Find(Source)})
+	{
+		for (const TWeakObjectPtr<UObject>& Consumer : Node->Consumers)
+		{
+			if (UObject* Object {Consumer.Get()})
+			{
+				Consumers.Add(Object);
+			}
+		}
+	}
+	return Consumers;
+}
+
+void UPowerNetworkSubsystem::RebuildTopologicalOrder()
+{
+	IsTopologyDirty = false;
+
+	/** Nodes of power sources that are gone and no longer feed any consumers can be dropped. */
+	for (auto It {Nodes.CreateIterator()}; It; ++It)
+	{
+		It->Value.Consumers.RemoveAllSwap([](const TWeakObjectPtr<UObject>& Consumer) { return !Consumer.IsValid(); });
+		if (!It->Value.Source.IsValid() && It->Value.Consumers.IsEmpty())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TMap<TObjectKey<APowerSource>, TArray<TObjectKey<APowerSource>>> Downstream;
+	TopologicalOrder.Reset(Nodes.Num());
+
+	for (TPair<TObjectKey<APowerSource>, FPowerNetworkNode>& Pair : Nodes)
+	{
+		FPowerNetworkNode& Node {Pair.Value};
+		const APowerSource* Source {Node.Source.Get()};
+		const APowerSource* Upstream {Source ? Source->GetUpstreamSource().Get() : nullptr};
+
+		Node.IsRelay = Source && !Source->GetUpstreamSource().IsNull();
+		Node.Upstream = Upstream && Nodes.Contains(Upstream) ? TObjectKey<APowerSource>(Upstream) : TObjectKey<APowerSource>();
+
+		/** Generators, and relays whose upstream power source is missing, are the roots of the network. */
+		if (Node.Upstream == TObjectKey<APowerSource>())
+		{
+			TopologicalOrder.Add(Pair.Key);
+		}
+		else
+		{
+			Downstream.FindOrAdd(Node.Upstream).Add(Pair.Key);
+		}
+	}
+
+	for (int32 Index {0}; Index < TopologicalOrder.Num(); ++Index)
+	{
+		if (const TArray<TObjectKey<APowerSource>>* Children {Downstream.Find(TopologicalOrder[Index])})
+		{
+			TopologicalOrder.Append(*Children);
+		}
+	}
+
+	/** Relays that feed each other in a loop are never reached from a root, and are cut off from their upstream power source. */
+	if (TopologicalOrder.Num() < Nodes.Num())
+	{
+		const TSet<TObjectKey<APowerSource>> OrderedNodes {TopologicalOrder};
+		for (TPair<TObjectKey<APowerSource>, FPowerNetworkNode>& Pair : Nodes)
+		{
+			if (OrderedNodes.Contains(Pair.Key)) { continue; }
+
+			UE_LOG(LogPowerNetwork, Warning, TEXT("Power source '%s' is part of a loop of relays and will not be powered."),
+				*GetNameSafe(Pair.Value.Source.Get()));
+			Pair.Value.Upstream = TObjectKey<APowerSource>();
+			TopologicalOrder.Add(Pair.Key);
+		}
+	}
+}
+
+void UPowerNetworkSubsystem::PropagatePower()
+{
+	IsPowerDirty = false;
+
+	int32 ChangedSourceCount {0};
+	const int32 PendingNotificationCount {PendingNotifications.Num() - NextNotificationIndex};
+
+	/** Every upstream power source comes earlier in the order, so its powered state is already up to date. */
+	for (const TObjectKey<APowerSource>& Key : TopologicalOrder)
+	{
+		FPowerNetworkNode* Node {Nodes.Find(Key)};
+		if (!Node) { continue; }
+
+		APowerSource* Source {Node->Source.Get()};
+		const FPowerNetworkNode* UpstreamNode {Node->IsRelay ? Nodes.Find(Node->Upstream) : nullptr};
+		const bool IsPowered {Source && Source->GetIsEnergized() && (!Node->IsRelay || (UpstreamNode && UpstreamNode->IsPowered))};
+
+		if (Node->IsPowered == IsPowered) { continue; }
+
+		Node->IsPowered = IsPowered;
+		++ChangedSourceCount;
+
+		for (const TWeakObjectPtr<UObject>& Consumer : Node->Consumers)
+		{
+			QueueNotification(Consumer.Get());
+		}
+
+		if (Source)
+		{
+			Source->OnPowerStateChanged.Broadcast(IsPowered);
+		}
+	}
+
+	UE_LOG(LogPowerNetwork, Verbose, TEXT("Propagated power through %d power sources, %d changed state and %d consumers were queued."),
+		TopologicalOrder.Num(), ChangedSourceCount, PendingNotifications.Num() - NextNotificationIndex - PendingNotificationCount);
+}
+
+void UPowerNetworkSubsystem::QueueNotification(UObject* Consumer)
+{
+	/** A consumer that is already queued is notified of its power state at the time it is dispatched, so it is not queued twice. */
+	if (!Consumer || PendingConsumers.Contains(Consumer)) { return; }
+
+	PendingConsumers.Add(Consumer);
+	PendingNotifications.Add(Consumer);
+}
+
+void UPowerNetworkSubsystem::DispatchNotifications()
+{
+	const int32 PendingNotificationCount {PendingNotifications.Num() - NextNotificationIndex};
+	if (PendingNotificationCount == 0) { return; }
+
+	const int32 NotificationCount {MaxNotificationsPerFrame > 0
+		? FMath::Min(MaxNotificationsPerFrame, PendingNotificationCount) : PendingNotificationCount};
+	const int32 EndIndex {NextNotificationIndex + NotificationCount};
+
+	/** Consumers may connect other consumers while being notified, which are appended to the queue. */
+	for (; NextNotificationIndex < EndIndex; ++NextNotificationIndex)
+	{
+		UObject* Consumer {PendingNotifications[NextNotificationIndex].Get()};
+		if (!Consumer) { continue; }
+
+		PendingConsumers.Remove(Consumer);
+
+		const TObjectKey<APowerSource>* SourceKey {ConsumerSources.Find(Consumer)};
+		const FPowerNetworkNode* Node {SourceKey ? Nodes.Find(*SourceKey) : nullptr};
+		if (!Node) { continue; }
+
+		IPowerConsumer::Execute_SetPowerState(Consumer, Node->IsPowered, Node->Source.Get());
+	}
+
+	if (NextNotificationIndex == PendingNotifications.Num())
+	{
+		PendingNotifications.Reset();
+		PendingConsumers.Reset();
+		NextNotificationIndex = 0;
+	}
+}
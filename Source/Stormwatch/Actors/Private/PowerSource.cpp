@@ -4,6 +4,7 @@
 #include "PowerSource.h"
 
 #include "PowerConsumerInterface.h"
+#include "PowerNetworkSubsystem.h"
 
 DEFINE_LOG_CATEGORY_CLASS(APowerSource, LogPowerSource)
 
@@ -16,6 +17,21 @@ APowerSource::APowerSource()
 void APowerSource::BeginPlay()
 {
 	Super::BeginPlay();
+
+	if (UPowerNetworkSubsystem* Subsystem {GetWorld()->GetSubsystem<UPowerNetworkSubsystem>()})
+	{
+		Subsystem->RegisterSource(this);
+	}
+}
+
+void APowerSource::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPowerNetworkSubsystem* Subsystem {GetWorld()->GetSubsystem<UPowerNetworkSubsystem>()})
+	{
+		Subsystem->UnregisterSource(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void APowerSource::RegisterPowerConsumer(UObject* Consumer)
@@ -32,15 +48,18 @@ void APowerSource::RegisterPowerConsumer(UObject* Consumer)
 		return;
 	}
 
-	if (ConnectedConsumers.Contains(Consumer))
+	if (UPowerNetworkSubsystem* Subsystem {GetWorld()->GetSubsystem<UPowerNetworkSubsystem>()})
 	{
-		UE_LOG(LogPowerSource, Verbose, TEXT("RegisterPowerConsumer: Consumer already exists in the array"));
-		return;
+		Subsystem->RegisterConsumer(this, Consumer);
 	}
-	
-	ConnectedConsumers.Add(Consumer);
+}
 
-	IPowerConsumer::Execute_SetPowerState(Consumer, IsEnergized, this);
+void APowerSource::UnregisterPowerConsumer(UObject* Consumer)
+{
+	if (UPowerNetworkSubsystem* Subsystem {GetWorld()->GetSubsystem<UPowerNetworkSubsystem>()})
+	{
+		Subsystem->UnregisterConsumer(Consumer);
+	}
 }
 
 bool APowerSource::Trigger_Implementation(const AActor* Initiator)
@@ -70,24 +89,26 @@ void APowerSource::SetPowerSourceState(const bool State)
 	if (State != IsEnergized)
 	{
 		IsEnergized = State;
-		
-		int32 SetPowerStateCount = 0;
-		
-		if (!ConnectedConsumers.IsEmpty())
+
+		if (UPowerNetworkSubsystem* Subsystem {GetWorld()->GetSubsystem<UPowerNetworkSubsystem>()})
 		{
-			for (UObject* Consumer : ConnectedConsumers)
-			{
-				if (Consumer)
-				{
-					IPowerConsumer::Execute_SetPowerState(Consumer, IsEnergized, this);
-					SetPowerStateCount++;
-				}
-			}
+			Subsystem->MarkSourceDirty(this);
 		}
-		UE_LOG(LogPowerSource, Verbose, TEXT("SetPowerSourceState: Power state has been set for %d objects"), SetPowerStateCount);
 	}
 }
 
+TArray<UObject*> APowerSource::GetConnectedConsumers() const
+{
+	const UPowerNetworkSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<UPowerNetworkSubsystem>() : nullptr};
+	return Subsystem ? Subsystem->GetConsumers(this) : TArray<UObject*>();
+}
+
+bool APowerSource::GetIsPowered() const
+{
+	const UPowerNetworkSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<UPowerNetworkSubsystem>() : nullptr};
+	return Subsystem && Subsystem->IsSourcePowered(this);
+}
+
 
 
 
@@ -5,6 +5,8 @@
 
 #include "Nightstalker.h"
 #include "PlayerCharacter.h"
+#include "RoomRelevanceSubsystem.h"
+#include "SensorSubsystem.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "GameFramework/Pawn.h"
@@ -36,6 +38,23 @@ void AProximitySensor::BeginPlay()
 		DetectionArea->OnComponentBeginOverlap.AddDynamic(this, &AProximitySensor::OnOverlapBegin);
 		DetectionArea->OnComponentEndOverlap.AddDynamic(this, &AProximitySensor::OnOverlapEnd);
 	}
+
+	if (URoomRelevanceSubsystem* Subsystem {GetWorld()->GetSubsystem<URoomRelevanceSubsystem>()})
+	{
+		Subsystem->RegisterActor(this);
+	}
+}
+
+void AProximitySensor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopPolling();
+
+	if (URoomRelevanceSubsystem* Subsystem {GetWorld()->GetSubsystem<URoomRelevanceSubsystem>()})
+	{
+		Subsystem->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AProximitySensor::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
@@ -51,24 +70,18 @@ void AProximitySensor::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent,
 	}
 	OverlappingActors.AddUnique(OtherActor);
 
-	Poll();
-	GetWorldTimerManager().SetTimer(PollTimerHandle, this, &AProximitySensor::Poll, PollInterval, true);
+	StartPolling();
 }
 
 void AProximitySensor::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
 	OverlappingActors.Remove(OtherActor);
+	OcclusionCache.Remove(OtherActor);
 
 	if (OverlappingActors.IsEmpty())
 	{
-		if (const UWorld* World {GetWorld()})
-		{
-			if (World->GetTimerManager().IsTimerActive(PollTimerHandle))
-			{
-				World->GetTimerManager().ClearTimer(PollTimerHandle);
-			}
-		}
+		StopPolling();
 	}
 
 	if (IsAlerted && !IsTriggered)
@@ -78,25 +91,37 @@ void AProximitySensor::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AA
 	}
 }
 
-/** Called at regular intervals to check for overlapping actors and determine the nearest pawn. */
+/** Checks for overlapping actors immediately, outside of the regular polling of the sensor subsystem. */
 void AProximitySensor::Poll()
 {
-	IsActorDetected = false;
-
-	if (IsBroken) { return; }
-	
-	if (!OverlappingActors.IsEmpty())
+	bool IsDetected {false};
+	for (const AActor* Actor : OverlappingActors)
 	{
-		for (const AActor* Actor : OverlappingActors)
+		if (!Actor || !IsActorDetectable(Actor)) { continue; }
+
+		bool IsOccluded;
+		if (!GetCachedOcclusion(Actor, IsOccluded))
 		{
-			if (!IsActorOccluded(Actor))
-			{
-				IsActorDetected = true;
-				break;
-			}
+			IsOccluded = IsActorOccluded(Actor);
+			CacheOcclusion(Actor, IsOccluded);
+		}
+
+		if (!IsOccluded)
+		{
+			IsDetected = true;
+			break;
 		}
 	}
-	
+	ProcessPoll(IsDetected);
+}
+
+void AProximitySensor::ProcessPoll(const bool IsDetected)
+{
+	IsActorDetected = false;
+
+	if (IsBroken) { return; }
+
+	IsActorDetected = IsDetected;
 	if (IsActorDetected)
 	{
 		if (IsTriggered)
@@ -126,13 +151,7 @@ void AProximitySensor::Poll()
 			
 			if (IsManualResetRequired)
 			{
-				if (const UWorld* World {GetWorld()})
-				{
-					if (World->GetTimerManager().IsTimerActive(PollTimerHandle))
-					{
-						World->GetTimerManager().ClearTimer(PollTimerHandle);
-					}
-				}
+				StopPolling();
 			}
 
 			SetState(ESensorState::Triggered);
@@ -159,17 +178,11 @@ void AProximitySensor::Poll()
 /** Determines if the given actor is occluded by another object using a line trace. */
 bool AProximitySensor::IsActorOccluded(const AActor* Actor) const
 {
-	FVector StartLocation = GetActorLocation() - FVector(0, 0, 10);
-	FVector ActorLocation {Actor->GetActorLocation()};
-	TArray<FVector> EndLocations
-	{
-		ActorLocation,
-		ActorLocation + FVector(0.f, 0.f, 50.f),
-		ActorLocation - FVector(0.f, 0.f, 50.f)
-	};
+	FVector StartLocation;
+	FVector EndLocations[OcclusionTraceCount];
+	GetOcclusionTraceLocations(Actor, StartLocation, EndLocations);
 
-	FCollisionQueryParams CollisionParams;
-	CollisionParams.AddIgnoredActor(this);
+	FCollisionQueryParams CollisionParams {SCENE_QUERY_STAT(SensorOcclusion), false, this};
 	CollisionParams.AddIgnoredActor(Actor);
 
 	uint8 BlockedTraces {0};
@@ -178,18 +191,64 @@ bool AProximitySensor::IsActorOccluded(const AActor* Actor) const
 	{
 		FHitResult HitResult;
 
-		if (bool IsHit {GetWorld()->LineTraceSingleByChannel(HitResult, StartLocation, EndLocation, ECC_Visibility, CollisionParams)})
+		if (GetWorld()->LineTraceSingleByChannel(HitResult, StartLocation, EndLocation, ECC_Visibility, CollisionParams))
 		{
-			AActor* HitActor {HitResult.GetActor()};
-
-			if (HitActor != Actor)
-			{
-				++BlockedTraces;
-			}
+			++BlockedTraces;
 		}
 	}
 
-	return BlockedTraces == EndLocations.Num();
+	return BlockedTraces == OcclusionTraceCount;
+}
+
+void AProximitySensor::GetOcclusionTraceLocations(const AActor* Actor, FVector& OutStart, FVector (&OutEnds)[OcclusionTraceCount]) const
+{
+	OutStart = GetActorLocation() - FVector(0.0, 0.0, 10.0);
+
+	const FVector ActorLocation {Actor->GetActorLocation()};
+	OutEnds[0] = ActorLocation;
+	OutEnds[1] = ActorLocation + FVector(0.0, 0.0, 50.0);
+	OutEnds[2] = ActorLocation - FVector(0.0, 0.0, 50.0);
+}
+
+bool AProximitySensor::GetCachedOcclusion(const AActor* Actor, bool& OutIsOccluded) const
+{
+	const FSensorOcclusionCacheEntry* Entry {OcclusionCache.Find(Actor)};
+	if (!Entry || GetWorld()->GetTimeSeconds() - Entry->Time > OcclusionCacheMaxAge) { return false; }
+
+	const double DistanceSquared {FMath::Square(OcclusionCacheDistance)};
+	if (FVector::DistSquared(Entry->SensorLocation, GetActorLocation()) > DistanceSquared
+		|| FVector::DistSquared(Entry->TargetLocation, Actor->GetActorLocation()) > DistanceSquared)
+	{
+		return false;
+	}
+
+	OutIsOccluded = Entry->IsOccluded;
+	return true;
+}
+
+void AProximitySensor::CacheOcclusion(const AActor* Actor, const bool IsOccluded)
+{
+	FSensorOcclusionCacheEntry& Entry {OcclusionCache.FindOrAdd(Actor)};
+	Entry.SensorLocation = GetActorLocation();
+	Entry.TargetLocation = Actor->GetActorLocation();
+	Entry.Time = GetWorld()->GetTimeSeconds();
+	Entry.IsOccluded = IsOccluded;
+}
+
+void AProximitySensor::StartPolling()
+{
+	if (USensorSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<USensorSubsystem>() : nullptr})
+	{
+		Subsystem->StartPolling(this);
+	}
+}
+
+void AProximitySensor::StopPolling()
+{
+	if (USensorSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<USensorSubsystem>() : nullptr})
+	{
+		Subsystem->StopPolling(this);
+	}
 }
 
 void AProximitySensor::StartCooldown()
@@ -232,6 +291,26 @@ void AProximitySensor::SetState(const ESensorState NewState)
 	}
 }
 
+void AProximitySensor::OnRoomSuspended_Implementation()
+{
+	GetWorldTimerManager().PauseTimer(CooldownTimerHandle);
+
+	if (USensorSubsystem* Subsystem {GetWorld()->GetSubsystem<USensorSubsystem>()})
+	{
+		Subsystem->SetPollingPaused(this, true);
+	}
+}
+
+void AProximitySensor::OnRoomResumed_Implementation()
+{
+	GetWorldTimerManager().UnPauseTimer(CooldownTimerHandle);
+
+	if (USensorSubsystem* Subsystem {GetWorld()->GetSubsystem<USensorSubsystem>()})
+	{
+		Subsystem->SetPollingPaused(this, false);
+	}
+}
+
 void AProximitySensor::HandleCooldownFinished()
 {
 	DetectionLevel = 0.0f;
@@ -263,7 +342,7 @@ void AProximitySensor::ResetSensor()
 	}
 	else { return;}
 
-	GetWorldTimerManager().SetTimer(PollTimerHandle, this, &AProximitySensor::Poll, PollInterval, true);
+	StartPolling();
 	
 	SetState(ESensorState::Idle);
 }
@@ -303,13 +382,7 @@ void AProximitySensor::DeactivateSensor()
 			DetectionArea->OnComponentEndOverlap.RemoveDynamic(this, &AProximitySensor::OnOverlapEnd);
 		}
 
-		if (const UWorld* World {GetWorld()})
-		{
-			if (World->GetTimerManager().IsTimerActive(PollTimerHandle))
-			{
-				World->GetTimerManager().ClearTimer(PollTimerHandle);
-			}
-		}
+		StopPolling();
 		
 		IsAlerted = false;
 		IsTriggered = false;
@@ -335,13 +408,7 @@ void AProximitySensor::BreakSensor()
 			DetectionArea->OnComponentEndOverlap.RemoveDynamic(this, &AProximitySensor::OnOverlapEnd);
 		}
 
-		if (const UWorld* World {GetWorld()})
-		{
-			if (World->GetTimerManager().IsTimerActive(PollTimerHandle))
-			{
-				World->GetTimerManager().ClearTimer(PollTimerHandle);
-			}
-		}
+		StopPolling();
 		
 		IsAlerted = false;
 		IsTriggered = false;
@@ -0,0 +1,212 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "SensorSubsystem.h"
+#include "ProximitySensor.h"
+#include "RoomRelevanceSubsystem.h"
+
+DEFINE_LOG_CATEGORY_CLASS(USensorSubsystem, LogSensorSubsystem);
+
+/** Trace user data holds the poll id in the highest 8 bits, the entry index in the next 12 bits and the target index in the lowest 12 bits. */
+static constexpr uint32 SensorTraceIndexBits {12};
+static constexpr uint32 SensorTraceIndexMask {(1 << SensorTraceIndexBits) - 1};
+
+USensorSubsystem::USensorSubsystem()
+{
+	TraceDelegate.BindUObject(this, &USensorSubsystem::HandleTraceCompleted);
+}
+
+void USensorSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	PendingTraces = 0;
+
+	Super::Deinitialize();
+}
+
+void USensorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World {GetWorld()};
+	if (!World || Entries.IsEmpty()) { return; }
+
+	/** Entries of sensors that stopped polling can only be removed once no trace refers to them by index anymore. */
+	if (PendingTraces == 0)
+	{
+		Entries.RemoveAll([](const FSensorPollEntry& Entry) { return !Entry.Sensor.IsValid(); });
+	}
+
+	const double Time {World->GetTimeSeconds()};
+	for (int32 Index {0}; Index < Entries.Num(); ++Index)
+	{
+		FSensorPollEntry& Entry {Entries[Index]};
+		if (!Entry.Sensor.IsValid() || Entry.IsPaused || Entry.PendingTraces > 0 || Time < Entry.NextPollTime) { continue; }
+
+		Entry.NextPollTime = Time + Entry.Sensor->GetPollInterval();
+		BeginPoll(Entry, Index, World);
+	}
+}
+
+TStatId USensorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USensorSubsystem, STATGROUP_Tickables);
+}
+
+void USensorSubsystem::StartPolling(AProximitySensor* Sensor)
+{
+	if (!Sensor || IsPolling(Sensor)) { return; }
+
+	if (Entries.Num() > SensorTraceIndexMask)
+	{
+		UE_LOG(LogSensorSubsystem, Error, TEXT("Too many sensors are polling to also poll '%s'."), *Sensor->GetName());
+		return;
+	}
+
+	FSensorPollEntry& Entry {Entries.AddDefaulted_GetRef()};
+	Entry.Sensor = Sensor;
+
+	/** A sensor can start polling from an overlap while its room is suspended, in which case it waits for its room to be resumed.
+	 *	The paused entry stores the time until its first poll, like SetPollingPaused does. */
+	const URoomRelevanceSubsystem* RoomRelevanceSubsystem {GetWorld()->GetSubsystem<URoomRelevanceSubsystem>()};
+	if (RoomRelevanceSubsystem && RoomRelevanceSubsystem->IsActorSuspended(Sensor))
+	{
+		Entry.IsPaused = true;
+		Entry.NextPollTime = 0.0;
+	}
+}
+
+void USensorSubsystem::StopPolling(AProximitySensor* Sensor)
+{
+	for (FSensorPollEntry& Entry : Entries)
+	{
+		if (Entry.Sensor != Sensor) { continue; }
+
+		/** Keep the entry and its pending trace count until the traces in flight have returned. */
+		Entry.Sensor.Reset();
+		Entry.Targets.Reset();
+		++Entry.PollId;
+	}
+}
+
+void USensorSubsystem::SetPollingPaused(AProximitySensor* Sensor, const bool IsPaused)
+{
+	FSensorPollEntry* Entry {Entries.FindByPredicate([Sensor](const FSensorPollEntry& Entry) { return Entry.Sensor == Sensor; })};
+	if (!Entry || Entry->IsPaused == IsPaused) { return; }
+
+	/** Store the remaining time until the next poll while paused, so the sensor continues its cadence when resumed. */
+	const double Time {GetWorld()->GetTimeSeconds()};
+	Entry->NextPollTime = IsPaused ? Entry->NextPollTime - Time : Time + Entry->NextPollTime;
+	Entry->IsPaused = IsPaused;
+}
+
+bool USensorSubsystem::IsPolling(const AProximitySensor* Sensor) const
+{
+	return Entries.ContainsByPredicate([Sensor](const FSensorPollEntry& Entry) { return Entry.Sensor == Sensor; });
+}
+
+void USensorSubsystem::BeginPoll(FSensorPollEntry& Entry, const int32 EntryIndex, UWorld* World)
+{
+	AProximitySensor* Sensor {Entry.Sensor.Get()};
+
+	++Entry.PollId;
+	Entry.Targets.Reset();
+
+	FCollisionQueryParams SensorParams {SCENE_QUERY_STAT(SensorOcclusion), false, Sensor};
+
+	for (AActor* Actor : Sensor->GetOverlappingActors())
+	{
+		if (!Actor || !Sensor->IsActorDetectable(Actor)) { continue; }
+		if (Entry.Targets.Num() > static_cast<int32>(SensorTraceIndexMask)) { break; }
+
+		const int32 TargetIndex {Entry.Targets.Num()};
+		FSensorPollTarget& Target {Entry.Targets.AddDefaulted_GetRef()};
+		Target.Actor = Actor;
+
+		bool IsOccluded;
+		if (Sensor->GetCachedOcclusion(Actor, IsOccluded))
+		{
+			Target.IsCached = true;
+			Target.BlockedTraces = IsOccluded ? AProximitySensor::OcclusionTraceCount : 0;
+			continue;
+		}
+
+		FVector TraceStart;
+		FVector TraceEnds[AProximitySensor::OcclusionTraceCount];
+		Sensor->GetOcclusionTraceLocations(Actor, TraceStart, TraceEnds);
+
+		FCollisionQueryParams Params {SensorParams};
+		Params.AddIgnoredActor(Actor);
+
+		const uint32 UserData {static_cast<uint32>(Entry.PollId) << (2 * SensorTraceIndexBits)
+			| static_cast<uint32>(EntryIndex) << SensorTraceIndexBits | static_cast<uint32>(TargetIndex)};
+
+		for (const FVector& TraceEnd : TraceEnds)
+		{
+			World->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, ECC_Visibility,
+				Params, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, UserData);
+		}
+		Target.PendingTraces = AProximitySensor::OcclusionTraceCount;
+		Entry.PendingTraces += AProximitySensor::OcclusionTraceCount;
+		PendingTraces += AProximitySensor::OcclusionTraceCount;
+	}
+
+	/** Without any actors to trace, the poll completes right away. */
+	if (Entry.PendingTraces == 0)
+	{
+		FinishPoll(Entry);
+	}
+}
+
+void USensorSubsystem::FinishPoll(FSensorPollEntry& Entry)
+{
+	AProximitySensor* Sensor {Entry.Sensor.Get()};
+	if (!Sensor) { return; }
+
+	/** An actor is visible if at least one of its traces was not blocked. */
+	bool IsDetected {false};
+	for (const FSensorPollTarget& Target : Entry.Targets)
+	{
+		const AActor* Actor {Target.Actor.Get()};
+		if (!Actor) { continue; }
+
+		const bool IsOccluded {Target.BlockedTraces == AProximitySensor::OcclusionTraceCount};
+		if (!Target.IsCached)
+		{
+			Sensor->CacheOcclusion(Actor, IsOccluded);
+		}
+		IsDetected |= !IsOccluded;
+	}
+	Entry.Targets.Reset();
+
+	Sensor->ProcessPoll(IsDetected);
+}
+
+void USensorSubsystem::HandleTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	--PendingTraces;
+
+	const int32 EntryIndex {static_cast<int32>((TraceDatum.UserData >> SensorTraceIndexBits) & SensorTraceIndexMask)};
+	if (!Entries.IsValidIndex(EntryIndex)) { return; }
+
+	FSensorPollEntry& Entry {Entries[EntryIndex]};
+	--Entry.PendingTraces;
+
+	const uint8 PollId {static_cast<uint8>(TraceDatum.UserData >> (2 * SensorTraceIndexBits))};
+	const int32 TargetIndex {static_cast<int32>(TraceDatum.UserData & SensorTraceIndexMask)};
+	if (PollId != Entry.PollId || !Entry.Targets.IsValidIndex(TargetIndex)) { return; }
+
+	FSensorPollTarget& Target {Entry.Targets[TargetIndex]};
+	--Target.PendingTraces;
+
+	/** The target itself is ignored by the traces, so any hit is a blocking object. */
+	if (!TraceDatum.OutHits.IsEmpty() && TraceDatum.OutHits[0].bBlockingHit)
+	{
+		++Target.BlockedTraces;
+	}
+
+	if (Entry.PendingTraces == 0)
+	{
+		FinishPoll(Entry);
+	}
+}
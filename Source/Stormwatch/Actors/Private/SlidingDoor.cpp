@@ -3,6 +3,7 @@
 
 #include "SlidingDoor.h"
 #include "PowerConsumerComponent.h"
+#include "RoomRelevanceSubsystem.h"
 #include "Components/BoxComponent.h"
 
 ASlidingDoor::ASlidingDoor()
@@ -41,6 +42,35 @@ void ASlidingDoor::BeginPlay()
 			PowerConsumerComponent->InitializeComponent();
 		}
 	}
+
+	if (URoomRelevanceSubsystem* Subsystem {GetWorld()->GetSubsystem<URoomRelevanceSubsystem>()})
+	{
+		Subsystem->RegisterActor(this);
+	}
+}
+
+void ASlidingDoor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (URoomRelevanceSubsystem* Subsystem {GetWorld()->GetSubsystem<URoomRelevanceSubsystem>()})
+	{
+		Subsystem->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASlidingDoor::OnRoomSuspended_Implementation()
+{
+	FTimerManager& TimerManager {GetWorldTimerManager()};
+	TimerManager.PauseTimer(CooldownTimerHandle);
+	TimerManager.PauseTimer(CloseCheckTimerHandle);
+}
+
+void ASlidingDoor::OnRoomResumed_Implementation()
+{
+	FTimerManager& TimerManager {GetWorldTimerManager()};
+	TimerManager.UnPauseTimer(CooldownTimerHandle);
+	TimerManager.UnPauseTimer(CloseCheckTimerHandle);
 }
 
 void ASlidingDoor::Tick(float DeltaSeconds)
@@ -22,8 +22,8 @@ public:
 
 	virtual void PostInitProperties() override;
 
-protected:
-	virtual void Poll() override;
+	/** Only actors that move faster than the velocity threshold can be detected. */
+	virtual bool IsActorDetectable(const AActor* Actor) const override;
 
 private:
 	bool IsActorMoving(const AActor* Actor) const;
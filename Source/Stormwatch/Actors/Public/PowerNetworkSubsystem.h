@@ -0,0 +1,98 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "PowerNetworkSubsystem.generated.h"
+
+class APowerSource;
+
+/** A power source in the power network, along with the consumers it feeds. */
+struct FPowerNetworkNode
+{
+	TWeakObjectPtr<APowerSource> Source;
+
+	/** The power source that feeds this power source, if it is a relay. Null if the relay's upstream power source is missing. */
+	TObjectKey<APowerSource> Upstream;
+	bool IsRelay {false};
+
+	TArray<TWeakObjectPtr<UObject>> Consumers;
+
+	/** If true, the power source is energized and so are all power sources upstream of it. */
+	bool IsPowered {false};
+};
+
+/** Models the power sources and power consumers of the world as a graph.
+ *	Power sources without an upstream power source are generators, the others are relays that only provide power while
+ *	their upstream power source does. The energized state of every power source acts as its breaker.
+ *	State changes made within a frame are propagated once, at the end of the frame, in topological order.
+ *	Consumers are then notified of their new power state, optionally spread over multiple frames. */
+UCLASS(Config = Game, ClassGroup = "Power", Meta = (DisplayName = "Power Network Subsystem"))
+class STORMWATCH_API UPowerNetworkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogPowerNetwork, Log, All)
+
+private:
+	/** The maximum amount of consumers that are notified of a power state change per frame. If zero, all consumers are notified at once. */
+	UPROPERTY(Config)
+	int32 MaxNotificationsPerFrame {0};
+
+	TMap<TObjectKey<APowerSource>, FPowerNetworkNode> Nodes;
+
+	/** The power source every registered consumer is connected to. */
+	TMap<TObjectKey<UObject>, TObjectKey<APowerSource>> ConsumerSources;
+
+	/** The power sources ordered such that every power source comes after its upstream power source. */
+	TArray<TObjectKey<APowerSource>> TopologicalOrder;
+
+	/** The consumers that still have to be notified of their power state, and the index of the next one. */
+	TArray<TWeakObjectPtr<UObject>> PendingNotifications;
+	TSet<TObjectKey<UObject>> PendingConsumers;
+	int32 NextNotificationIndex {0};
+
+	/** If true, the topology of the network has changed and the topological order is rebuilt before the next propagation. */
+	bool IsTopologyDirty {false};
+
+	/** If true, a power source has changed its state and power is propagated at the end of the frame. */
+	bool IsPowerDirty {false};
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Adds a power source to the network. */
+	void RegisterSource(APowerSource* Source);
+	void UnregisterSource(APowerSource* Source);
+
+	/** Connects a power consumer to a power source. The consumer is notified of its power state at the end of the frame. */
+	void RegisterConsumer(APowerSource* Source, UObject* Consumer);
+	void UnregisterConsumer(UObject* Consumer);
+
+	/** Marks the state of a power source as changed, to be propagated at the end of the frame. */
+	void MarkSourceDirty(const APowerSource* Source);
+
+	/** Returns whether a power source provides power to its consumers, as of the last propagation. */
+	bool IsSourcePowered(const APowerSource* Source) const;
+
+	/** Returns the consumers that are connected to a power source. */
+	TArray<UObject*> GetConsumers(const APowerSource* Source) const;
+
+private:
+	/** Orders the power sources so that every power source comes after its upstream power source. */
+	void RebuildTopologicalOrder();
+
+	/** Updates the powered state of every power source and queues the consumers of the ones that changed. */
+	void PropagatePower();
+
+	void QueueNotification(UObject* Consumer);
+
+	/** Notifies the queued consumers of their power state, up to the maximum amount per frame. */
+	void DispatchNotifications();
+};
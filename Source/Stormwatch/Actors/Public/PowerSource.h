@@ -10,7 +10,8 @@
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPowerStateChangedDelegate, bool, NewState);
 
-/** Base class for power source actors. */
+/** Base class for power source actors.
+ *	A power source with an upstream power source acts as a relay, and only provides power while its upstream power source does. */
 UCLASS(Blueprintable, BlueprintType, ClassGroup = "Power", Meta = (DisplayName = "Power Source"))
 class APowerSource : public AActor, public ITriggerableObject
 {
@@ -28,10 +29,9 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Power Source", Meta = (DisplayName = "Is Energized"))
 	bool IsEnergized {true};
 
-private:
-	/** Array of power consumers that are registered to this power source. */
-	UPROPERTY(BlueprintGetter = GetConnectedConsumers, Category = "Power Source", Meta = (DisplayName = "Connected Objects"))
-	TArray<UObject*> ConnectedConsumers;
+	/** The power source that feeds this power source. If set, this power source only provides power while the upstream power source does. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Power Source", Meta = (DisplayName = "Upstream Power Source"))
+	TSoftObjectPtr<APowerSource> UpstreamSource;
 
 public:	
 	APowerSource();
@@ -43,15 +43,30 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Power Source", Meta = (DisplayName = "Register Power Consumer"))
 	void RegisterPowerConsumer(UObject* Consumer);
 
+	/** Unregisters a power consumer from this power source. */
+	UFUNCTION(BlueprintCallable, Category = "Power Source", Meta = (DisplayName = "Unregister Power Consumer"))
+	void UnregisterPowerConsumer(UObject* Consumer);
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	/** Energizes or de-energizes the power source. */
+	/** Energizes or de-energizes the power source. The change is propagated through the power network at the end of the frame. */
 	UFUNCTION(BlueprintCallable, Category = "Power Source", Meta = (DisplayName = "Set Power Source State"))
 	void SetPowerSourceState(const bool State);
 
 public:
 	/** Returns the power consumer objects that are connected to this power source. */
 	UFUNCTION(BlueprintPure, Category = "Power Source", Meta = (DisplayName = "Connected Objects"))
-	FORCEINLINE TArray<UObject*> GetConnectedConsumers() const { return ConnectedConsumers; }
+	TArray<UObject*> GetConnectedConsumers() const;
+
+	/** Returns whether this power source provides power, which requires it and all power sources upstream of it to be energized. */
+	UFUNCTION(BlueprintPure, Category = "Power Source", Meta = (DisplayName = "Is Powered"))
+	bool GetIsPowered() const;
+
+	/** Returns whether this power source is energized. */
+	FORCEINLINE bool GetIsEnergized() const { return IsEnergized; }
+
+	/** Returns the power source that feeds this power source. */
+	FORCEINLINE const TSoftObjectPtr<APowerSource>& GetUpstreamSource() const { return UpstreamSource; }
 };
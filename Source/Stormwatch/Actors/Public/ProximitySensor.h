@@ -5,6 +5,7 @@
 
 #include "CoreMinimal.h"
 #include "ActorFunctionCaller.h"
+#include "RoomRelevantObjectInterface.h"
 #include "ProximitySensor.generated.h"
 
 class USphereComponent;
@@ -31,11 +32,20 @@ enum class ESensorState : uint8
 	Broken						UMETA(DisplayName = "Broken"),
 };
 
+/** The result of the last occlusion check of an actor, along with the locations and time at which it was made. */
+struct FSensorOcclusionCacheEntry
+{
+	FVector SensorLocation {FVector::ZeroVector};
+	FVector TargetLocation {FVector::ZeroVector};
+	double Time {0.0};
+	bool IsOccluded {false};
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSensorStateChangedDelegate, const ESensorState, NewState);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSensorActivatedDelegate);
 
 UCLASS(Abstract, Blueprintable, BlueprintType, ClassGroup = "Sensors", Meta = (DisplayName = "Proximity Sensor"))
-class STORMWATCH_API AProximitySensor : public AActor
+class STORMWATCH_API AProximitySensor : public AActor, public IRoomRelevantObject
 {
 	GENERATED_BODY()
 
@@ -83,6 +93,14 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Sensor|Cooldown")
 	bool IsCooldownActive {false};
 	
+	/** How far the sensor or an actor can move before the cached occlusion of the actor is traced again. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sensor|Occlusion", Meta = (Units = "Centimeters", ClampMin = "0"))
+	float OcclusionCacheDistance {10.0f};
+
+	/** How long the cached occlusion of an actor remains valid while neither the sensor nor the actor moves. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sensor|Occlusion", Meta = (Units = "Seconds", ClampMin = "0"))
+	float OcclusionCacheMaxAge {1.0f};
+
 	/** The ignore parameters for the sensor. */
 	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Ignore Parameters")
 	TArray<EBProximitySensorIgnoreParameter> IgnoreParameters;
@@ -105,22 +123,26 @@ protected:
 
 	UPROPERTY(BlueprintGetter = GetIsAlerted)
 	bool IsAlerted {false};
-	
-	UPROPERTY()
-	FTimerHandle PollTimerHandle;
 
 	UPROPERTY()
 	FTimerHandle CooldownTimerHandle;
 
 private:
+	/** The last occlusion check of every actor inside the detection area. */
+	TMap<TObjectKey<AActor>, FSensorOcclusionCacheEntry> OcclusionCache;
+
 	/** The state of the sensor. */
 	UPROPERTY()
 	ESensorState SensorState {ESensorState::Idle};
 
-public:	
+public:
+	/** The amount of traces used to determine whether an actor is occluded. */
+	static constexpr int32 OcclusionTraceCount {3};
+
 	AProximitySensor();
 	
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	/** Resets the sensor. */
 	UFUNCTION(BlueprintCallable)
@@ -149,14 +171,36 @@ protected:
 	UFUNCTION()
 	void OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 	
-	/** Performs a poll for any pawns inside the sensor's range. */
+	/** Performs a poll for any pawns inside the sensor's range.
+	 *	Regular polls are batched by the sensor subsystem. This performs an immediate poll with synchronous traces. */
 	UFUNCTION(BlueprintCallable, Meta = (DisplayName = "Check Detection Area For Actors"))
-	virtual void Poll();
+	void Poll();
 	
 	/** Checks if the object within the sensor's range is occluded.*/
 	UFUNCTION()
 	bool IsActorOccluded(const AActor* Actor) const;
 
+	/** Starts or stops the regular polling by the sensor subsystem. */
+	void StartPolling();
+	void StopPolling();
+
+public:
+	/** Returns whether an overlapping actor can be detected, before checking for occlusion. */
+	virtual bool IsActorDetectable(const AActor* Actor) const { return true; }
+
+	/** Returns the start and end locations of the traces used to determine whether an actor is occluded. */
+	void GetOcclusionTraceLocations(const AActor* Actor, FVector& OutStart, FVector (&OutEnds)[OcclusionTraceCount]) const;
+
+	/** Returns whether the occlusion of an actor is cached and still valid, and if so whether it is occluded. */
+	bool GetCachedOcclusion(const AActor* Actor, bool& OutIsOccluded) const;
+
+	/** Caches the result of an occlusion check of an actor. */
+	void CacheOcclusion(const AActor* Actor, const bool IsOccluded);
+
+	/** Updates the detection state of the sensor with the result of a poll. */
+	void ProcessPoll(const bool IsDetected);
+
+protected:
 	/** Starts the cooldown. */
 	UFUNCTION()
 	void StartCooldown();
@@ -167,6 +211,10 @@ protected:
 	/** Sets the state of the sensor. */
 	void SetState(const ESensorState NewState);
 
+	/** Pauses the polling and cooldown timer while the sensor's room is not relevant. */
+	virtual void OnRoomSuspended_Implementation() override;
+	virtual void OnRoomResumed_Implementation() override;
+
 private:
 	/** Called when the cooldown is finished. */
 	UFUNCTION()
@@ -200,4 +248,7 @@ public:
 	/** Returns the poll interval for the sensor. */
 	UFUNCTION(BlueprintGetter)
 	FORCEINLINE float GetPollInterval() const { return PollInterval; }
+
+	/** Returns the actors that are currently inside the detection area. */
+	FORCEINLINE const TArray<AActor*>& GetOverlappingActors() const { return OverlappingActors; }
 };
@@ -0,0 +1,92 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "SensorSubsystem.generated.h"
+
+class AProximitySensor;
+
+/** An actor in the detection area of a sensor whose occlusion is being traced. */
+struct FSensorPollTarget
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	/** The amount of occlusion traces that are still in flight, and the amount that were blocked. */
+	uint8 PendingTraces {0};
+	uint8 BlockedTraces {0};
+
+	/** If true, the occlusion of the actor was taken from the sensor's cache and no traces were issued. */
+	bool IsCached {false};
+};
+
+/** A sensor that is polling for actors in its detection area. */
+struct FSensorPollEntry
+{
+	TWeakObjectPtr<AProximitySensor> Sensor;
+
+	/** The world time at which the sensor is polled next. */
+	double NextPollTime {0.0};
+
+	/** The targets of the poll that is in flight. */
+	TArray<FSensorPollTarget> Targets;
+	int32 PendingTraces {0};
+
+	/** Identifies the poll that is in flight, so that results of an abandoned poll are ignored. */
+	uint8 PollId {0};
+
+	bool IsPaused {false};
+};
+
+/** Polls every active proximity and motion sensor from a single scheduler.
+ *	The occlusion traces of all sensors that are due are issued as one batch of asynchronous traces,
+ *	and the sensors evaluate their detection once all traces of their poll have completed.
+ *	Actors whose occlusion is still cached by the sensor are not traced again. */
+UCLASS(ClassGroup = "Sensors", Meta = (DisplayName = "Sensor Subsystem"))
+class STORMWATCH_API USensorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogSensorSubsystem, Log, All)
+
+private:
+	/** The sensors that are polling. Entries are only removed while no traces are in flight, since the traces refer to them by index. */
+	TArray<FSensorPollEntry> Entries;
+
+	/** The amount of traces in flight over all entries. */
+	int32 PendingTraces {0};
+
+	FTraceDelegate TraceDelegate;
+
+public:
+	USensorSubsystem();
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts polling a sensor. The first poll happens on the next tick, or once the sensor's room is resumed if it is suspended. */
+	void StartPolling(AProximitySensor* Sensor);
+
+	/** Stops polling a sensor. A poll that is in flight is abandoned. */
+	void StopPolling(AProximitySensor* Sensor);
+
+	/** Pauses or resumes the polling of a sensor, keeping the time until its next poll. */
+	void SetPollingPaused(AProximitySensor* Sensor, const bool IsPaused);
+
+	/** Returns whether a sensor is polling. */
+	bool IsPolling(const AProximitySensor* Sensor) const;
+
+private:
+	/** Issues the occlusion traces for a sensor that is due. */
+	void BeginPoll(FSensorPollEntry& Entry, const int32 EntryIndex, UWorld* World);
+
+	/** Completes a poll and lets the sensor evaluate the result. */
+	void FinishPoll(FSensorPollEntry& Entry);
+
+	void HandleTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+};
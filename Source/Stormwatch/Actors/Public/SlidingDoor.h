@@ -5,6 +5,7 @@
 
 #include "CoreMinimal.h"
 #include "TriggerableObjectInterface.h"
+#include "RoomRelevantObjectInterface.h"
 #include "GameFramework/Actor.h"
 #include "SlidingDoor.generated.h"
 
@@ -33,7 +34,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnCooldownFinishedDelegate);
 
 /** Abstract base class for sliding door actors. */
 UCLASS(Abstract, Blueprintable, BlueprintType, ClassGroup = "Interaction", Meta = (DisplayName = "Sliding Door", PrioritizeCategories = "Door"))
-class ASlidingDoor : public AActor
+class ASlidingDoor : public AActor, public IRoomRelevantObject
 {
 	GENERATED_BODY()
 
@@ -168,10 +169,15 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	UFUNCTION(BlueprintCallable)
 	void StartCooldown();
 
+	/** Pauses the cooldown and close check timers while the door's rooms are not relevant. */
+	virtual void OnRoomSuspended_Implementation() override;
+	virtual void OnRoomResumed_Implementation() override;
+
 	/** Sets the collision profile of the safety zone. If we enable the safety zone collision while a pawn is inside,
 	 *	the pawn will be pushed out gradually out of the box before full blocking collision is enabled. */
 	UFUNCTION(BlueprintCallable)
@@ -7,18 +7,34 @@
 #include "MetasoundSource.h"
 #include "Components/AudioComponent.h"
 #include "GameFramework/PlayerController.h"
+#include "EngineUtils.h"
 
 /** Sets default values for this component's properties. */
 UExteriorWindAudioComponent::UExteriorWindAudioComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
 	bWantsInitializeComponent = true;
+
+	GeometryTraceDelegate.BindUObject(this, &UExteriorWindAudioComponent::HandleGeometryTraceCompleted);
+	OcclusionTraceDelegate.BindUObject(this, &UExteriorWindAudioComponent::HandleOcclusionTraceCompleted);
 }
 
 /** Called when the game starts. */
 void UExteriorWindAudioComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	WindExposureVolumes.Empty();
+	if (UseWindExposureVolumes && GetWorld())
+	{
+		for (TActorIterator<AWindExposureVolume> It(GetWorld()); It; ++It)
+		{
+			if (It->IsBaked())
+			{
+				WindExposureVolumes.Add(*It);
+			}
+		}
+	}
 }
 
 /** Called when the component is initialized. */
@@ -27,8 +43,9 @@ void UExteriorWindAudioComponent::InitializeComponent()
 	Super::InitializeComponent();
 	
 	/** Initialize the trace vector arrays. */
-	PopulateGeometryTraceVectors(GeometryTraceVectors, WindDirection, CollisionTraceLength, 8, TemporalTraceLength, TemporalTracePitchIncrement, TemporalTracePitchOffset);
-	PopulateOcclusionTraceVectors(OcclusionTraceStartVectors, OcclusionTraceEndVectors, WindDirection, CollisionTraceLength, 250);
+	BuildGeometryTraceVectors(GeometryTraceVectors, WindDirection, CollisionTraceLength);
+	BuildOcclusionTraceVectors(OcclusionTraceStartVectors, OcclusionTraceEndVectors, WindDirection, CollisionTraceLength);
+	UpdateGeometryTraceOrder();
 	
 	if (GetOwner())
 	{
@@ -39,8 +56,9 @@ void UExteriorWindAudioComponent::InitializeComponent()
 		AudioComponent->SetSound(MetaSoundAsset.LoadSynchronous());
 	}
 
-	/** Initialize the geometry query results array at a fixed size. */
-	GeometryQueryResults.Init(FHitResult(), 8 * TemporalTraceLength);
+	/** Initialize the query result arrays at a fixed size, so that trace results can be written into them directly. */
+	GeometryTraceDistances.Init(CollisionTraceLength, GeometryTraceVectors.Num());
+	OcclusionQueryResults.Init(CollisionTraceLength, OcclusionTraceStartVectors.Num());
 }
 
 void UExteriorWindAudioComponent::SetWindDirection(const FRotator& Rotation)
@@ -50,8 +68,20 @@ void UExteriorWindAudioComponent::SetWindDirection(const FRotator& Rotation)
 		return;
 	}
 	WindDirection = Rotation;
-	PopulateGeometryTraceVectors(GeometryTraceVectors, WindDirection, CollisionTraceLength, 8, TemporalTraceLength, TemporalTracePitchIncrement, TemporalTracePitchOffset);
-	PopulateOcclusionTraceVectors(OcclusionTraceStartVectors, OcclusionTraceEndVectors, WindDirection, CollisionTraceLength, 250);
+	BuildGeometryTraceVectors(GeometryTraceVectors, WindDirection, CollisionTraceLength);
+	BuildOcclusionTraceVectors(OcclusionTraceStartVectors, OcclusionTraceEndVectors, WindDirection, CollisionTraceLength);
+	UpdateGeometryTraceOrder();
+	GeometryTraceDistances.SetNum(GeometryTraceVectors.Num());
+
+	/** The order of the pending traces has changed, so the query restarts with the directions that now face the wind. */
+	if (IsQueryingGeometry)
+	{
+		BeginTemporalGeometryQuery(TemporalQueryOrigin);
+	}
+	if (PendingOcclusionTraces == 0)
+	{
+		OcclusionQueryResults.SetNum(OcclusionTraceStartVectors.Num());
+	}
 	EventOnWindDirectionChanged(Rotation);
 }
 
@@ -65,19 +95,21 @@ void UExteriorWindAudioComponent::TickComponent(float DeltaTime, ELevelTick Tick
 	if (GetOwner() && (GetOwner()->GetActorLocation() - LastPollLocation).SquaredLength() > 1000)
 	{
 		LastPollLocation = GetOwner()->GetActorLocation();
-		if (GetOwner())
+		if (SampleWindExposureVolumes(LastPollLocation) && !UseDynamicTraceCorrection)
 		{
-			if (IsQueryingGeometry)
-			{
-				IsGeometryQueryQueued = true;
-			}
-			else
+			BroadcastBakedExposure();
+		}
+		else
+		{
+			HasBroadcastExposure = false;
+
+			/** Small movements don't change the surrounding geometry much, so the samples of the last query are reused. */
+			if (!HasGeometryQueryOrigin || FVector::Dist(LastPollLocation, TemporalQueryOrigin) > GeometryQueryReuseDistance)
 			{
-				BeginTemporalGeometryQuery();
+				BeginTemporalGeometryQuery(LastPollLocation);
 			}
 			
-			const TArray<float> OcclusionTraceResults {DoOcclusionCollisionQuery(LastPollLocation)};
-			EventOnOcclusionPoll(OcclusionTraceResults);
+			BeginOcclusionQuery(LastPollLocation);
 		}
 	}
 }
@@ -85,21 +117,16 @@ void UExteriorWindAudioComponent::TickComponent(float DeltaTime, ELevelTick Tick
 TArray<float> UExteriorWindAudioComponent::DoTerrainCollisionQuery(const FVector& Location)
 {
 	TArray<float> TraceLengths;
-	
-	APawn* PlayerPawn {GetWorld()->GetFirstPlayerController()->GetPawn()};
-	
+	TraceLengths.Reserve(GeometryTraceVectors.Num());
+	UpdateTraceParams(false);
+
 	for (int i {0}; i < GeometryTraceVectors.Num(); i++)
 	{
 		const FVector TraceStart {GetOwner()->GetActorLocation()};
 		const FVector TraceEnd {GetOwner()->GetActorLocation() + GeometryTraceVectors[i]}; 
 
 		FHitResult HitResult;
-		FCollisionQueryParams Params {FCollisionQueryParams::DefaultQueryParam};
-		Params.bTraceComplex = false;
-		Params.bReturnPhysicalMaterial = false;
-		Params.AddIgnoredActor(PlayerPawn); 
-
-		if (GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, Params))
+		if (GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, TraceParams))
 		{
 			const float TraceLength {static_cast<float>((HitResult.ImpactPoint - TraceStart).Size())};
 			TraceLengths.Add(TraceLength);
@@ -116,8 +143,8 @@ TArray<float> UExteriorWindAudioComponent::DoTerrainCollisionQuery(const FVector
 TArray<float> UExteriorWindAudioComponent::DoOcclusionCollisionQuery(const FVector& Location)
 {
 	TArray<float> TraceLengths;
-
-	APawn* PlayerPawn {GetWorld()->GetFirstPlayerController()->GetPawn()};
+	TraceLengths.Reserve(OcclusionTraceStartVectors.Num());
+	UpdateTraceParams(false);
 	
 	for (int i {0}; i < OcclusionTraceStartVectors.Num(); i++)
 	{
@@ -125,12 +152,7 @@ TArray<float> UExteriorWindAudioComponent::DoOcclusionCollisionQuery(const FVect
 		const FVector TraceEnd {GetOwner()->GetActorLocation() + OcclusionTraceEndVectors[i]};
 
 		FHitResult HitResult;
-		FCollisionQueryParams Params {FCollisionQueryParams::DefaultQueryParam};
-		Params.bTraceComplex = false;
-		Params.bReturnPhysicalMaterial = false;
-		Params.AddIgnoredActor(PlayerPawn); 
-
-		if (GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, Params))
+		if (GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, TraceParams))
 		{
 			const float TraceLength {static_cast<float>((HitResult.ImpactPoint - TraceStart).Size())};
 			TraceLengths.Add(TraceLength);
@@ -151,118 +173,282 @@ TArray<float> UExteriorWindAudioComponent::DoOcclusionCollisionQuery(const FVect
 	return TraceLengths;
 }
 
-float UExteriorWindAudioComponent::GetAverageOfFloatArray(const TArray<float>& Array) const
+void UExteriorWindAudioComponent::BeginOcclusionQuery(const FVector& Location)
 {
-	float Sum {0.0f};
-	for(const float Value : Array)
+	OcclusionQueryOrigin = Location;
+	if (PendingOcclusionTraces > 0)
 	{
-		Sum += Value;
+		IsOcclusionQueryQueued = true;
+		return;
+	}
+
+	UWorld* World {GetWorld()};
+	if (!World) { return; }
+	UpdateTraceParams(HasBakedExposure);
+
+	OcclusionQueryResults.SetNum(OcclusionTraceStartVectors.Num());
+	for (int32 i {0}; i < OcclusionTraceStartVectors.Num(); ++i)
+	{
+		const FVector TraceStart {OcclusionQueryOrigin + OcclusionTraceStartVectors[i]};
+		const FVector TraceEnd {OcclusionQueryOrigin + OcclusionTraceEndVectors[i]};
+
+		/** The user data holds both the trace index and the query it belongs to. */
+		const uint32 UserData {static_cast<uint32>(OcclusionQueryId) << 16 | static_cast<uint32>(i)};
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, ECC_Visibility,
+			TraceParams, FCollisionResponseParams::DefaultResponseParam, &OcclusionTraceDelegate, UserData);
+		++PendingOcclusionTraces;
+
+#if WITH_EDITOR
+		if (IsTraceVisEnabled)
+		{
+			DrawDebugLine(World, TraceStart, TraceEnd, FColor::Red, false, 1.0f, 0, 1.0f);
+		}
+#endif
 	}
-	Sum /= Array.Num();
-	return Sum;
 }
 
-float UExteriorWindAudioComponent::GetAverageTraceLengthInCardinalDirection(const ETraceCardinalDirection Direction)
+void UExteriorWindAudioComponent::HandleOcclusionTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
 {
-	TArray<float> TraceLengths;
+	if ((TraceDatum.UserData >> 16) != OcclusionQueryId) { return; }
 
-	int StartIndex {0};
-	switch (Direction)
+	const int32 TraceIndex {static_cast<int32>(TraceDatum.UserData & MAX_uint16)};
+	if (OcclusionQueryResults.IsValidIndex(TraceIndex))
 	{
-	case ETraceCardinalDirection::North:
-		StartIndex = 0;
-		break;
-	case ETraceCardinalDirection::East:
-		StartIndex = 16;
-		break;
-	case ETraceCardinalDirection::South:
-		StartIndex = 32;
-		break;
-	case ETraceCardinalDirection::West:
-		StartIndex = 48;
-		break;
+		const FVector TraceEnd {TraceDatum.OutHits.IsEmpty() ? TraceDatum.End : TraceDatum.OutHits[0].ImpactPoint};
+		const float TraceLength {static_cast<float>((TraceEnd - TraceDatum.Start).Size())};
+
+		/** Inside a wind exposure volume, the traces only hit movable objects and correct the baked exposure. */
+		OcclusionQueryResults[TraceIndex] = HasBakedExposure
+			? FMath::Min(TraceLength, BakedExposure.GetOcclusionDistance(WindDirection.Yaw)) : TraceLength;
 	}
 
-	for (int32 i {StartIndex}; i < StartIndex + 16; ++i)
+	if (--PendingOcclusionTraces > 0) { return; }
+	EventOnOcclusionPoll(OcclusionQueryResults);
+
+	/** The owner moved while the query was pending, so we query again from the latest location. */
+	if (IsOcclusionQueryQueued)
 	{
-		const FHitResult& HitResult {GeometryQueryResults[i]};
-		if (HitResult.bBlockingHit)
-		{
-			TraceLengths.Add(GeometryQueryResults[i].Distance);
-		}
-		else
+		IsOcclusionQueryQueued = false;
+		BeginOcclusionQuery(OcclusionQueryOrigin);
+	}
+}
+
+void UExteriorWindAudioComponent::UpdateTraceParams(const bool IsDynamicOnly)
+{
+	/** The player controller is only looked up until it is found, after that the pawn is updated when its possession changes. */
+	if (!PlayerController.IsValid())
+	{
+		BindPlayerController();
+	}
+
+	const APawn* Pawn {PlayerPawn.Get()};
+	const EQueryMobilityType MobilityType {IsDynamicOnly ? EQueryMobilityType::Dynamic : EQueryMobilityType::Any};
+	if (HasTraceParams && TraceParamsIgnoredPawn == Pawn && TraceParams.MobilityType == MobilityType) { return; }
+
+	TraceParams = FCollisionQueryParams(SCENE_QUERY_STAT(ExteriorWindTrace), false);
+	TraceParams.bReturnPhysicalMaterial = false;
+	TraceParams.MobilityType = MobilityType;
+	TraceParams.AddIgnoredActor(Pawn);
+	TraceParamsIgnoredPawn = Pawn;
+	HasTraceParams = true;
+}
+
+void UExteriorWindAudioComponent::BindPlayerController()
+{
+	const UWorld* World {GetWorld()};
+	APlayerController* Controller {World ? World->GetFirstPlayerController() : nullptr};
+	if (!Controller) { return; }
+
+	PlayerController = Controller;
+	PlayerPawn = Controller->GetPawn();
+	Controller->OnPossessedPawnChanged.AddUniqueDynamic(this, &UExteriorWindAudioComponent::HandlePossessedPawnChanged);
+}
+
+void UExteriorWindAudioComponent::HandlePossessedPawnChanged(APawn* OldPawn, APawn* NewPawn)
+{
+	PlayerPawn = NewPawn;
+}
+
+bool UExteriorWindAudioComponent::SampleWindExposureVolumes(const FVector& Location)
+{
+	HasBakedExposure = false;
+	if (!UseWindExposureVolumes) { return false; }
+
+	for (const TWeakObjectPtr<AWindExposureVolume>& Volume : WindExposureVolumes)
+	{
+		if (Volume.IsValid() && Volume->Sample(Location, BakedExposure))
 		{
-			TraceLengths.Add(CollisionTraceLength);
+			HasBakedExposure = true;
+			break;
 		}
 	}
+	return HasBakedExposure;
+}
 
-	return GetAverageOfFloatArray(TraceLengths);
+void UExteriorWindAudioComponent::BroadcastBakedExposure()
+{
+	if (HasBroadcastExposure && BroadcastExposure == BakedExposure && BroadcastWindYaw == WindDirection.Yaw) { return; }
+	BroadcastExposure = BakedExposure;
+	BroadcastWindYaw = WindDirection.Yaw;
+	HasBroadcastExposure = true;
+
+	/** Discard any occlusion traces that are still pending, so that they don't overwrite the baked results when they complete. */
+	++OcclusionQueryId;
+	PendingOcclusionTraces = 0;
+	IsOcclusionQueryQueued = false;
+
+	/** The baked exposure only stores the average occlusion trace length, so every occlusion trace gets the average. */
+	OcclusionQueryResults.Init(BakedExposure.GetOcclusionDistance(WindDirection.Yaw), OcclusionTraceStartVectors.Num());
+	EventOnOcclusionPoll(OcclusionQueryResults);
+
+	/** The baked exposure only stores the average per cardinal direction, so every trace direction gets the average of its quarter. */
+	for (int32 i {0}; i < GeometryTraceDistances.Num(); ++i)
+	{
+		GeometryTraceDistances[i] = GetBakedOpenDistance(i);
+	}
+
+	/** Discard any traces that are still pending, and start a fresh query once the owner leaves the volume. */
+	++GeometryQueryId;
+	PendingGeometryTraces = 0;
+	IsQueryingGeometry = false;
+	HasGeometryQueryOrigin = false;
+	EventOnGeometryQueryFinished(GeometryTraceDistances);
 }
 
-void UExteriorWindAudioComponent::BeginTemporalGeometryQuery()
+float UExteriorWindAudioComponent::GetBakedOpenDistance(const int32 TraceIndex) const
 {
-	ResetGeometryQueryResults();
-	IsQueryingGeometry = true;
-	TemporalQueryOrigin = GetOwner()->GetActorLocation();
+	/** The geometry trace vectors are sorted by yaw, so every cardinal direction is a consecutive quarter of the array. */
+	const int32 TracesPerDirection {FMath::Max(1, GeometryTraceDistances.Num() / 4)};
+	return BakedExposure.OpenDistances[FMath::Min(TraceIndex / TracesPerDirection, 3)];
 }
 
-void UExteriorWindAudioComponent::ResetGeometryQueryResults()
+float UExteriorWindAudioComponent::GetAverageOfFloatArray(const TArray<float>& Array) const
 {
-	for (FHitResult& HitResult : GeometryQueryResults)
+	float Sum {0.0f};
+	for(const float Value : Array)
 	{
-		HitResult.Reset();
+		Sum += Value;
 	}
+	Sum /= Array.Num();
+	return Sum;
 }
 
-void UExteriorWindAudioComponent::UpdateGeometryQuery()
+float UExteriorWindAudioComponent::GetAverageTraceLengthInCardinalDirection(const ETraceCardinalDirection Direction)
 {
-	if (!IsQueryingGeometry) { return; }
+	const int32 DirectionIndex {static_cast<int32>(Direction)};
+	if (HasBakedExposure && !UseDynamicTraceCorrection)
+	{
+		return BakedExposure.OpenDistances[DirectionIndex];
+	}
+
+	/** The geometry trace vectors are sorted by yaw, so every cardinal direction is a consecutive quarter of the array. */
+	const int32 TracesPerDirection {GeometryTraceDistances.Num() / 4};
+	if (TracesPerDirection == 0) { return CollisionTraceLength; }
 
-	if (CurrentTemporalTraceFrame >= TemporalTraceLength - 1)
+	float DistanceSum {0.0f};
+	for (int32 i {DirectionIndex * TracesPerDirection}; i < (DirectionIndex + 1) * TracesPerDirection; ++i)
 	{
-		CurrentTemporalTraceFrame = 0;
-		if (IsGeometryQueryQueued)
-		{
-			BeginTemporalGeometryQuery();
-			IsGeometryQueryQueued = false;
-		}
-		else
-		{
-			IsQueryingGeometry = false;
-		}
-		EventOnGeometryQueryFinished(GeometryQueryResults);
-		return;
+		DistanceSum += GeometryTraceDistances[i];
 	}
 
-	const int StartIndex {CurrentTemporalTraceFrame * 8};
-	const int EndIndex {StartIndex + 8};
+	/** Inside a wind exposure volume, the distances are already corrected with the baked exposure when their traces complete. */
+	return DistanceSum / TracesPerDirection;
+}
 
-	for (int i {StartIndex}; i <= EndIndex; ++i)
+void UExteriorWindAudioComponent::BeginTemporalGeometryQuery(const FVector& Location)
+{
+	/** The distances of the previous query are kept, so that there is always a complete set of samples while the new query is refined. */
+	++GeometryQueryId;
+	PendingGeometryTraces = 0;
+	NextGeometryTrace = 0;
+	IsQueryingGeometry = true;
+	TemporalQueryOrigin = Location;
+	HasGeometryQueryOrigin = true;
+	if (GeometryTraceDistances.Num() != GeometryTraceVectors.Num())
 	{
+		GeometryTraceDistances.Init(CollisionTraceLength, GeometryTraceVectors.Num());
+	}
+}
+
+void UExteriorWindAudioComponent::UpdateGeometryQuery()
+{
+	if (!IsQueryingGeometry || NextGeometryTrace >= GeometryTraceOrder.Num()) { return; }
+
+	UWorld* World {GetWorld()};
+	if (!World) { return; }
+	UpdateTraceParams(HasBakedExposure);
+
+	const uint64 StartCycles {FPlatformTime::Cycles64()};
+	const double Budget {GeometryQueryBudget * 1e-6};
+	do
+	{
+		const int32 TraceIndex {GeometryTraceOrder[NextGeometryTrace++]};
 		const FVector TraceStart {TemporalQueryOrigin};
-		const FVector TraceEnd {TemporalQueryOrigin + GeometryTraceVectors[i]}; 
+		const FVector TraceEnd {TemporalQueryOrigin + GeometryTraceVectors[TraceIndex]}; 
 
-		FHitResult& HitResult {GeometryQueryResults[i]};
-		FCollisionQueryParams Params {FCollisionQueryParams::DefaultQueryParam};
-		Params.bTraceComplex = false;
-		Params.bReturnPhysicalMaterial = false;
-		GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, Params);
+		/** The user data holds both the trace index and the query it belongs to. */
+		const uint32 UserData {static_cast<uint32>(GeometryQueryId) << 16 | static_cast<uint32>(TraceIndex)};
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, ECC_Visibility,
+			TraceParams, FCollisionResponseParams::DefaultResponseParam, &GeometryTraceDelegate, UserData);
+		++PendingGeometryTraces;
 
 #if WITH_EDITOR
 		if (IsTraceVisEnabled)
 		{
-			DrawDebugLine(GetWorld(), TraceStart, TraceEnd, FColor::White, false, 1.0f, 0, 1.0f);
+			DrawDebugLine(World, TraceStart, TraceEnd, FColor::White, false, 1.0f, 0, 1.0f);
 		}
 #endif
 	}
+	while (NextGeometryTrace < GeometryTraceOrder.Num() && FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) < Budget);
+}
+
+void UExteriorWindAudioComponent::HandleGeometryTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	if ((TraceDatum.UserData >> 16) != GeometryQueryId) { return; }
+
+	const int32 TraceIndex {static_cast<int32>(TraceDatum.UserData & MAX_uint16)};
+	if (GeometryTraceDistances.IsValidIndex(TraceIndex))
+	{
+		const FVector TraceEnd {TraceDatum.OutHits.IsEmpty() ? TraceDatum.End : TraceDatum.OutHits[0].ImpactPoint};
+		const float TraceLength {static_cast<float>((TraceEnd - TraceDatum.Start).Size())};
+
+		/** Inside a wind exposure volume, the traces only hit movable objects and correct the baked exposure. */
+		GeometryTraceDistances[TraceIndex] = HasBakedExposure ? FMath::Min(TraceLength, GetBakedOpenDistance(TraceIndex)) : TraceLength;
+	}
+	if (--PendingGeometryTraces > 0 || !IsQueryingGeometry) { return; }
 
-	CurrentTemporalTraceFrame++;
+	if (NextGeometryTrace >= GeometryTraceOrder.Num())
+	{
+		FinishGeometryQuery();
+	}
+}
+
+void UExteriorWindAudioComponent::FinishGeometryQuery()
+{
+	IsQueryingGeometry = false;
+	EventOnGeometryQueryFinished(GeometryTraceDistances);
+}
+
+void UExteriorWindAudioComponent::UpdateGeometryTraceOrder()
+{
+	/** The occlusion traces run against the wind direction, so that is the direction the wind comes from. */
+	const FVector IntoWind {-WindDirection.Vector()};
+	TArray<float> Facing;
+	Facing.SetNumUninitialized(GeometryTraceVectors.Num());
+	GeometryTraceOrder.SetNumUninitialized(GeometryTraceVectors.Num());
+	for (int32 i {0}; i < GeometryTraceVectors.Num(); ++i)
+	{
+		Facing[i] = static_cast<float>(FVector::DotProduct(GeometryTraceVectors[i].GetSafeNormal(), IntoWind));
+		GeometryTraceOrder[i] = i;
+	}
+	GeometryTraceOrder.Sort([&Facing](const int32 A, const int32 B) { return Facing[A] > Facing[B]; });
 }
 
 /** Populates the terrain trace array. */
 void UExteriorWindAudioComponent::PopulateGeometryTraceVectors(TArray<FVector>& Array, const FRotator& Rotation,
 	const float Radius, const float NumPoints, const uint8 TemporalFrames, const float PitchIncrement, const float PitchOffset)
 {
+	Array.Reset();
 	TArray<TPair<FVector, double>> AzimuthVectors;
     
 	const float AngleIncrement {2.f * PI / NumPoints};
@@ -352,6 +538,17 @@ void UExteriorWindAudioComponent::SortTraceVectorsByYaw(TArray<TPair<FVector, do
 	TraceVectors.Append(WestVectors);
 }
 
+void UExteriorWindAudioComponent::BuildGeometryTraceVectors(TArray<FVector>& OutVectors, const FRotator& Rotation, const float TraceLength) const
+{
+	PopulateGeometryTraceVectors(OutVectors, Rotation, TraceLength, GeometryTracesPerRing, TemporalTraceLength, TemporalTracePitchIncrement, TemporalTracePitchOffset);
+}
+
+void UExteriorWindAudioComponent::BuildOcclusionTraceVectors(TArray<FVector>& OutStartVectors, TArray<FVector>& OutEndVectors,
+	const FRotator& Rotation, const float TraceLength) const
+{
+	PopulateOcclusionTraceVectors(OutStartVectors, OutEndVectors, Rotation, TraceLength, OcclusionTraceSpacing);
+}
+
 /** Populates the occlusion trace arrays. */
 void UExteriorWindAudioComponent::PopulateOcclusionTraceVectors(TArray<FVector>& ArrayA, TArray<FVector>& ArrayB,
 	const FRotator& Rotation, const float TraceLength, const float Spacing)
@@ -390,6 +587,13 @@ void UExteriorWindAudioComponent::PopulateOcclusionTraceVectors(TArray<FVector>&
 /** Called when before the object is destroyed. */
 void UExteriorWindAudioComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	if (APlayerController* Controller {PlayerController.Get()})
+	{
+		Controller->OnPossessedPawnChanged.RemoveDynamic(this, &UExteriorWindAudioComponent::HandlePossessedPawnChanged);
+	}
+	PlayerController.Reset();
+	PlayerPawn.Reset();
+
 	if (AudioComponent)
 	{
 		if (AudioComponent->IsPlaying())
@@ -401,22 +605,12 @@ void UExteriorWindAudioComponent::EndPlay(const EEndPlayReason::Type EndPlayReas
 	Super::EndPlay(EndPlayReason);
 }
 
-TArray<FHitResult> UExteriorWindAudioComponent::GetGeometryQueryResults() const
-{
-	if (!IsQueryingGeometry)
-	{
-		return GeometryQueryResults;
-	}
-	TArray<FHitResult> EmptyArray;
-	return EmptyArray;
-}
-
 void UExteriorWindAudioComponent::EventOnOcclusionPoll_Implementation(const TArray<float>& OcclusionTraceResults)
 {
 }
 
 void UExteriorWindAudioComponent::EventOnGeometryQueryFinished_Implementation(
-	const TArray<FHitResult>& GeometryTraceResults)
+	const TArray<float>& TraceDistances)
 {
 }
 
@@ -0,0 +1,240 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "WindExposureVolume.h"
+#include "ExteriorWindAudioComponent.h"
+#include "Components/BoxComponent.h"
+#include "Async/ParallelFor.h"
+
+DEFINE_LOG_CATEGORY_CLASS(AWindExposureVolume, LogWindExposureVolume);
+
+/** The amount of samples along each axis of a brick. */
+static constexpr int32 BrickSize {4};
+static constexpr int32 BrickSampleCount {BrickSize * BrickSize * BrickSize};
+
+float FWindExposure::GetOcclusionDistance(const float WindYaw) const
+{
+	const float Bucket {static_cast<float>(FRotator::ClampAxis(WindYaw)) / (360.0f / WindExposureDirectionCount)};
+	const int32 BucketA {FMath::FloorToInt32(Bucket) % WindExposureDirectionCount};
+	const int32 BucketB {(BucketA + 1) % WindExposureDirectionCount};
+	return FMath::Lerp(OcclusionDistances[BucketA], OcclusionDistances[BucketB], FMath::Frac(Bucket));
+}
+
+AWindExposureVolume::AWindExposureVolume()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Bounds = CreateDefaultSubobject<UBoxComponent>(TEXT("Bounds"));
+	Bounds->SetBoxExtent(FVector(5000.0f, 5000.0f, 1000.0f));
+	Bounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Bounds->SetCanEverAffectNavigation(false);
+	SetRootComponent(Bounds);
+
+	SetActorHiddenInGame(true);
+}
+
+const FWindExposureSample& AWindExposureVolume::GetSample(const int32 X, const int32 Y, const int32 Z) const
+{
+	const int32 BrickIndex {((Z / BrickSize) * BrickCount.Y + Y / BrickSize) * BrickCount.X + X / BrickSize};
+	const int32 Brick {Bricks[BrickIndex]};
+	if (Brick < 0)
+	{
+		return Samples[-Brick - 1];
+	}
+	return Samples[Brick + ((Z % BrickSize) * BrickSize + Y % BrickSize) * BrickSize + X % BrickSize];
+}
+
+bool AWindExposureVolume::Sample(const FVector& Location, FWindExposure& OutExposure) const
+{
+	if (Bricks.IsEmpty()) { return false; }
+
+	const FVector GridLocation {(Location - Origin) / BakedCellSize};
+	if (GridLocation.X < 0.0 || GridLocation.Y < 0.0 || GridLocation.Z < 0.0
+		|| GridLocation.X > SampleCount.X - 1 || GridLocation.Y > SampleCount.Y - 1 || GridLocation.Z > SampleCount.Z - 1)
+	{
+		return false;
+	}
+
+	const int32 X0 {FMath::Min(FMath::FloorToInt32(GridLocation.X), SampleCount.X - 1)};
+	const int32 Y0 {FMath::Min(FMath::FloorToInt32(GridLocation.Y), SampleCount.Y - 1)};
+	const int32 Z0 {FMath::Min(FMath::FloorToInt32(GridLocation.Z), SampleCount.Z - 1)};
+	const int32 X1 {FMath::Min(X0 + 1, SampleCount.X - 1)};
+	const int32 Y1 {FMath::Min(Y0 + 1, SampleCount.Y - 1)};
+	const int32 Z1 {FMath::Min(Z0 + 1, SampleCount.Z - 1)};
+	const float FracX {static_cast<float>(GridLocation.X - X0)};
+	const float FracY {static_cast<float>(GridLocation.Y - Y0)};
+	const float FracZ {static_cast<float>(GridLocation.Z - Z0)};
+
+	OutExposure = FWindExposure();
+	const float Scale {BakedTraceLength / MAX_uint8};
+	for (int32 Corner {0}; Corner < 8; ++Corner)
+	{
+		const bool IsUpperX {(Corner & 1) != 0};
+		const bool IsUpperY {(Corner & 2) != 0};
+		const bool IsUpperZ {(Corner & 4) != 0};
+		const float Weight {(IsUpperX ? FracX : 1.0f - FracX) * (IsUpperY ? FracY : 1.0f - FracY) * (IsUpperZ ? FracZ : 1.0f - FracZ)};
+		if (Weight <= 0.0f) { continue; }
+
+		const FWindExposureSample& CornerSample {GetSample(IsUpperX ? X1 : X0, IsUpperY ? Y1 : Y0, IsUpperZ ? Z1 : Z0)};
+		for (int32 i {0}; i < 4; ++i)
+		{
+			OutExposure.OpenDistances[i] += CornerSample.OpenDistances[i] * Weight * Scale;
+		}
+		for (int32 i {0}; i < WindExposureDirectionCount; ++i)
+		{
+			OutExposure.OcclusionDistances[i] += CornerSample.OcclusionDistances[i] * Weight * Scale;
+		}
+	}
+	return true;
+}
+
+#if WITH_EDITOR
+void AWindExposureVolume::BakeWindExposure()
+{
+	UWorld* World {GetWorld()};
+	if (!World || !Bounds) { return; }
+
+	ClearWindExposure();
+
+	const FVector Center {Bounds->GetComponentLocation()};
+	const FVector Extent {Bounds->GetScaledBoxExtent()};
+
+	Origin = Center - Extent;
+	SampleCount = FIntVector(
+		FMath::Max(2, FMath::CeilToInt32(2.0f * Extent.X / CellSize) + 1),
+		FMath::Max(2, FMath::CeilToInt32(2.0f * Extent.Y / CellSize) + 1),
+		FMath::Max(2, FMath::CeilToInt32(2.0f * Extent.Z / CellSize) + 1));
+
+	/** Every sample costs over a hundred traces, so guard against accidentally baking a huge area with a tiny cell size. */
+	constexpr int64 MaxSampleCount {1024 * 1024};
+	if (static_cast<int64>(SampleCount.X) * SampleCount.Y * SampleCount.Z > MaxSampleCount)
+	{
+		UE_LOG(LogWindExposureVolume, Error, TEXT("Wind exposure volume '%s' is too large to bake. Increase the cell size or reduce the bounds."), *GetName());
+		SampleCount = FIntVector::ZeroValue;
+		return;
+	}
+
+	BrickCount = FIntVector(
+		FMath::DivideAndRoundUp(SampleCount.X, BrickSize),
+		FMath::DivideAndRoundUp(SampleCount.Y, BrickSize),
+		FMath::DivideAndRoundUp(SampleCount.Z, BrickSize));
+	BakedCellSize = CellSize;
+	BakedTraceLength = TraceLength;
+
+	/** Use the exact same trace pattern as the exterior wind audio component. */
+	const UExteriorWindAudioComponent* WindAudioComponent {WindAudioComponentClass
+		? WindAudioComponentClass->GetDefaultObject<UExteriorWindAudioComponent>() : GetDefault<UExteriorWindAudioComponent>()};
+	TArray<FVector> GeometryTraceVectors;
+	WindAudioComponent->BuildGeometryTraceVectors(GeometryTraceVectors, FRotator::ZeroRotator, TraceLength);
+	TArray<FVector> OcclusionTraceStarts[WindExposureDirectionCount];
+	TArray<FVector> OcclusionTraceEnds[WindExposureDirectionCount];
+	for (int32 Direction {0}; Direction < WindExposureDirectionCount; ++Direction)
+	{
+		const FRotator Rotation {0.0, Direction * 360.0 / WindExposureDirectionCount, 0.0};
+		WindAudioComponent->BuildOcclusionTraceVectors(OcclusionTraceStarts[Direction], OcclusionTraceEnds[Direction], Rotation, TraceLength);
+	}
+
+	/** Only static geometry is baked. Movable objects are left to the optional trace correction at runtime. */
+	FCollisionQueryParams Params {SCENE_QUERY_STAT(WindExposureBake), false, this};
+	Params.bReturnPhysicalMaterial = false;
+	Params.MobilityType = EQueryMobilityType::Static;
+
+	const int32 TotalBrickCount {BrickCount.X * BrickCount.Y * BrickCount.Z};
+	TArray<TArray<FWindExposureSample>> BrickSamples;
+	BrickSamples.SetNum(TotalBrickCount);
+
+	/** Scene queries are thread safe, so the bricks are baked in parallel. */
+	ParallelFor(TotalBrickCount, [&](const int32 BrickIndex)
+	{
+		const FIntVector Brick {BrickIndex % BrickCount.X, (BrickIndex / BrickCount.X) % BrickCount.Y, BrickIndex / (BrickCount.X * BrickCount.Y)};
+		TArray<FWindExposureSample>& Result {BrickSamples[BrickIndex]};
+		Result.SetNum(BrickSampleCount);
+
+		for (int32 i {0}; i < BrickSampleCount; ++i)
+		{
+			/** Samples beyond the edge of the grid are clamped to the edge, so they never break the uniformity of a brick. */
+			const int32 X {FMath::Min(Brick.X * BrickSize + i % BrickSize, SampleCount.X - 1)};
+			const int32 Y {FMath::Min(Brick.Y * BrickSize + (i / BrickSize) % BrickSize, SampleCount.Y - 1)};
+			const int32 Z {FMath::Min(Brick.Z * BrickSize + i / (BrickSize * BrickSize), SampleCount.Z - 1)};
+			Result[i] = BakeSample(World, Origin + FVector(X, Y, Z) * CellSize, GeometryTraceVectors, OcclusionTraceStarts, OcclusionTraceEnds, Params);
+		}
+
+		const bool IsUniform {!Result.ContainsByPredicate([&Result](const FWindExposureSample& Sample) { return !(Sample == Result[0]); })};
+		if (IsUniform)
+		{
+			Result.SetNum(1);
+		}
+	});
+
+	Bricks.SetNum(TotalBrickCount);
+	int32 UniformBrickCount {0};
+	for (int32 BrickIndex {0}; BrickIndex < TotalBrickCount; ++BrickIndex)
+	{
+		const bool IsUniform {BrickSamples[BrickIndex].Num() == 1};
+		Bricks[BrickIndex] = IsUniform ? -Samples.Num() - 1 : Samples.Num();
+		Samples.Append(BrickSamples[BrickIndex]);
+		UniformBrickCount += IsUniform ? 1 : 0;
+	}
+
+	UE_LOG(LogWindExposureVolume, Log, TEXT("Baked wind exposure volume '%s': %d x %d x %d samples, %d of %d bricks uniform, %d KB."),
+		*GetName(), SampleCount.X, SampleCount.Y, SampleCount.Z, UniformBrickCount, TotalBrickCount,
+		(Samples.Num() * sizeof(FWindExposureSample) + Bricks.Num() * sizeof(int32)) / 1024);
+}
+
+FWindExposureSample AWindExposureVolume::BakeSample(const UWorld* World, const FVector& Location, const TArray<FVector>& GeometryTraceVectors,
+	const TArray<FVector> (&OcclusionTraceStarts)[WindExposureDirectionCount], const TArray<FVector> (&OcclusionTraceEnds)[WindExposureDirectionCount],
+	const FCollisionQueryParams& Params) const
+{
+	const auto TraceDistance = [World, &Params, this](const FVector& TraceStart, const FVector& TraceEnd)
+	{
+		FHitResult HitResult;
+		if (World->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, Params))
+		{
+			return static_cast<float>((HitResult.ImpactPoint - TraceStart).Size());
+		}
+		return static_cast<float>((TraceEnd - TraceStart).Size());
+	};
+	const auto Quantize = [this](const float Distance)
+	{
+		return static_cast<uint8>(FMath::Clamp(FMath::RoundToInt32(Distance / TraceLength * MAX_uint8), 0, MAX_uint8));
+	};
+
+	FWindExposureSample Sample;
+
+	/** The geometry trace vectors are sorted by yaw, so every cardinal direction is a consecutive quarter of the array. */
+	const int32 TracesPerDirection {FMath::Max(1, GeometryTraceVectors.Num() / 4)};
+	for (int32 Direction {0}; Direction < 4; ++Direction)
+	{
+		float DistanceSum {0.0f};
+		for (int32 i {Direction * TracesPerDirection}; i < (Direction + 1) * TracesPerDirection && i < GeometryTraceVectors.Num(); ++i)
+		{
+			DistanceSum += TraceDistance(Location, Location + GeometryTraceVectors[i]);
+		}
+		Sample.OpenDistances[Direction] = Quantize(DistanceSum / TracesPerDirection);
+	}
+
+	for (int32 Direction {0}; Direction < WindExposureDirectionCount; ++Direction)
+	{
+		const TArray<FVector>& Starts {OcclusionTraceStarts[Direction]};
+		const TArray<FVector>& Ends {OcclusionTraceEnds[Direction]};
+		float DistanceSum {0.0f};
+		for (int32 i {0}; i < Starts.Num(); ++i)
+		{
+			DistanceSum += TraceDistance(Location + Starts[i], Location + Ends[i]);
+		}
+		Sample.OcclusionDistances[Direction] = Quantize(Starts.IsEmpty() ? TraceLength : DistanceSum / Starts.Num());
+	}
+	return Sample;
+}
+
+void AWindExposureVolume::ClearWindExposure()
+{
+	Modify();
+	Bricks.Empty();
+	Samples.Empty();
+	SampleCount = FIntVector::ZeroValue;
+	BrickCount = FIntVector::ZeroValue;
+	BakedCellSize = 0.0f;
+	BakedTraceLength = 0.0f;
+}
+#endif
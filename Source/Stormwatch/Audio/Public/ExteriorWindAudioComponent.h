@@ -5,9 +5,12 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "WindExposureVolume.h"
 #include "ExteriorWindAudioComponent.generated.h"
 
 class UMetaSoundSource;
+class APlayerController;
 
 UENUM()
 enum class ETraceCardinalDirection : uint8
@@ -33,8 +36,7 @@ public:
 	float CollisionTraceLength {3000};
 
 protected:
-	/** The number of frames to use for a single temporal collision query.
-	 *Currently we do not keep the framerate of the system in count, so keep this number below 10 to keep the query responsive. */
+	/** The number of elevation rings of the geometry query. Every ring adds GeometryTracesPerRing trace directions. */
 	UPROPERTY(EditAnywhere, Category = "Temporal Geometry Query", Meta = (DisplayName = "Temporal Geomtry Query Length",
 		ClampMin = "0", ClampMax = "16", UIMin = "0", UIMax = "16"))
 	uint8 TemporalTraceLength {8};
@@ -49,26 +51,55 @@ protected:
 		Meta = (ClampMin = "-45", ClampMax = "45", UIMin = "-45", UIMax = "45"))
 	float TemporalTracePitchOffset {-20.0f};
 
+	/** The maximum time per frame that is spent issuing geometry query traces. At least one trace is issued every frame. */
+	UPROPERTY(EditAnywhere, Category = "Temporal Geometry Query", Meta = (Units = "Microseconds",
+		ClampMin = "1", ClampMax = "1000", UIMin = "1", UIMax = "200"))
+	float GeometryQueryBudget {40.0f};
+
+	/** The distance the owner can move away from the origin of the last geometry query before a new query is started.
+	 *	Within this distance, the completed samples of the last query are reused. */
+	UPROPERTY(EditAnywhere, Category = "Temporal Geometry Query", Meta = (Units = "Centimeters",
+		ClampMin = "0", UIMin = "0", UIMax = "1000"))
+	float GeometryQueryReuseDistance {200.0f};
+
+	/** The distance between the parallel traces of the occlusion query, perpendicular to the wind direction. */
+	UPROPERTY(EditAnywhere, Category = "Wind Occlusion", Meta = (Units = "Centimeters",
+		ClampMin = "0", UIMin = "0", UIMax = "1000"))
+	float OcclusionTraceSpacing {250.0f};
+
+	/** If true, the wind exposure is read from the baked wind exposure volumes in the level wherever they are available,
+	 *	instead of being traced at runtime. */
+	UPROPERTY(EditAnywhere, Category = "Wind Exposure")
+	bool UseWindExposureVolumes {true};
+
+	/** If true, traces against movable objects are still performed inside wind exposure volumes, to correct the baked exposure for dynamic objects. */
+	UPROPERTY(EditAnywhere, Category = "Wind Exposure", Meta = (EditCondition = "UseWindExposureVolumes"))
+	bool UseDynamicTraceCorrection {false};
+
 private:
 	/** When true, the component is currently performing a temporal terrain query. */
 	UPROPERTY()
 	bool IsQueryingGeometry {false};
 
-	/** When true, we assume another query is queued after the current temporal query. */
+	/** The distance to the nearest geometry along every geometry trace vector. Samples of the previous query are kept until they are refined. */
 	UPROPERTY()
-	bool IsGeometryQueryQueued {false};
+	TArray<float> GeometryTraceDistances;
 
-	/** Array of hit results from a temporal geometry query.  */
-	UPROPERTY()
-	TArray<FHitResult> GeometryQueryResults;
+	/** The indices of the geometry trace vectors, sorted by how much they face into the wind. */
+	TArray<int32> GeometryTraceOrder;
 
-	/** The current frame of the temporal geometry query. */
-	UPROPERTY()
-	uint8 CurrentTemporalTraceFrame {0};
+	/** The position in GeometryTraceOrder of the next trace to issue. */
+	int32 NextGeometryTrace {0};
+
+	/** Incremented whenever a geometry query starts, so that traces of a previous query are discarded when they complete. */
+	uint16 GeometryQueryId {0};
 
 	/** The location from a temporal query is performed. */
 	UPROPERTY()
 	FVector TemporalQueryOrigin;
+
+	/** Whether a geometry query was started at TemporalQueryOrigin. */
+	bool HasGeometryQueryOrigin {false};
 	
 	/** The AudioComponent that is added to the owner of this actor to play wind audio on. */
 	UPROPERTY(BlueprintGetter = GetAudioComponent)
@@ -92,6 +123,48 @@ private:
 	UPROPERTY()
 	TArray<FVector> OcclusionTraceEndVectors;
 
+	/** The trace lengths of the most recent occlusion query. Allocated once for the amount of occlusion traces. */
+	UPROPERTY()
+	TArray<float> OcclusionQueryResults;
+
+	/** The location from which the pending occlusion query is performed. */
+	FVector OcclusionQueryOrigin {FVector::ZeroVector};
+
+	/** Incremented whenever the occlusion results are replaced by the baked exposure, so that traces still in flight are discarded when they complete. */
+	uint16 OcclusionQueryId {0};
+
+	/** When true, another occlusion query is issued as soon as the pending one completes. */
+	bool IsOcclusionQueryQueued {false};
+
+	/** The amount of asynchronous traces that have been issued but not completed yet. */
+	int32 PendingGeometryTraces {0};
+	int32 PendingOcclusionTraces {0};
+
+	/** Query params for the wind traces. Only rebuilt when the pawn to ignore changes. */
+	FCollisionQueryParams TraceParams;
+	TWeakObjectPtr<const APawn> TraceParamsIgnoredPawn;
+	bool HasTraceParams {false};
+
+	/** The player controller and the pawn it possesses, which is ignored by the wind traces. Updated when the possessed pawn changes. */
+	TWeakObjectPtr<APlayerController> PlayerController;
+	TWeakObjectPtr<APawn> PlayerPawn;
+
+	/** The baked wind exposure volumes in the world. */
+	TArray<TWeakObjectPtr<AWindExposureVolume>> WindExposureVolumes;
+
+	/** The baked wind exposure at the last poll location. Only valid if HasBakedExposure is true. */
+	FWindExposure BakedExposure;
+	bool HasBakedExposure {false};
+
+	/** The baked exposure and wind direction the poll events were last fired for, so that they are only fired again when either changes. */
+	FWindExposure BroadcastExposure;
+	float BroadcastWindYaw {0.0f};
+	bool HasBroadcastExposure {false};
+
+	/** Delegates that are called when an asynchronous trace completes. */
+	FTraceDelegate GeometryTraceDelegate;
+	FTraceDelegate OcclusionTraceDelegate;
+
 #if WITH_EDITORONLY_DATA
 	/** If enabled, the component will visualize the traces. */
 	UPROPERTY(EditAnywhere, Category = "Editor", Meta = (DisplayName = "Enable Trace Visualisation"))
@@ -99,6 +172,9 @@ private:
 #endif
 
 public:	
+	/** The amount of trace directions in every elevation ring of the geometry query. */
+	static constexpr int32 GeometryTracesPerRing {8};
+
 	/** Sets default values for this component's properties. */
 	UExteriorWindAudioComponent();
 	
@@ -109,6 +185,27 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SetWindDirection(const FRotator& Rotation);
 
+	/** Populate a TArray of FAzimuthVector with vectors representing points on a circle that are rotated and adjusted in elevation.
+	* @param Array The TArray that will be populated.
+	* @param Rotation The rotation applied to the vectors.
+	* @param Radius The radius of the circle.
+	* @param NumPoints The number of points to generate on the circle.
+	* @param TemporalFrames The number of frames over which to distribute the generated points.
+	* @param PitchIncrement The increment applied to the pitch angle at each step.
+	* @param PitchOffset The offset applied to the pitch angle. */
+	static void PopulateGeometryTraceVectors(TArray<FVector>& Array, const FRotator& Rotation, const float Radius,
+		const float NumPoints, const uint8 TemporalFrames, const float PitchIncrement, const float PitchOffset);
+
+	/** Populates the occlusion trace vector arrays. */
+	static void PopulateOcclusionTraceVectors(TArray<FVector>& ArrayA, TArray<FVector>& ArrayB, const FRotator& Rotation, const float TraceLength, const float Spacing);
+
+	/** Populates the geometry trace vectors with the trace pattern configured on this component.
+	 *	The wind exposure volume uses this on the class default object, so that it bakes the same pattern the component traces. */
+	void BuildGeometryTraceVectors(TArray<FVector>& OutVectors, const FRotator& Rotation, const float TraceLength) const;
+
+	/** Populates the occlusion trace vectors with the trace pattern configured on this component. */
+	void BuildOcclusionTraceVectors(TArray<FVector>& OutStartVectors, TArray<FVector>& OutEndVectors, const FRotator& Rotation, const float TraceLength) const;
+
 protected:
 	/** Called when the game starts. */
 	virtual void BeginPlay() override;
@@ -119,11 +216,11 @@ protected:
 	/** Called when the component is initialized, but before BeginPlay. */
 	virtual void InitializeComponent() override;
 	
-	/** Returns an array of terrain trace lenghts. */
+	/** Returns an array of terrain trace lenghts. This query is synchronous. */
 	UFUNCTION(BlueprintCallable)
 	TArray<float> DoTerrainCollisionQuery(const FVector& Location);
 
-	/** Returns an array of occlusion traces. */
+	/** Returns an array of occlusion traces. This query is synchronous, the component itself uses BeginOcclusionQuery. */
 	UFUNCTION(BlueprintCallable)
 	TArray<float> DoOcclusionCollisionQuery(const FVector& Location);
 
@@ -137,40 +234,58 @@ protected:
 
 private:
 	/** Begins a temporal geometry query. */
-	void BeginTemporalGeometryQuery();
+	void BeginTemporalGeometryQuery(const FVector& Location);
 
-	/** Performs a single temporal geometry query frame. */
+	/** Issues the traces of the geometry query in order of priority, until the budget for this frame is spent. */
 	void UpdateGeometryQuery();
 
-	/** Resets the geometry trace result array. */
-	void ResetGeometryQueryResults();
-	
-	/** Populate a TArray of FAzimuthVector with vectors representing points on a circle that are rotated and adjusted in elevation.
-	* @param Array The TArray that will be populated.
-	* @param Rotation The rotation applied to the vectors.
-	* @param Radius The radius of the circle.
-	* @param NumPoints The number of points to generate on the circle.
-	* @param TemporalFrames The number of frames over which to distribute the generated points.
-	* @param PitchIncrement The increment applied to the pitch angle at each step.
-	* @param PitchOffset The offset applied to the pitch angle. */
-	static void PopulateGeometryTraceVectors(TArray<FVector>& Array, const FRotator& Rotation, const float Radius,
-		const float NumPoints, const uint8 TemporalFrames, const float PitchIncrement, const float PitchOffset);
+	/** Finishes the temporal geometry query once all its traces have completed. */
+	void FinishGeometryQuery();
+
+	/** Sorts the geometry trace vectors so that the directions facing into the wind are refined first. */
+	void UpdateGeometryTraceOrder();
+
+	/** Issues the occlusion traces as asynchronous traces. EventOnOcclusionPoll is called when all of them have completed.
+	 *	If an occlusion query is still pending, the new query is issued after it completes. */
+	void BeginOcclusionQuery(const FVector& Location);
+
+	/** Rebuilds the trace params if the pawn to ignore has changed.
+	 *	Traces only hit movable objects if the baked exposure is being corrected for dynamic objects. */
+	void UpdateTraceParams(const bool IsDynamicOnly);
+
+	/** Finds the first player controller and starts listening to its possession changes. Does nothing if there is no player controller yet. */
+	void BindPlayerController();
 
+	UFUNCTION()
+	void HandlePossessedPawnChanged(APawn* OldPawn, APawn* NewPawn);
+
+	/** Samples the wind exposure volumes at a location. Returns false if no baked volume contains the location. */
+	bool SampleWindExposureVolumes(const FVector& Location);
+
+	/** Fires the poll events from the baked exposure, without performing any traces.
+	 *	The events are only fired if the baked exposure or the wind direction has changed since they were last fired. */
+	void BroadcastBakedExposure();
+
+	/** Returns the baked open distance in the cardinal direction of a geometry trace. */
+	float GetBakedOpenDistance(const int32 TraceIndex) const;
+
+	void HandleGeometryTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+	void HandleOcclusionTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+	
 	/** Sorts the geometry trace vector array depending on yaw.
 	 *	This way, we can easily access all vectors in a certain direction by index.*/
 	static void SortTraceVectorsByYaw(TArray<TPair<FVector, double>>& TraceVectors);
 
-	/** Populates the occlusion trace vector arrays. */
-	static void PopulateOcclusionTraceVectors(TArray<FVector>& ArrayA, TArray<FVector>& ArrayB, const FRotator& Rotation, const float TraceLength, const float Spacing);
 
 protected:
 	/** Called when a poll is performed. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Events", Meta = (DisplayName = "On Occlusion Poll"))
 	void EventOnOcclusionPoll(const TArray<float>& OcclusionTraceResults);
 
-	/** Called when a temporal geometry query is completed.*/
+	/** Called when a temporal geometry query is completed.
+	 *	@TraceDistances The distance to the nearest geometry along every geometry trace vector. */
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Events", Meta = (DisplayName = "On Temporal Geometry Query Finished"))
-	void EventOnGeometryQueryFinished(const TArray<FHitResult>& GeometryTraceResults);
+	void EventOnGeometryQueryFinished(const TArray<float>& TraceDistances);
 
 	/** Called when the wind direction is updated. */
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Events", Meta = (DisplayName = "On Wind Direction Changed"))
@@ -185,11 +300,10 @@ public:
 	UFUNCTION(BlueprintGetter, Category = "Temporal Geometry Query")
 	FORCEINLINE bool GetIsQueryingGeometry() const { return IsQueryingGeometry; }
 
-	/** Returns an array of hit results from the most recent geometry query.
-	 *	Be careful when calling this function while the component is performing a temporal query,
-	 *	as this means that the array is not fully populated yet. In this case, we return an empty array. */
+	/** Returns the distance to the nearest geometry along every geometry trace vector.
+	 *	While the component is performing a temporal query, some of the distances are still those of the previous query. */
 	UFUNCTION(BlueprintPure, Category = "Temporal Geometry Query")
-	TArray<FHitResult> GetGeometryQueryResults() const;
+	FORCEINLINE const TArray<float>& GetGeometryTraceDistances() const { return GeometryTraceDistances; }
 
 
 
@@ -0,0 +1,142 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WindExposureVolume.generated.h"
+
+class UBoxComponent;
+class UExteriorWindAudioComponent;
+
+/** The amount of wind direction buckets that occlusion is baked for. The buckets are spread evenly over the yaw of the wind direction. */
+static constexpr int32 WindExposureDirectionCount {8};
+
+/** A single baked sample of a wind exposure volume. Distances are stored as a fraction of the trace length of the volume. */
+USTRUCT()
+struct FWindExposureSample
+{
+	GENERATED_BODY()
+
+	/** The average open distance in the north, east, south and west direction. */
+	UPROPERTY()
+	uint8 OpenDistances[4] {0, 0, 0, 0};
+
+	/** The average occlusion trace length for every wind direction bucket. */
+	UPROPERTY()
+	uint8 OcclusionDistances[WindExposureDirectionCount] {0, 0, 0, 0, 0, 0, 0, 0};
+
+	bool operator==(const FWindExposureSample& Other) const
+	{
+		return FMemory::Memcmp(this, &Other, sizeof(FWindExposureSample)) == 0;
+	}
+};
+
+/** The wind exposure at a location, interpolated from the baked samples around it. */
+struct FWindExposure
+{
+	/** The average open distance in the north, east, south and west direction. */
+	float OpenDistances[4] {0.0f, 0.0f, 0.0f, 0.0f};
+
+	/** The average occlusion trace length for every wind direction bucket. */
+	float OcclusionDistances[WindExposureDirectionCount] {};
+
+	/** Returns the average occlusion trace length for a wind direction, interpolated between the two nearest buckets. */
+	float GetOcclusionDistance(const float WindYaw) const;
+
+	bool operator==(const FWindExposure& Other) const
+	{
+		return FMemory::Memcmp(this, &Other, sizeof(FWindExposure)) == 0;
+	}
+};
+
+/** Axis aligned sparse 3D grid that stores how exposed every location in it is to the wind.
+ *	The grid is baked in the editor with the same traces the exterior wind audio component performs, so it only captures static geometry.
+ *	Samples are grouped in bricks of 4x4x4. A brick in which every sample is the same is stored as a single sample,
+ *	which keeps open air and enclosed interiors nearly free. */
+UCLASS(Blueprintable, BlueprintType, ClassGroup = "Audio", Meta = (DisplayName = "Wind Exposure Volume"))
+class STORMWATCH_API AWindExposureVolume : public AActor
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogWindExposureVolume, Log, All)
+
+protected:
+	/** The area that is covered by the grid. Rotation is ignored. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Components")
+	UBoxComponent* Bounds;
+
+	/** The distance between two samples. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Wind Exposure", Meta = (DisplayName = "Cell Size", Units = "Centimeters",
+		ClampMin = "50", ClampMax = "2000", UIMin = "50", UIMax = "2000"))
+	float CellSize {400.0f};
+
+	/** The length of the traces used for baking. Should match the collision trace length of the exterior wind audio component. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Wind Exposure", Meta = (DisplayName = "Trace Length", Units = "Centimeters",
+		ClampMin = "100", UIMin = "100", UIMax = "10000"))
+	float TraceLength {3000.0f};
+
+	/** The exterior wind audio component class whose trace pattern is baked. If not set, the pattern of the native class is used. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Wind Exposure", Meta = (DisplayName = "Wind Audio Component Class"))
+	TSubclassOf<UExteriorWindAudioComponent> WindAudioComponentClass;
+
+private:
+	/** The world space corner of the grid with the lowest coordinates at the time of baking. */
+	UPROPERTY()
+	FVector Origin {FVector::ZeroVector};
+
+	/** The amount of samples along each axis. */
+	UPROPERTY()
+	FIntVector SampleCount {FIntVector::ZeroValue};
+
+	/** The amount of bricks along each axis. */
+	UPROPERTY()
+	FIntVector BrickCount {FIntVector::ZeroValue};
+
+	/** One entry per brick. A positive value is the offset of the 64 samples of the brick in Samples.
+	 *	A negative value means that the brick is uniform, and that its single sample is stored at index -Value - 1. */
+	UPROPERTY()
+	TArray<int32> Bricks;
+
+	UPROPERTY()
+	TArray<FWindExposureSample> Samples;
+
+	/** The cell size and trace length that the samples were baked with. */
+	UPROPERTY()
+	float BakedCellSize {0.0f};
+
+	UPROPERTY()
+	float BakedTraceLength {0.0f};
+
+public:
+	AWindExposureVolume();
+
+	/** Samples the wind exposure at a location with trilinear interpolation.
+	 *	@Return True if the location is inside the baked grid. */
+	bool Sample(const FVector& Location, FWindExposure& OutExposure) const;
+
+	/** Returns whether the grid contains baked data. */
+	FORCEINLINE bool IsBaked() const { return !Bricks.IsEmpty(); }
+
+#if WITH_EDITOR
+	/** Bakes the wind exposure of the static geometry inside the bounds into the grid. */
+	UFUNCTION(CallInEditor, Category = "Wind Exposure")
+	void BakeWindExposure();
+
+	/** Clears all baked data. */
+	UFUNCTION(CallInEditor, Category = "Wind Exposure")
+	void ClearWindExposure();
+#endif
+
+private:
+	/** Returns the baked sample at a sample coordinate. The coordinate must be inside the grid. */
+	const FWindExposureSample& GetSample(const int32 X, const int32 Y, const int32 Z) const;
+
+#if WITH_EDITOR
+	/** Traces the exposure at a single location. */
+	FWindExposureSample BakeSample(const UWorld* World, const FVector& Location, const TArray<FVector>& GeometryTraceVectors,
+		const TArray<FVector> (&OcclusionTraceStarts)[WindExposureDirectionCount], const TArray<FVector> (&OcclusionTraceEnds)[WindExposureDirectionCount],
+		const FCollisionQueryParams& Params) const;
+#endif
+};
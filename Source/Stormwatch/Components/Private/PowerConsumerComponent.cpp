@@ -19,6 +19,16 @@ void UPowerConsumerComponent::BeginPlay()
 	}
 }
 
+void UPowerConsumerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (APowerSource* ResolvedPowerSource = PowerSource.Get())
+	{
+		ResolvedPowerSource->UnregisterPowerConsumer(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 bool UPowerConsumerComponent::SetPowerState_Implementation(const bool NewPowerState, const AActor* Initiator)
 {
 	if (IsPowered != NewPowerState)
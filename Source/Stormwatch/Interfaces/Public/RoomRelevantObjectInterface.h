@@ -0,0 +1,29 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "RoomRelevantObjectInterface.generated.h"
+
+UINTERFACE(Blueprintable, Meta = (DisplayName = "Room Relevant Object Interface",
+	ShortToolTip = "Interface for objects that are suspended when the player is too far away from their room."))
+class URoomRelevantObject : public UInterface
+{
+	GENERATED_BODY()
+};
+
+class IRoomRelevantObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Called after the ticks and hit notifications of the object have been suspended. Pause any active timers here. */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Room Relevant Object")
+	void OnRoomSuspended();
+
+	/** Called after the ticks and hit notifications of the object have been resumed. Unpause any paused timers here. */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Room Relevant Object")
+	void OnRoomResumed();
+};
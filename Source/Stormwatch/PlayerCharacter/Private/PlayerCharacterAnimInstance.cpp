@@ -5,6 +5,8 @@
 #include "PlayerCharacter.h"
 #include "PlayerCharacterController.h"
 #include "PlayerCharacterMovementComponent.h"
+#include "StepSurfaceGrid.h"
+#include "EngineUtils.h"
 
 #include "KismetAnimationLibrary.h"
 
@@ -23,33 +25,58 @@ void UPlayerCharacterAnimInstance::NativeBeginPlay()
 	{
 		PlayerCharacter = Cast<APlayerCharacter>(GetSkelMeshComponent()->GetOwner());
 	}
+
+	StepTraceParams = FCollisionQueryParams(SCENE_QUERY_STAT(PlayerStepTrace), false, GetOwningActor());
+	StepTraceParams.bReturnPhysicalMaterial = true;
+	StepTraceDelegate.BindUObject(this, &UPlayerCharacterAnimInstance::HandleStepTraceCompleted);
+
+	StepSurfaceGrids.Empty();
+	if (UWorld* World {GetWorld()})
+	{
+		for (TActorIterator<AStepSurfaceGrid> It(World); It; ++It)
+		{
+			if (It->IsBaked())
+			{
+				StepSurfaceGrids.Add(*It);
+			}
+		}
+	}
 	Super::NativeBeginPlay();
 }
 
 void UPlayerCharacterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 {
+	Snapshot.IsValid = false;
 	if (PlayerCharacter)
 	{
 		const APlayerCharacterController* Controller {PlayerCharacter->GetPlayerCharacterController()};
 		const UPlayerCharacterMovementComponent* CharacterMovement {PlayerCharacter->GetPlayerCharacterMovement()};
 		if (Controller && CharacterMovement)
 		{
-			CheckMovementState(*PlayerCharacter, *Controller, *CharacterMovement);
-			
+			UpdateSnapshot(*PlayerCharacter, *Controller, *CharacterMovement);
 		}
+	}
+	Super::NativeUpdateAnimation(DeltaSeconds);
+}
 
-		Direction = GetDirection(*PlayerCharacter);
-		Speed = GetSpeed(*PlayerCharacter, *CharacterMovement);
+void UPlayerCharacterAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	if (Snapshot.IsValid)
+	{
+		CheckMovementState(Snapshot);
+
+		Direction = GetDirection(Snapshot);
+		Speed = GetSpeed(Snapshot);
 
 		/** Reset fall timer if the player is no longer falling. */
-		if (IsFalling ^ CharacterMovement->IsFalling() && !IsFalling)
+		if (IsFalling ^ Snapshot.IsFalling && !IsFalling)
 		{
 			FallTime = 0.0f;
 		}
 
 		/** Check whether the player is falling. */
-		IsFalling = CharacterMovement->IsFalling();
-		IsAirborne = CharacterMovement->IsFalling() || CharacterMovement->GetIsJumping();
+		IsFalling = Snapshot.IsFalling;
+		IsAirborne = Snapshot.IsFalling || Snapshot.IsJumping;
 
 		/** Update fall time if the player is falling. */
 		if (IsFalling)
@@ -57,9 +84,25 @@ void UPlayerCharacterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 			UpdateFallTime(DeltaSeconds);
 		}
 		
-		CheckTurnInplaceConditions(*PlayerCharacter);
+		CheckTurnInplaceConditions(Snapshot);
 	}
-	Super::NativeUpdateAnimation(DeltaSeconds);
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+}
+
+/** Copy the state that is only safe to access on the game thread. Controller input and the movement component are not thread safe. */
+void UPlayerCharacterAnimInstance::UpdateSnapshot(const APlayerCharacter& Character, const APlayerCharacterController& Controller, const UPlayerCharacterMovementComponent& CharacterMovement)
+{
+	Snapshot.Velocity = Character.GetVelocity();
+	Snapshot.Rotation = Character.GetActorRotation();
+	Snapshot.LastInputVector = CharacterMovement.GetLastInputVector();
+	Snapshot.YawDelta = Character.GetYawDelta();
+	Snapshot.HasMovementInput = Controller.GetHasMovementInput();
+	Snapshot.IsMovingOnGround = CharacterMovement.IsMovingOnGround();
+	Snapshot.IsFalling = CharacterMovement.IsFalling();
+	Snapshot.IsJumping = CharacterMovement.GetIsJumping();
+	Snapshot.IsCrouching = CharacterMovement.IsCrouching();
+	Snapshot.IsTurningInPlace = Character.GetIsTurningInPlace();
+	Snapshot.IsValid = true;
 }
 
 void UPlayerCharacterAnimInstance::GetStepData(FStepData& StepData, const FVector Location)
@@ -70,20 +113,98 @@ void UPlayerCharacterAnimInstance::GetStepData(FStepData& StepData, const FVecto
 	{
 		StepData.Velocity = GetSkelMeshComponent()->GetOwner()->GetVelocity().Length();
 	}
+
+	if (SampleStepSurfaceGrids(StepData, Location)) { return; }
 		
 	FHitResult HitResult;
 	FVector TraceStart = Location;
 	FVector TraceEnd = Location - FVector(0, 0, 50);
-	FCollisionQueryParams Params;
-	Params.AddIgnoredActor(GetOwningActor());
-	Params.bTraceComplex = false;
-	Params.bReturnPhysicalMaterial = true;
 
-	if (GetWorld() && GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, Params))
+	if (GetWorld() && GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, StepTraceParams))
+	{
+		StepData.Object = HitResult.GetActor();
+		StepData.PhysicalMaterial = HitResult.PhysMaterial.Get();
+	}
+}
+
+bool UPlayerCharacterAnimInstance::SampleStepSurfaceGrids(FStepData& StepData, const FVector& Location) const
+{
+	/** The grids only contain static geometry. If the character stands on something that can move, it may cover a baked cell,
+	 *	so the step falls back to a trace. */
+	if (const UPlayerCharacterMovementComponent* CharacterMovement {PlayerCharacter ? PlayerCharacter->GetPlayerCharacterMovement() : nullptr})
+	{
+		const UPrimitiveComponent* FloorComponent {CharacterMovement->CurrentFloor.HitResult.GetComponent()};
+		if (CharacterMovement->CurrentFloor.IsWalkableFloor() && FloorComponent && FloorComponent->Mobility != EComponentMobility::Static) { return false; }
+	}
+
+	for (const TWeakObjectPtr<AStepSurfaceGrid>& Grid : StepSurfaceGrids)
+	{
+		UPhysicalMaterial* PhysicalMaterial {nullptr};
+		AActor* Object {nullptr};
+		if (Grid.IsValid() && Grid->Sample(Location, PhysicalMaterial, Object))
+		{
+			StepData.PhysicalMaterial = PhysicalMaterial;
+			StepData.Object = Object;
+			return true;
+		}
+	}
+	return false;
+}
+
+void UPlayerCharacterAnimInstance::RequestStep(const FVector& Location, const bool IsHandstep)
+{
+	FStepData StepData {FStepData()};
+	StepData.Location = Location;
+	if (const AActor* Owner {GetOwningActor()})
+	{
+		StepData.Velocity = Owner->GetVelocity().Length();
+	}
+
+	if (SampleStepSurfaceGrids(StepData, Location))
+	{
+		if (IsHandstep)
+		{
+			OnHandstep.Broadcast(StepData);
+		}
+		else
+		{
+			OnFootstep.Broadcast(StepData);
+		}
+		return;
+	}
+
+	/** The surface is not baked, so it is likely a dynamic object. The step is broadcast once the trace completes. */
+	if (UWorld* World {GetWorld()})
+	{
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Location, Location - FVector(0, 0, 50), ECC_Visibility,
+			StepTraceParams, FCollisionResponseParams::DefaultResponseParam, &StepTraceDelegate, IsHandstep ? 1 : 0);
+	}
+}
+
+void UPlayerCharacterAnimInstance::HandleStepTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	FStepData StepData {FStepData()};
+	StepData.Location = TraceDatum.Start;
+	if (const AActor* Owner {GetOwningActor()})
+	{
+		StepData.Velocity = Owner->GetVelocity().Length();
+	}
+
+	if (!TraceDatum.OutHits.IsEmpty())
 	{
+		const FHitResult& HitResult {TraceDatum.OutHits[0]};
 		StepData.Object = HitResult.GetActor();
 		StepData.PhysicalMaterial = HitResult.PhysMaterial.Get();
 	}
+
+	if (TraceDatum.UserData == 1)
+	{
+		OnHandstep.Broadcast(StepData);
+	}
+	else
+	{
+		OnFootstep.Broadcast(StepData);
+	}
 }
 
 FStepData UPlayerCharacterAnimInstance::GetFootstepData(const ELeftRight Foot)
@@ -110,23 +231,41 @@ FStepData UPlayerCharacterAnimInstance::GetHandstepData(const ELeftRight Hand)
 	return StepData;
 }
 
+void UPlayerCharacterAnimInstance::RequestFootstep(const ELeftRight Foot)
+{
+	const FName Socket {Foot == ELeftRight::Left ? "foot_l_socket" : "foot_r_socket"};
+	if (GetSkelMeshComponent())
+	{
+		RequestStep(GetSkelMeshComponent()->GetSocketLocation(Socket), false);
+	}
+}
+
+void UPlayerCharacterAnimInstance::RequestHandstep(const ELeftRight Hand)
+{
+	const FName Socket {Hand == ELeftRight::Left ? "hand_l_socket" : "hand_r_socket"};
+	if (GetSkelMeshComponent())
+	{
+		RequestStep(GetSkelMeshComponent()->GetSocketLocation(Socket), true);
+	}
+}
+
 /** Check the movement state of the player character, and update animation variables accordingly. */
-void UPlayerCharacterAnimInstance::CheckMovementState(const APlayerCharacter& Character, const APlayerCharacterController& Controller, const UPlayerCharacterMovementComponent& CharacterMovement)
+void UPlayerCharacterAnimInstance::CheckMovementState(const FPlayerCharacterAnimSnapshot& State)
 {
-	IsMovementPending = Controller.GetHasMovementInput();
-	IsMoving = IsMovementPending && (CharacterMovement.IsMovingOnGround() || CharacterMovement.IsFalling());
-	IsCrouching = CharacterMovement.IsCrouching();
+	IsMovementPending = State.HasMovementInput;
+	IsMoving = IsMovementPending && (State.IsMovingOnGround || State.IsFalling);
+	IsCrouching = State.IsCrouching;
 
 	DoSprintSop = !IsMovementPending && Speed > 275 && (Direction >= -20 && Direction <= 20);
 }
 
 /** Check if the player character is turning in place, and update animation variables accordingly. */
-void UPlayerCharacterAnimInstance::CheckTurnInplaceConditions(const APlayerCharacter& Character)
+void UPlayerCharacterAnimInstance::CheckTurnInplaceConditions(const FPlayerCharacterAnimSnapshot& State)
 {
-	if (Character.GetIsTurningInPlace())
+	if (State.IsTurningInPlace)
 	{
 		/** Determine which direction the character is turning. */
-		if (Character.GetYawDelta() > 0)
+		if (State.YawDelta > 0)
 		{
 			IsTurningRight = true;
 			IsTurningLeft = false;
@@ -136,7 +275,7 @@ void UPlayerCharacterAnimInstance::CheckTurnInplaceConditions(const APlayerChara
 			IsTurningRight = false;
 			IsTurningLeft = true;
 		}
-		TurnSpeed = FMath::Clamp(0.1f * abs(Character.GetYawDelta()), 0.0f, 1.0f);
+		TurnSpeed = FMath::Clamp(0.1f * abs(State.YawDelta), 0.0f, 1.0f);
 	}
 	else
 	{
@@ -147,18 +286,18 @@ void UPlayerCharacterAnimInstance::CheckTurnInplaceConditions(const APlayerChara
 }
 
 /** Get the character's movement direction. */
-float UPlayerCharacterAnimInstance::GetDirection(const APlayerCharacter& Character)
+float UPlayerCharacterAnimInstance::GetDirection(const FPlayerCharacterAnimSnapshot& State)
 {
-	const float UnmappedDirection {UKismetAnimationLibrary::CalculateDirection(Character.GetVelocity(), Character.GetActorRotation())};
+	const float UnmappedDirection {UKismetAnimationLibrary::CalculateDirection(State.Velocity, State.Rotation)};
 	return FMath::GetMappedRangeValueClamped(FVector2D(-171.5, 171.5), FVector2D(-180, 180), UnmappedDirection);
 }
 
 /** Get the character's speed based on its movement input vector.*/
-float UPlayerCharacterAnimInstance::GetSpeed(const APlayerCharacter& Character, const UPlayerCharacterMovementComponent& CharacterMovement)
+float UPlayerCharacterAnimInstance::GetSpeed(const FPlayerCharacterAnimSnapshot& State)
 {
-	if (!CharacterMovement.GetLastInputVector().IsNearlyZero())
+	if (!State.LastInputVector.IsNearlyZero())
 	{
-		return Character.GetVelocity().Size2D();
+		return State.Velocity.Size2D();
 	}
 	return 0.0f;
 }
@@ -5,6 +5,7 @@
 
 #include "InventoryObjectInterface.h"
 #include "PlayerInteractionComponent.h"
+#include "Components/PrimitiveComponent.h"
 
 
 UPlayerInventoryComponent::UPlayerInventoryComponent()
@@ -21,6 +22,7 @@ void UPlayerInventoryComponent::OnComponentCreated()
 	{
 		Hotbar.Add(nullptr);
 	}
+	HotbarDormancy.SetNum(Hotbar.Num());
 }
 
 void UPlayerInventoryComponent::BeginPlay()
@@ -56,36 +58,31 @@ bool UPlayerInventoryComponent::AddActorToInventory(AActor* Actor)
 	 *	This can be the actor itself, or a component registered to the actor. */
 	if (UObject* InventoryObject {FindInventoryObject(Actor)})
 	{
-		UE_LOG(LogTemp, Warning, TEXT("This Worked!"))
 		if (!IInventoryObject::Execute_CanAddToInventory(InventoryObject, GetOwner())) {return false; }
 		
 		/** If the current hotbar slot is already filled, iterate through the array to try and find an empty slot that can fit the actor. */
-		if (SelectedActor)
+		int32 SlotIndex {SelectedSlot};
+		if (!IsSlotEmpty(SlotIndex))
 		{
-			int32 EmptySlotIndex {-1};
-			for (int32 i {0}; i < Hotbar.Num(); ++i)
+			SlotIndex = INDEX_NONE;
+			for (int32 Index {0}; Index < Hotbar.Num(); ++Index)
 			{
-				if (!Hotbar[i])
+				if (IsSlotEmpty(Index))
 				{
-					EmptySlotIndex = i;
-					Hotbar[i] = Actor;
+					SlotIndex = Index;
 					break;
 				}
 			}
-			if (EmptySlotIndex >= 0)
-			{
-				Hotbar[EmptySlotIndex] = Actor;
-			}
-			else
+			if (SlotIndex == INDEX_NONE)
 			{
 				return false;
 			}
 		}
-		else
-		{
-			Hotbar[SelectedSlot] = Actor;
-		}
+		Hotbar[SlotIndex] = Actor;
 		IInventoryObject::Execute_AddToInventory(InventoryObject, GetOwner());
+
+		/** The actor is made dormant after the inventory object has handled the event, so that we restore whatever state it left the actor in. */
+		MakeActorDormant(Actor, HotbarDormancy[SlotIndex]);
 		return true;
 	}
 	return false;
@@ -93,12 +90,13 @@ bool UPlayerInventoryComponent::AddActorToInventory(AActor* Actor)
 
 AActor* UPlayerInventoryComponent::TakeActorFromInventory()
 {
-	if(SelectedActor)
+	if (AActor* SelectedActor {GetCurrentSelectedSlotActor()})
 	{
 		if (UObject* InventoryObject {FindInventoryObject(SelectedActor)})
 		{
 			AActor* TakenActor {SelectedActor};
 			Hotbar[SelectedSlot] = nullptr;
+			RestoreActorFromDormancy(TakenActor, HotbarDormancy[SelectedSlot]);
 
 			//if (const AActor* Owner {GetOwner()})
 			//{
@@ -113,6 +111,17 @@ AActor* UPlayerInventoryComponent::TakeActorFromInventory()
 	return nullptr;
 }
 
+bool UPlayerInventoryComponent::IsSlotEmpty(const int32 SlotIndex)
+{
+	if (!Hotbar.IsValidIndex(SlotIndex) || !HotbarDormancy.IsValidIndex(SlotIndex)) { return false; }
+	if (IsValid(Hotbar[SlotIndex])) { return false; }
+
+	/** The stored actor can be destroyed while it is dormant, for example when its level is unloaded, which frees up the slot. */
+	Hotbar[SlotIndex] = nullptr;
+	HotbarDormancy[SlotIndex] = FInventoryDormancyState();
+	return true;
+}
+
 UActorComponent* UPlayerInventoryComponent::FindInventoryComponent(const AActor* Actor) const
 {
 	if (!Actor) { return nullptr; }
@@ -128,6 +137,86 @@ UActorComponent* UPlayerInventoryComponent::FindInventoryComponent(const AActor*
 	return nullptr;
 }
 
+void UPlayerInventoryComponent::MakeActorDormant(AActor* Actor, FInventoryDormancyState& OutState)
+{
+	if (!Actor || OutState.IsDormant) { return; }
+
+	OutState.IsActorTickEnabled = Actor->IsActorTickEnabled();
+	OutState.IsActorHidden = Actor->IsHidden();
+	OutState.IsActorCollisionEnabled = Actor->GetActorEnableCollision();
+
+	TInlineComponentArray<UActorComponent*> Components;
+	Actor->GetComponents(Components);
+
+	OutState.Components.Reset(Components.Num());
+	for (UActorComponent* Component : Components)
+	{
+		FInventoryComponentDormancyState& ComponentState {OutState.Components.AddDefaulted_GetRef()};
+		ComponentState.Component = Component;
+		if (Component->IsComponentTickEnabled())
+		{
+			ComponentState.Flags |= EInventoryDormancyFlags::TickEnabled;
+		}
+		Component->SetComponentTickEnabled(false);
+
+		if (UPrimitiveComponent* Primitive {Cast<UPrimitiveComponent>(Component)})
+		{
+			if (Primitive->IsSimulatingPhysics())
+			{
+				ComponentState.Flags |= EInventoryDormancyFlags::SimulatingPhysics;
+			}
+			if (Primitive->BodyInstance.bNotifyRigidBodyCollision)
+			{
+				ComponentState.Flags |= EInventoryDormancyFlags::NotifyRigidBodyCollision;
+			}
+			if (Primitive->GetGenerateOverlapEvents())
+			{
+				ComponentState.Flags |= EInventoryDormancyFlags::GenerateOverlapEvents;
+			}
+			ComponentState.CollisionEnabled = Primitive->GetCollisionEnabled();
+
+			/** Disabling hit notifications also silences any Reacoustic, damage or collision trigger listeners bound to this component. */
+			Primitive->SetSimulatePhysics(false);
+			Primitive->SetNotifyRigidBodyCollision(false);
+			Primitive->SetGenerateOverlapEvents(false);
+			Primitive->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		}
+	}
+
+	Actor->SetActorTickEnabled(false);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorHiddenInGame(true);
+
+	OutState.IsDormant = true;
+}
+
+void UPlayerInventoryComponent::RestoreActorFromDormancy(AActor* Actor, FInventoryDormancyState& State)
+{
+	if (!Actor || !State.IsDormant) { return; }
+
+	Actor->SetActorHiddenInGame(State.IsActorHidden);
+	Actor->SetActorEnableCollision(State.IsActorCollisionEnabled);
+	Actor->SetActorTickEnabled(State.IsActorTickEnabled);
+
+	for (const FInventoryComponentDormancyState& ComponentState : State.Components)
+	{
+		UActorComponent* Component {ComponentState.Component.Get()};
+		if (!Component) { continue; }
+
+		if (UPrimitiveComponent* Primitive {Cast<UPrimitiveComponent>(Component)})
+		{
+			/** Collision has to be restored before physics simulation can be enabled again. */
+			Primitive->SetCollisionEnabled(ComponentState.CollisionEnabled);
+			Primitive->SetGenerateOverlapEvents(EnumHasAnyFlags(ComponentState.Flags, EInventoryDormancyFlags::GenerateOverlapEvents));
+			Primitive->SetNotifyRigidBodyCollision(EnumHasAnyFlags(ComponentState.Flags, EInventoryDormancyFlags::NotifyRigidBodyCollision));
+			Primitive->SetSimulatePhysics(EnumHasAnyFlags(ComponentState.Flags, EInventoryDormancyFlags::SimulatingPhysics));
+		}
+		Component->SetComponentTickEnabled(EnumHasAnyFlags(ComponentState.Flags, EInventoryDormancyFlags::TickEnabled));
+	}
+
+	State.Components.Empty();
+	State.IsDormant = false;
+}
 
 void UPlayerInventoryComponent::HandleInteractableActorChanged(AActor* InteractableActor)
 {
@@ -2,6 +2,7 @@
 // Written by Tim Verberne.
 
 #include "PlayerStateComponent.h"
+#include "Algo/AnyOf.h"
 
 void UPlayerStateComponent::OnComponentCreated()
 {
@@ -15,162 +16,236 @@ void UPlayerStateComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	/** Start updating the player state. */
-	if (GetWorld())
+	/** State values are evaluated lazily from their rate, so there is no recurring update. */
+	const double Time {GetStateTime()};
+	for (FPlayerStateValueTrack& Track : Values)
 	{
-		GetWorld()->GetTimerManager().SetTimer(StateTimer, this, &UPlayerStateComponent::UpdatePlayerState, 1.0f, true);	
+		Track.Timestamp = Time;
 	}
-}
-
-void UPlayerStateComponent::ResetPlayerState()
-{
-	Pain = 100.0f;
-	Exertion = 0.0f;
-	Fear = 0.0f;
-	Vigilance = 0.0f;
-}
-
-float UPlayerStateComponent::IncrementValue(float& Property, float Value)
-{
-	Value = FMath::Clamp(Value, 0, 100);
-	if (Property + Value > 100)
+	
+	if (Configuration)
 	{
-		Property = 100;
+		SetStateValueRate(EPlayerStateValue::Pain, Configuration->PainReductionAmount);
+		SetStateValueRate(EPlayerStateValue::Exertion, -Configuration->ExertionReductionAmount);
 	}
-	else
+
+	/** Blueprints that still apply their own decay in On Update keep their one second heartbeat, but only while no native rate is set,
+	 *	so that a value never decays twice. */
+	const bool HasNativeRate {Algo::AnyOf(Values, [](const FPlayerStateValueTrack& Track) { return Track.Rate != 0.0f; })};
+	const bool IsOnUpdateImplemented {GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UPlayerStateComponent, EventOnUpdate))};
+	if (IsOnUpdateImplemented && !HasNativeRate)
 	{
-		Property += Value;
+		if (UWorld* World {GetWorld()})
+		{
+			World->GetTimerManager().SetTimer(UpdateTimer, this, &UPlayerStateComponent::EventOnUpdate, 1.0f, true);
+		}
 	}
-	return Property;
 }
 
-float UPlayerStateComponent::DecrementValue(float& Property, float Value)
+void UPlayerStateComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Value = FMath::Clamp(Value, 0, 100);
-	if (Property < Value)
+	Super::EndPlay(EndPlayReason);
+
+	if (const UWorld* World {GetWorld()})
 	{
-		Property = 0;
+		World->GetTimerManager().ClearAllTimersForObject(this);
 	}
-	else
+	StateTimer.Invalidate();
+	UpdateTimer.Invalidate();
+}
+
+void UPlayerStateComponent::ResetPlayerState()
+{
+	SetStateValue(EPlayerStateValue::Pain, 100.0f);
+	SetStateValue(EPlayerStateValue::Exertion, 0.0f);
+	SetStateValue(EPlayerStateValue::Fear, 0.0f);
+	SetStateValue(EPlayerStateValue::Vigilence, 0.0f);
+}
+
+double UPlayerStateComponent::GetStateTime() const
+{
+	if (const UWorld* World {GetWorld()})
 	{
-		Property -= Value;
+		return World->GetTimeSeconds();
 	}
-	return Property;
+	return 0.0;
 }
 
-float UPlayerStateComponent::SetValue(float& Property, float Value)
+float UPlayerStateComponent::ApplyDelta(const EPlayerStateValue Type, const float Delta)
 {
-	Value = FMath::Clamp(Value, 0, 100);
-	Property = Value;
-	return Property;
+	FPlayerStateValueTrack& Track {Values[static_cast<uint8>(Type)]};
+	Track.Rebase(GetStateTime());
+	Track.Value = FMath::Clamp(Track.Value + Delta, 0.0f, 100.0f);
+
+	MarkStateValueChanged(Type);
+	UpdateThresholds();
+	return Track.Value;
 }
 
 float UPlayerStateComponent::IncrementStateValue(const EPlayerStateValue Type, const float Value)
 {
-	switch(Type)
-	{
-	case EPlayerStateValue::Pain:
-		if (Value <= 0.0f) {return Pain; }
-		IncrementValue(Pain, Value);
-		OnPainChanged.Broadcast(Pain);
-		return Pain;
-		
-	case EPlayerStateValue::Exertion:
-		if (Value <= 0.0f) {return Exertion; }
-		IncrementValue(Exertion, Value);
-		OnExertionChanged.Broadcast(Exertion);
-		return Exertion;
-		
-	case EPlayerStateValue::Fear:
-		if (Value <= 0.0f) {return Fear; }
-		IncrementValue(Fear, Value);
-		OnFearChanged.Broadcast(Fear);
-		return Fear;
-		
-	case EPlayerStateValue::Vigilence:
-		if (Value <= 0.0f) {return Vigilance; }
-		IncrementValue(Vigilance, Value);
-		OnVigilanceChanged.Broadcast(Vigilance);
-		return Vigilance;
-	}
-	return 0.0f;
+	if (Value <= 0.0f) { return GetStateValue(Type); }
+	return ApplyDelta(Type, FMath::Min(Value, 100.0f));
 }
 
 float UPlayerStateComponent::DecrementStateValue(const EPlayerStateValue Type, const float Value)
 {
-	switch(Type)
-	{
-	case EPlayerStateValue::Pain:
-		if (Value <= 0.0f) {return Pain; }
-		DecrementValue(Pain, Value);
-		OnPainChanged.Broadcast(Pain);
-		return Pain;
-		
-	case EPlayerStateValue::Exertion:
-		if (Value <= 0.0f) {return Exertion; }
-		DecrementValue(Exertion, Value);
-		OnExertionChanged.Broadcast(Exertion);
-		return Exertion;
-		
-	case EPlayerStateValue::Fear:
-		if (Value <= 0.0f) {return Fear; }
-		DecrementValue(Fear, Value);
-		OnFearChanged.Broadcast(Fear);
-		return Fear;
-		
-	case EPlayerStateValue::Vigilence:
-		if (Value <= 0.0f) {return Vigilance; }
-		DecrementValue(Vigilance, Value);
-		OnVigilanceChanged.Broadcast(Vigilance);
-		return Vigilance;
-	}
-	return 0.0f;
+	if (Value <= 0.0f) { return GetStateValue(Type); }
+	return ApplyDelta(Type, -FMath::Min(Value, 100.0f));
 }
 
 float UPlayerStateComponent::SetStateValue(const EPlayerStateValue Type, const float Value)
 {
-	switch(Type)
+	FPlayerStateValueTrack& Track {Values[static_cast<uint8>(Type)]};
+	Track.Value = FMath::Clamp(Value, 0.0f, 100.0f);
+	Track.Timestamp = GetStateTime();
+
+	MarkStateValueChanged(Type);
+	UpdateThresholds();
+	return Track.Value;
+}
+
+void UPlayerStateComponent::SetStateValueRate(const EPlayerStateValue Type, const float Rate)
+{
+	FPlayerStateValueTrack& Track {Values[static_cast<uint8>(Type)]};
+	if (Track.Rate == Rate) { return; }
+	
+	Track.Rebase(GetStateTime());
+	Track.Rate = Rate;
+	UpdateThresholds();
+}
+
+float UPlayerStateComponent::GetStateValue(const EPlayerStateValue Type) const
+{
+	return Values[static_cast<uint8>(Type)].Evaluate(GetStateTime());
+}
+
+float UPlayerStateComponent::GetStateValueRate(const EPlayerStateValue Type) const
+{
+	return Values[static_cast<uint8>(Type)].Rate;
+}
+
+void UPlayerStateComponent::AddStateThreshold(const EPlayerStateValue Type, const float Threshold)
+{
+	for (const FPlayerStateThreshold& Entry : Thresholds)
 	{
-	case EPlayerStateValue::Pain:
-		SetValue(Pain, Value);
-		OnPainChanged.Broadcast(Pain);
-		return Pain;
-		
-	case EPlayerStateValue::Exertion:
-		SetValue(Exertion, Value);
-		OnExertionChanged.Broadcast(Exertion);
-		return Exertion;
-		
-	case EPlayerStateValue::Fear:
-		SetValue(Fear, Value);
-		OnFearChanged.Broadcast(Fear);
-		return Fear;
-		
-	case EPlayerStateValue::Vigilence:
-		if (Value <= 0.0f) {return Vigilance; }
-		SetValue(Vigilance, Value);
-		OnVigilanceChanged.Broadcast(Vigilance);
-		return Vigilance;
+		if (Entry.Type == Type && Entry.Threshold == Threshold) { return; }
 	}
-	return 0.0f;
+
+	FPlayerStateThreshold& Entry {Thresholds.AddDefaulted_GetRef()};
+	Entry.Type = Type;
+	Entry.Threshold = Threshold;
+	Entry.IsAbove = GetStateValue(Type) >= Threshold;
+
+	UpdateThresholds();
 }
 
-void UPlayerStateComponent::UpdatePlayerState()
+void UPlayerStateComponent::RemoveStateThreshold(const EPlayerStateValue Type, const float Threshold)
 {
-	EventOnUpdate();
+	Thresholds.RemoveAll([Type, Threshold](const FPlayerStateThreshold& Entry)
+	{
+		return Entry.Type == Type && Entry.Threshold == Threshold;
+	});
+
+	UpdateThresholds();
 }
 
-void UPlayerStateComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+void UPlayerStateComponent::MarkStateValueChanged(const EPlayerStateValue Type)
 {
-	Super::EndPlay(EndPlayReason);
+	const bool IsFlushPending {PendingChangeMask != 0 || !PendingCrossings.IsEmpty()};
+	PendingChangeMask |= 1 << static_cast<uint8>(Type);
 
-	/** Stop updating the player state. */
-	StateTimer.Invalidate();
+	if (!IsFlushPending)
+	{
+		if (UWorld* World {GetWorld()})
+		{
+			World->GetTimerManager().SetTimerForNextTick(this, &UPlayerStateComponent::FlushStateChanges);
+		}
+	}
 }
 
-void UPlayerStateComponent::EventOnUpdate_Implementation()
+void UPlayerStateComponent::FlushStateChanges()
 {
+	const uint8 ChangeMask {PendingChangeMask};
+	PendingChangeMask = 0;
+
+	TArray<FPlayerStateThreshold> Crossings {MoveTemp(PendingCrossings)};
+	PendingCrossings.Reset();
+
+	if (ChangeMask & (1 << static_cast<uint8>(EPlayerStateValue::Pain)))
+	{
+		OnPainChanged.Broadcast(GetPain());
+	}
+	if (ChangeMask & (1 << static_cast<uint8>(EPlayerStateValue::Exertion)))
+	{
+		OnExertionChanged.Broadcast(GetExertion());
+	}
+	if (ChangeMask & (1 << static_cast<uint8>(EPlayerStateValue::Fear)))
+	{
+		OnFearChanged.Broadcast(GetFear());
+	}
+	if (ChangeMask & (1 << static_cast<uint8>(EPlayerStateValue::Vigilence)))
+	{
+		OnVigilanceChanged.Broadcast(GetVigilance());
+	}
+
+	for (const FPlayerStateThreshold& Crossing : Crossings)
+	{
+		OnStateThresholdCrossed.Broadcast(Crossing.Type, Crossing.Threshold, Crossing.IsAbove);
+	}
+
+	if (ChangeMask != 0)
+	{
+		OnStateChanged.Broadcast(ChangeMask);
+	}
 }
 
+void UPlayerStateComponent::UpdateThresholds()
+{
+	UWorld* World {GetWorld()};
+	if (!World) { return; }
+
+	const double Time {GetStateTime()};
+	float TimeUntilNextCrossing {TNumericLimits<float>::Max()};
 
-	
+	for (FPlayerStateThreshold& Entry : Thresholds)
+	{
+		const FPlayerStateValueTrack& Track {Values[static_cast<uint8>(Entry.Type)]};
+		const float Value {Track.Evaluate(Time)};
+		const bool IsAbove {Value >= Entry.Threshold};
+
+		if (IsAbove != Entry.IsAbove)
+		{
+			Entry.IsAbove = IsAbove;
+
+			/** Mark the value as changed before queueing the crossing, as a queued crossing counts as a pending flush. */
+			MarkStateValueChanged(Entry.Type);
+			PendingCrossings.Add(Entry);
+		}
+
+		/** Only schedule a crossing if the value is moving towards the threshold, and the threshold lies within the range the value is clamped to. */
+		if (!IsAbove && Track.Rate > 0.0f && Entry.Threshold <= 100.0f)
+		{
+			TimeUntilNextCrossing = FMath::Min(TimeUntilNextCrossing, (Entry.Threshold - Value) / Track.Rate);
+		}
+		else if (IsAbove && Track.Rate < 0.0f && Entry.Threshold > 0.0f)
+		{
+			/** The value is considered below the threshold once it is strictly smaller, so we nudge the time slightly past the crossing. */
+			TimeUntilNextCrossing = FMath::Min(TimeUntilNextCrossing, (Value - Entry.Threshold) / -Track.Rate + KINDA_SMALL_NUMBER);
+		}
+	}
+
+	FTimerManager& TimerManager {World->GetTimerManager()};
+	if (TimeUntilNextCrossing < TNumericLimits<float>::Max())
+	{
+		TimerManager.SetTimer(StateTimer, this, &UPlayerStateComponent::UpdateThresholds, FMath::Max(TimeUntilNextCrossing, KINDA_SMALL_NUMBER), false);
+	}
+	else if (TimerManager.IsTimerActive(StateTimer))
+	{
+		TimerManager.ClearTimer(StateTimer);
+	}
+}
+
+void UPlayerStateComponent::EventOnUpdate_Implementation()
+{
+}
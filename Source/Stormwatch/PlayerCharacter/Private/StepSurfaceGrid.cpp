@@ -0,0 +1,143 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "StepSurfaceGrid.h"
+#include "Components/BoxComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+DEFINE_LOG_CATEGORY_CLASS(AStepSurfaceGrid, LogStepSurfaceGrid);
+
+AStepSurfaceGrid::AStepSurfaceGrid()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Bounds = CreateDefaultSubobject<UBoxComponent>(TEXT("Bounds"));
+	Bounds->SetBoxExtent(FVector(500.0f, 500.0f, 150.0f));
+	Bounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Bounds->SetCanEverAffectNavigation(false);
+	SetRootComponent(Bounds);
+
+	SetActorHiddenInGame(true);
+}
+
+bool AStepSurfaceGrid::Sample(const FVector& Location, UPhysicalMaterial*& OutPhysicalMaterial, AActor*& OutObject) const
+{
+	if (Cells.IsEmpty()) { return false; }
+
+	const int32 X {FMath::FloorToInt32((Location.X - Origin.X) / CellSize)};
+	const int32 Y {FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize)};
+	if (X < 0 || Y < 0 || X >= CellCountX || Y >= CellCountY) { return false; }
+
+	const FStepSurfaceCell& Cell {Cells[Y * CellCountX + X]};
+	if (!Cell.IsStatic) { return false; }
+
+	/** The step has to be above the surface, within the same distance the trace would have covered. */
+	const float HeightAboveSurface {static_cast<float>(Location.Z) - Cell.Height};
+	if (HeightAboveSurface < -1.0f || HeightAboveSurface > MaxStepHeight) { return false; }
+
+	/** The surface object is gone while its level is unloaded, so the step has to be resolved by a trace. */
+	AActor* Object {SurfaceObjects.IsValidIndex(Cell.ObjectIndex) ? SurfaceObjects[Cell.ObjectIndex].Get() : nullptr};
+	if (Cell.ObjectIndex != MAX_uint16 && !Object) { return false; }
+
+	OutPhysicalMaterial = PhysicalMaterials.IsValidIndex(Cell.PhysicalMaterialIndex) ? PhysicalMaterials[Cell.PhysicalMaterialIndex] : nullptr;
+	OutObject = Object;
+	return true;
+}
+
+#if WITH_EDITOR
+void AStepSurfaceGrid::BakeSurfaceGrid()
+{
+	UWorld* World {GetWorld()};
+	if (!World || !Bounds) { return; }
+
+	ClearSurfaceGrid();
+
+	const FVector Center {Bounds->GetComponentLocation()};
+	const FVector Extent {Bounds->GetScaledBoxExtent()};
+
+	Origin = FVector2D(Center.X - Extent.X, Center.Y - Extent.Y);
+	CellCountX = FMath::Max(1, FMath::CeilToInt32(2.0f * Extent.X / CellSize));
+	CellCountY = FMath::Max(1, FMath::CeilToInt32(2.0f * Extent.Y / CellSize));
+
+	/** Guard against accidentally baking a huge area with a tiny cell size. */
+	constexpr int32 MaxCellCount {4 * 1024 * 1024};
+	if (static_cast<int64>(CellCountX) * CellCountY > MaxCellCount)
+	{
+		UE_LOG(LogStepSurfaceGrid, Error, TEXT("Step surface grid '%s' is too large to bake. Increase the cell size or reduce the bounds."), *GetName());
+		CellCountX = 0;
+		CellCountY = 0;
+		return;
+	}
+
+	Cells.SetNum(CellCountX * CellCountY);
+
+	FCollisionQueryParams Params;
+	Params.AddIgnoredActor(this);
+	Params.bTraceComplex = false;
+	Params.bReturnPhysicalMaterial = true;
+
+	/** Movable objects are ignored, so that the static surface underneath them is baked. Steps on the movable objects themselves
+	 *	are resolved by a trace at runtime, since the character's floor is not static then. */
+	Params.MobilityType = EQueryMobilityType::Static;
+
+	int32 StaticCellCount {0};
+	for (int32 Y {0}; Y < CellCountY; ++Y)
+	{
+		for (int32 X {0}; X < CellCountX; ++X)
+		{
+			const FVector2D CellCenter {Origin + FVector2D((X + 0.5f) * CellSize, (Y + 0.5f) * CellSize)};
+			const FVector TraceStart {CellCenter.X, CellCenter.Y, Center.Z + Extent.Z};
+			const FVector TraceEnd {CellCenter.X, CellCenter.Y, Center.Z - Extent.Z};
+
+			FHitResult HitResult;
+			if (!World->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, ECC_Visibility, Params)) { continue; }
+
+			/** Only static geometry can be baked. Anything that can move needs to be resolved by a trace at runtime. */
+			const UPrimitiveComponent* HitComponent {HitResult.GetComponent()};
+			if (!HitComponent || HitComponent->Mobility != EComponentMobility::Static) { continue; }
+
+			FStepSurfaceCell& Cell {Cells[Y * CellCountX + X]};
+			Cell.Height = HitResult.ImpactPoint.Z;
+			Cell.IsStatic = true;
+
+			/** MAX_uint16 marks a cell without a physical material or object, so the palettes can hold one entry less than that. */
+			if (UPhysicalMaterial* PhysicalMaterial {HitResult.PhysMaterial.Get()})
+			{
+				const int32 PhysicalMaterialIndex {PhysicalMaterials.AddUnique(PhysicalMaterial)};
+				if (PhysicalMaterialIndex >= MAX_uint16)
+				{
+					UE_LOG(LogStepSurfaceGrid, Error, TEXT("Step surface grid '%s' references too many physical materials to bake. Reduce the bounds."), *GetName());
+					ClearSurfaceGrid();
+					return;
+				}
+				Cell.PhysicalMaterialIndex = static_cast<uint16>(PhysicalMaterialIndex);
+			}
+			if (AActor* HitActor {HitResult.GetActor()})
+			{
+				const int32 ObjectIndex {SurfaceObjects.AddUnique(TSoftObjectPtr<AActor>(HitActor))};
+				if (ObjectIndex >= MAX_uint16)
+				{
+					UE_LOG(LogStepSurfaceGrid, Error, TEXT("Step surface grid '%s' references too many surface objects to bake. Reduce the bounds."), *GetName());
+					ClearSurfaceGrid();
+					return;
+				}
+				Cell.ObjectIndex = static_cast<uint16>(ObjectIndex);
+			}
+			++StaticCellCount;
+		}
+	}
+
+	UE_LOG(LogStepSurfaceGrid, Log, TEXT("Baked step surface grid '%s': %d x %d cells, %d static, %d physical materials, %d objects."),
+		*GetName(), CellCountX, CellCountY, StaticCellCount, PhysicalMaterials.Num(), SurfaceObjects.Num());
+}
+
+void AStepSurfaceGrid::ClearSurfaceGrid()
+{
+	Modify();
+	Cells.Empty();
+	PhysicalMaterials.Empty();
+	SurfaceObjects.Empty();
+	CellCountX = 0;
+	CellCountY = 0;
+}
+#endif
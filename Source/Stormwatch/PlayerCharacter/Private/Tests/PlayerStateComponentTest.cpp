@@ -0,0 +1,62 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "PlayerStateComponentTest.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerStateDecayCrossingTest, "Stormwatch.PlayerState.DecayCrossesThreshold",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPlayerStateDecayCrossingTest::RunTest(const FString& Parameters)
+{
+	UWorld* World {UWorld::CreateWorld(EWorldType::Game, false)};
+	FWorldContext& WorldContext {GEngine->CreateNewWorldContext(EWorldType::Game)};
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	AActor* Actor {World->SpawnActor<AActor>()};
+	UPlayerStateTestComponent* Component {NewObject<UPlayerStateTestComponent>(Actor)};
+	Component->RegisterComponent();
+
+	const auto TickWorld = [World](const float Duration)
+	{
+		constexpr float DeltaTime {0.1f};
+		for (float Time {0.0f}; Time < Duration; Time += DeltaTime)
+		{
+			World->Tick(LEVELTICK_All, DeltaTime);
+		}
+	};
+
+	/** The value starts above the threshold and decays across it without any setter being called. */
+	Component->AddStateThreshold(EPlayerStateValue::Fear, 50.0f);
+	Component->SetValue(EPlayerStateValue::Fear, 60.0f);
+	Component->SetValueRate(EPlayerStateValue::Fear, -10.0f);
+	TickWorld(0.5f);
+	Component->Crossings.Reset();
+	const int32 StateChangedCount {Component->StateChangedCount};
+
+	TickWorld(1.5f);
+	if (TestEqual(TEXT("Crossings after decay"), Component->Crossings.Num(), 1))
+	{
+		TestFalse(TEXT("Decay crossing is falling"), Component->Crossings[0].IsAbove);
+	}
+	TestTrue(TEXT("On State Changed is broadcast for the decay crossing"), Component->StateChangedCount > StateChangedCount);
+
+	/** Changes after a timer driven crossing must still be broadcast. */
+	Component->SetValueRate(EPlayerStateValue::Fear, 0.0f);
+	Component->SetValue(EPlayerStateValue::Fear, 80.0f);
+	TickWorld(0.2f);
+	if (TestEqual(TEXT("Crossings after setter"), Component->Crossings.Num(), 2))
+	{
+		TestTrue(TEXT("Setter crossing is rising"), Component->Crossings[1].IsAbove);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayerStateComponent.h"
+#include "PlayerStateComponentTest.generated.h"
+
+/** A concrete player state component that exposes its setters and records its broadcasts, for use in automation tests. */
+UCLASS(NotBlueprintable, Transient, HideDropdown)
+class UPlayerStateTestComponent : public UPlayerStateComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** The threshold crossings that were broadcast, in order. */
+	TArray<FPlayerStateThreshold> Crossings;
+
+	/** The amount of times On State Changed was broadcast. */
+	int32 StateChangedCount {0};
+
+	UPlayerStateTestComponent()
+	{
+		OnStateThresholdCrossed.AddDynamic(this, &UPlayerStateTestComponent::HandleStateThresholdCrossed);
+		OnStateChanged.AddDynamic(this, &UPlayerStateTestComponent::HandleStateChanged);
+	}
+
+	FORCEINLINE void SetValue(const EPlayerStateValue Type, const float Value) { SetStateValue(Type, Value); }
+	FORCEINLINE void SetValueRate(const EPlayerStateValue Type, const float Rate) { SetStateValueRate(Type, Rate); }
+
+private:
+	UFUNCTION()
+	void HandleStateThresholdCrossed(const EPlayerStateValue Type, const float Threshold, const bool IsRising)
+	{
+		FPlayerStateThreshold& Crossing {Crossings.AddDefaulted_GetRef()};
+		Crossing.Type = Type;
+		Crossing.Threshold = Threshold;
+		Crossing.IsAbove = IsRising;
+	}
+
+	UFUNCTION()
+	void HandleStateChanged(const int32 ChangeMask)
+	{
+		++StateChangedCount;
+	}
+};
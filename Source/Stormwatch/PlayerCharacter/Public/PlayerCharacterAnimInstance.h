@@ -6,15 +6,34 @@
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
 #include "StepData.h"
+#include "WorldCollision.h"
 #include "PlayerCharacterAnimInstance.generated.h"
 
 class APlayerCharacter;
 class APlayerCharacterController;
 class UPlayerCharacterMovementComponent;
+class AStepSurfaceGrid;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FFootstepDelegate, FStepData, FootstepData);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FHandstepDelegate, FStepData, HandstepData);
 
+/** Snapshot of the character state that can only be read on the game thread.
+ *	It is copied over in NativeUpdateAnimation so that the animation state can be evaluated on a worker thread. */
+struct FPlayerCharacterAnimSnapshot
+{
+	FVector Velocity {FVector::ZeroVector};
+	FRotator Rotation {FRotator::ZeroRotator};
+	FVector LastInputVector {FVector::ZeroVector};
+	float YawDelta {0.0f};
+	bool IsValid {false};
+	bool HasMovementInput {false};
+	bool IsMovingOnGround {false};
+	bool IsFalling {false};
+	bool IsJumping {false};
+	bool IsCrouching {false};
+	bool IsTurningInPlace {false};
+};
+
 /** The AnimInstance class is an instance of an animation asset that can be played on a skeletal mesh.
  *	This class is implemented as an Animation Blueprint, with most logic being executed through Blueprint nodes.
  *	We mainly declare functions here to be used a BlueprintCallable UFunctions.
@@ -100,6 +119,19 @@ protected:
 	UPROPERTY(BlueprintReadOnly)
 	APlayerCharacter* PlayerCharacter;
 
+private:
+	/** Game thread state copied over in the pre-update. Only read from NativeThreadSafeUpdateAnimation. */
+	FPlayerCharacterAnimSnapshot Snapshot;
+
+	/** The baked step surface grids in the world. Steps are resolved through these before falling back to a trace. */
+	TArray<TWeakObjectPtr<AStepSurfaceGrid>> StepSurfaceGrids;
+
+	/** Query params for step traces, built once when the animation begins. */
+	FCollisionQueryParams StepTraceParams;
+
+	/** Delegate that is called when an asynchronous step trace completes. */
+	FTraceDelegate StepTraceDelegate;
+
 protected:
 	/** Is called after the AnimInstance object is created and all of its properties have been initialized, but before the animation update loop begins. */
 	virtual void NativeInitializeAnimation() override;
@@ -107,12 +139,23 @@ protected:
 	/** Is called when the animation update loop begins. */
 	virtual void NativeBeginPlay() override;
 
-	/** Is called every frame. */
+	/** Is called every frame on the game thread. Only copies over the state that cannot be safely read from a worker thread. */
 	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
 
+	/** Is called every frame on a worker thread. Evaluates the animation state from the snapshot taken in NativeUpdateAnimation. */
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
 	/** Returns step data at the specified location. */
 	void GetStepData(FStepData& StepData, const FVector Location);
 
+	/** Resolves the surface at the specified location from the baked step surface grids.
+	 *	@Return True if a grid contained a static surface underneath the location, and the character is not standing on a movable object. */
+	bool SampleStepSurfaceGrids(FStepData& StepData, const FVector& Location) const;
+
+	/** Resolves a step at the specified location and broadcasts it through the step delegates.
+	 *	Steps on baked surfaces are broadcast immediately, other steps are broadcast once an asynchronous trace completes. */
+	void RequestStep(const FVector& Location, const bool IsHandstep);
+
 	/** Returns data about a footstep at the specified foot, like the object or physical material underneath the foot at the time of the footstep.
 	 *	@param Foot The foot that is performing the step.
 	 *	@Return StepData structure containing relevant information about the location and velocity of the foot at the time of the footstep.
@@ -127,19 +170,35 @@ protected:
 	UFUNCTION(BlueprintPure)
 	FStepData GetHandstepData(const ELeftRight Hand);
 
+	/** Resolves a footstep at the specified foot and broadcasts it through OnFootstep.
+	 *	This avoids a synchronous trace and should be preferred over GetFootstepData in step notifies. */
+	UFUNCTION(BlueprintCallable)
+	void RequestFootstep(const ELeftRight Foot);
+
+	/** Resolves a handstep at the specified hand and broadcasts it through OnHandstep.
+	 *	This avoids a synchronous trace and should be preferred over GetHandstepData in step notifies. */
+	UFUNCTION(BlueprintCallable)
+	void RequestHandstep(const ELeftRight Hand);
+
 private:
+	/** Copies the game thread state of the character into the snapshot. */
+	void UpdateSnapshot(const APlayerCharacter& Character, const APlayerCharacterController& Controller, const UPlayerCharacterMovementComponent& CharacterMovement);
+
 	/** Checks the movement state of the character and updates certain state machine conditions. */
-	void CheckMovementState(const APlayerCharacter& Character, const APlayerCharacterController& Controller, const UPlayerCharacterMovementComponent& CharacterMovement);
+	void CheckMovementState(const FPlayerCharacterAnimSnapshot& State);
 
 	/** Checks whether the character is turning in place, and updates certain state machine conditions accordingly. */
-	void CheckTurnInplaceConditions(const APlayerCharacter& Character);
+	void CheckTurnInplaceConditions(const FPlayerCharacterAnimSnapshot& State);
 
 	/** Returns the direction the character is moving in. */
-	static float GetDirection(const APlayerCharacter& Character);
+	static float GetDirection(const FPlayerCharacterAnimSnapshot& State);
 
 	/** Returns the speed that the character is moving at. */
-	static float GetSpeed(const APlayerCharacter& Character, const UPlayerCharacterMovementComponent& CharacterMovement);
+	static float GetSpeed(const FPlayerCharacterAnimSnapshot& State);
 
 	/** Updates the time the player is falling, if the player is falling. */
 	void UpdateFallTime(const float DeltaTime);
+
+	/** Called when an asynchronous step trace completes. */
+	void HandleStepTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
 };
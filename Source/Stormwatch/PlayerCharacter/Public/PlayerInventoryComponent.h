@@ -10,6 +10,50 @@
 
 class UPlayerInteractionComponent;
 
+/** Flags describing the state of a component before it was made dormant. */
+enum class EInventoryDormancyFlags : uint8
+{
+	None						= 0,
+	TickEnabled					= 1 << 0,
+	SimulatingPhysics			= 1 << 1,
+	NotifyRigidBodyCollision	= 1 << 2,
+	GenerateOverlapEvents		= 1 << 3,
+};
+ENUM_CLASS_FLAGS(EInventoryDormancyFlags);
+
+/** Compact record of a single component's state before it was made dormant. */
+USTRUCT()
+struct FInventoryComponentDormancyState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TWeakObjectPtr<UActorComponent> Component;
+
+	EInventoryDormancyFlags Flags {EInventoryDormancyFlags::None};
+
+	/** Only used for primitive components. */
+	TEnumAsByte<ECollisionEnabled::Type> CollisionEnabled {ECollisionEnabled::NoCollision};
+};
+
+/** Record of an actor's state before it was stored in the inventory, used to restore the actor when it is taken out. */
+USTRUCT()
+struct FInventoryDormancyState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FInventoryComponentDormancyState> Components;
+
+	bool IsDormant {false};
+
+	bool IsActorTickEnabled {false};
+
+	bool IsActorHidden {false};
+
+	bool IsActorCollisionEnabled {false};
+};
+
 UCLASS(Blueprintable, BlueprintType, ClassGroup = "PlayerCharacter",
 	   Meta = (BlueprintSpawnableComponent, DisplayName = "Player Inventory Component"))
 class STORMWATCH_API UPlayerInventoryComponent : public UActorComponent
@@ -21,10 +65,6 @@ private:
 	UPROPERTY(BlueprintGetter = GetCurrentSelectedSlotIndex)
 	int32 SelectedSlot {0};
 
-	/** The actor in the hotbar at the index of the selected slot. */
-	UPROPERTY(BlueprintGetter = GetCurrentSelectedSlotActor)
-	AActor* SelectedActor;
-
 	/** The amount of hotbar slots available for the inventory. */
 	UPROPERTY(BlueprintGetter = GetHotbarSize, EditDefaultsOnly, Category = "PlayerInventoryComponent",
 			  Meta = (DisplayName = "Hotbar Slots", ClampMin = "0", ClampMax = "10", UIMin = "0", UIMax = "10"))
@@ -34,6 +74,10 @@ private:
 	UPROPERTY(BlueprintGetter = GetHotbar)
 	TArray<AActor*> Hotbar;
 
+	/** The dormancy state of the actor in every hotbar slot, indexed the same as the hotbar. */
+	UPROPERTY()
+	TArray<FInventoryDormancyState> HotbarDormancy;
+
 public:
 	UPlayerInventoryComponent();
 
@@ -63,14 +107,25 @@ private:
 	UFUNCTION()
 	UActorComponent* FindInventoryComponent(const AActor* Actor) const;
 
+	/** Returns whether a hotbar slot holds no valid actor, so that an actor can be added to it.
+	 *	If the actor in the slot was destroyed, the slot and its dormant state are cleared. */
+	bool IsSlotEmpty(const int32 SlotIndex);
+
+	/** Disables ticking, physics, collision, hit notifications and rendering for an actor and all of its components.
+	 *	The previous state is recorded so that it can be restored with RestoreActorFromDormancy. */
+	static void MakeActorDormant(AActor* Actor, FInventoryDormancyState& OutState);
+
+	/** Restores an actor to the state it was in before it was made dormant. */
+	static void RestoreActorFromDormancy(AActor* Actor, FInventoryDormancyState& State);
+
 public:
 	/** Returns the current selected slot index. */
 	UFUNCTION(BlueprintGetter, Category = "PlayerInventoryComponent", Meta = (DisplayName = "Get Current Selected Hotbar Slot Index"))
 	FORCEINLINE int32 GetCurrentSelectedSlotIndex() const { return SelectedSlot; }
 
 	/** Returns the current selected slot actor. */
-	UFUNCTION(BlueprintGetter, Category = "PlayerInventoryComponent", Meta = (DisplayName = "Get Current Selected Hotbar Slot Actor"))
-	FORCEINLINE AActor* GetCurrentSelectedSlotActor() const { return SelectedActor; }
+	UFUNCTION(BlueprintPure, Category = "PlayerInventoryComponent", Meta = (DisplayName = "Get Current Selected Hotbar Slot Actor"))
+	FORCEINLINE AActor* GetCurrentSelectedSlotActor() const { return Hotbar.IsValidIndex(SelectedSlot) ? Hotbar[SelectedSlot] : nullptr; }
 
 	/** Returns the hotbar size. */
 	UFUNCTION(BlueprintGetter, Category = "PlayerInventoryComponent", Meta = (DisplayName = "Get Hotbar Size"))
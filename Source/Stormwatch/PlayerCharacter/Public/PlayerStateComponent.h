@@ -21,6 +21,57 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPainChangedDelegate, const float,
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnExertionChangedDelegate, const float, Value);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnFearChangedDelegate, const float, Value);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVigilanceChangedDelegate, const float, Value);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPlayerStateChangedDelegate, const int32, ChangeMask);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPlayerStateThresholdCrossedDelegate, const EPlayerStateValue, Type, const float, Threshold, const bool, IsRising);
+
+/** A state value stored as a linear function of time. The current value is evaluated lazily when it is read. */
+USTRUCT()
+struct FPlayerStateValueTrack
+{
+	GENERATED_BODY()
+
+	/** The value at the time of the timestamp. */
+	UPROPERTY()
+	float Value {0.0f};
+
+	/** The rate at which the value changes, in units per second. */
+	UPROPERTY()
+	float Rate {0.0f};
+
+	/** The world time at which the value was last rebased. */
+	UPROPERTY()
+	double Timestamp {0.0};
+
+	/** Returns the value at the given world time. */
+	FORCEINLINE float Evaluate(const double Time) const
+	{
+		return FMath::Clamp(Value + Rate * static_cast<float>(Time - Timestamp), 0.0f, 100.0f);
+	}
+
+	/** Evaluates the value at the given world time and stores it as the new base value. */
+	FORCEINLINE void Rebase(const double Time)
+	{
+		Value = Evaluate(Time);
+		Timestamp = Time;
+	}
+};
+
+/** A threshold that a listener is interested in. */
+USTRUCT()
+struct FPlayerStateThreshold
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	EPlayerStateValue Type {EPlayerStateValue::Pain};
+
+	UPROPERTY()
+	float Threshold {0.0f};
+
+	/** Whether the value was at or above the threshold when last evaluated. */
+	UPROPERTY()
+	bool IsAbove {false};
+};
 
 /**	This component is created to manage the state of the player character in the game.
  *	While Unreal Engine provides a default APlayerState class, we've opted to create an actor component instead.
@@ -48,6 +99,15 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "PlayerState|Delegates", Meta = (DisplayName = "On Vigilance Changed"))
 	FOnVigilanceChangedDelegate OnVigilanceChanged;
 
+	/** Called at most once per frame when one or more state values are changed.
+	 *	The change mask has a bit set for every EPlayerStateValue that was changed. */
+	UPROPERTY(BlueprintAssignable, Category = "PlayerState|Delegates", Meta = (DisplayName = "On State Changed"))
+	FOnPlayerStateChangedDelegate OnStateChanged;
+
+	/** Called when a state value crosses a threshold that was registered with AddStateThreshold. */
+	UPROPERTY(BlueprintAssignable, Category = "PlayerState|Delegates", Meta = (DisplayName = "On State Threshold Crossed"))
+	FOnPlayerStateThresholdCrossedDelegate OnStateThresholdCrossed;
+
 private:
 	/** The configuration asset to use for this playerstate component. */
 	UPROPERTY(EditAnywhere, Category = "PlayerState|Configuration", Meta = (DisplayName = "Configuration Asset", DisplayPriority = "0"))
@@ -57,30 +117,37 @@ private:
 	UPROPERTY(BlueprintGetter = GetConfiguration)
 	UPlayerStateConfiguration* Configuration;
 
-	/** The pain value of the player character. If the player performs damaging actions, like falling from a great height, this value will be temporarily reduced.
-	 *	The value will be increased back again over time. We use this value to play effects that resemble the player character being hurt. */
+	/** The state values of the player character, indexed by EPlayerStateValue.
+	 *	Pain: If the player performs damaging actions, like falling from a great height, this value will be temporarily reduced.
+	 *	The value will be increased back again over time. We use this value to play effects that resemble the player character being hurt.
+	 *	Exertion: If the player performs physically intensive actions, such as jumping or sprinting, this value will be increased.
+	 *	The value will be lowered when the player moves slowly. We use this value to play effects that resemble the player character becoming exhausted.
+	 *	Fear: If the player encounters any of the hostile entities, this value will increase.
+	 *	The value will be lowered when the player isn't near a hostile entity anymore. We use this value to play effects that resemble the player character being scared.
+	 *	Vigilance: This value is set according to certain in game events.
+	 *	The value represents the player character being more alert to certain cues and sounds. */
 	UPROPERTY()
-	float Pain {0.0f};
+	FPlayerStateValueTrack Values[4];
 
-	/** The exertion of the player character. If the player performs physically intensive actions, such as jumping or sprinting, this value will be increased.
-	 *	The value will be lowered when the player moves slowly. We use this value to play effects that resemble the player character becoming exhausted. */
+	/** The thresholds that listeners are interested in. */
 	UPROPERTY()
-	float Exertion {0.0f};
+	TArray<FPlayerStateThreshold> Thresholds;
 
-	/** The fear value of the player character. If the player encounters any of the hostile entities, this value will increase.
-	 *	The value will be lowered when the player isn't near a hostile entity anymore. We use this value to play effects that resemble the player character being scared. */
+	/** Threshold crossings that are waiting to be broadcast. */
 	UPROPERTY()
-	float Fear {0.0f};
+	TArray<FPlayerStateThreshold> PendingCrossings;
 
-	/** The vigilance value of the player character. This value is set according to certain in game events.
-	 *	The value represents the player character being more alert to certain cues and sounds. */
-	UPROPERTY()
-	float Vigilance {0.0f};
+	/** Bitmask of state values that were changed this frame and are waiting to be broadcast. */
+	uint8 PendingChangeMask {0};
 
-	/** Timer handle for the state update timer. */
+	/** Timer handle for the next threshold crossing. */
 	UPROPERTY()
 	FTimerHandle StateTimer;
 
+	/** Timer handle for the recurring On Update event, which only runs for Blueprints that override it without native rates. */
+	UPROPERTY()
+	FTimerHandle UpdateTimer;
+
 public:
 	UFUNCTION(BlueprintCallable, Category = "PlayerState", Meta = (DisplayName = "Reset Player State"))
 	void ResetPlayerState();
@@ -90,13 +157,22 @@ private:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	float IncrementValue(float& Property, float Value);
-	float DecrementValue(float& Property, float Value);
-	float SetValue(float& Property, float Value);
+	/** Returns the current time that the state values are evaluated against. */
+	double GetStateTime() const;
+
+	/** Rebases a state value and offsets it with a delta. */
+	float ApplyDelta(const EPlayerStateValue Type, const float Delta);
 
-	/** Updates the player character state. */
+	/** Marks a state value as changed. Changes are broadcast once at the start of the next frame. */
+	void MarkStateValueChanged(const EPlayerStateValue Type);
+
+	/** Broadcasts all changes and threshold crossings that have accumulated this frame. */
+	UFUNCTION()
+	void FlushStateChanges();
+
+	/** Checks the thresholds for crossings and schedules a timer for the next expected crossing. */
 	UFUNCTION()
-	void UpdatePlayerState();
+	void UpdateThresholds();
 
 protected:
 	/** Increments a state value with a given amount, up to the maximum allowed value of that type.
@@ -123,6 +199,33 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "PlayerState", Meta = (DisplayName = "Set Value", BlueprintProtected))
 	float SetStateValue(const EPlayerStateValue Type, const float Value);
 
+	/** Sets the rate at which a state value changes over time.
+	 *	@Param Type The state value to set the rate for.
+	 *	@Param Rate The change of the value per second. Negative values decay the state value.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "PlayerState", Meta = (DisplayName = "Set Value Rate", BlueprintProtected))
+	void SetStateValueRate(const EPlayerStateValue Type, const float Rate);
+
+public:
+	/** Registers a threshold for a state value. OnStateThresholdCrossed is called when the value crosses it.
+	 *	@Param Type The state value to watch.
+	 *	@Param Threshold The value at which the delegate should be called.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "PlayerState", Meta = (DisplayName = "Add State Threshold"))
+	void AddStateThreshold(const EPlayerStateValue Type, const float Threshold);
+
+	/** Removes a threshold that was registered with AddStateThreshold. */
+	UFUNCTION(BlueprintCallable, Category = "PlayerState", Meta = (DisplayName = "Remove State Threshold"))
+	void RemoveStateThreshold(const EPlayerStateValue Type, const float Threshold);
+
+	/** Returns the current value of a state value. */
+	UFUNCTION(BlueprintPure, Category = "PlayerState", Meta = (DisplayName = "Get State Value"))
+	float GetStateValue(const EPlayerStateValue Type) const;
+
+	/** Returns the rate at which a state value changes per second. */
+	UFUNCTION(BlueprintPure, Category = "PlayerState", Meta = (DisplayName = "Get State Value Rate"))
+	float GetStateValueRate(const EPlayerStateValue Type) const;
+
 public:
 	/** Returns the configuration for the player state component. */
 	UFUNCTION(BlueprintPure, Category = "PlayerState|Configuration", Meta = (DisplayName = "Get Configuration"))
@@ -130,21 +233,23 @@ public:
 
 	/** Returns the current pain of the player character. */
 	UFUNCTION(BlueprintPure, Category = "PlayerState|Pain", Meta = (DisplayName = "Get Pain"))
-	FORCEINLINE float GetPain() const { return Pain; }
+	FORCEINLINE float GetPain() const { return GetStateValue(EPlayerStateValue::Pain); }
 
 	/** Returns the current exertion of the player character. */
 	UFUNCTION(BlueprintPure, Category = "PlayerState|Exertion", Meta = (DisplayName = "Get Exertion"))
-	FORCEINLINE float GetExertion() const { return Exertion; }
+	FORCEINLINE float GetExertion() const { return GetStateValue(EPlayerStateValue::Exertion); }
 
 	/** Returns the current fear value of the player character. */
 	UFUNCTION(BlueprintPure, Category = "PlayerState|Fear", Meta = (DisplayName = "Get Fear"))
-	FORCEINLINE float GetFear() const { return Fear; }
+	FORCEINLINE float GetFear() const { return GetStateValue(EPlayerStateValue::Fear); }
 
 	/** Returns the current vigilance value of the player character. */
 	UFUNCTION(BlueprintPure, Category = "PlayerState|Vigilance", Meta = (DisplayName = "Get Vigilance"))
-	FORCEINLINE float GetVigilance() const { return Vigilance; }
+	FORCEINLINE float GetVigilance() const { return GetStateValue(EPlayerStateValue::Vigilence); }
 
 protected:
+	/** Called every second while the component is playing, but only if it is overridden and no state value has a rate at begin play.
+	 *	Decay should be set with Set Value Rate instead, and changes should be handled with the On State Changed delegate. */
 	UFUNCTION(BlueprintNativeEvent, Category = "PlayerState|Events", Meta = (DisplayName = "On Update"))
 	void EventOnUpdate();
 };
@@ -155,15 +260,15 @@ class STORMWATCH_API UPlayerStateConfiguration : public UDataAsset
 	GENERATED_BODY()
 
 public:
-	/** The amount of pain that is restored every update interval. */
+	/** The amount of pain that is restored every second. */
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Pain", Meta = (DisplayName = "Pain Reduction Amount"))
 	float PainReductionAmount {2.0f};
 
-	/** The amount of exertion that is removed per update interval when the player is not performing intensive movements.*/
+	/** The amount of exertion that is removed per second when the player is not performing intensive movements.*/
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Exertion", Meta = (DisplayName = "Exertion Reduction Amount"))
 	float ExertionReductionAmount {2.0f};
 
-	/** The amount of exertion that is added per update interval when the player sprints. */
+	/** The amount of exertion that is added per second when the player sprints. */
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Exertion", Meta = (DisplayName = "Sprint Exertion Cost"))
 	float SprintExertionCost {3.0f};
 
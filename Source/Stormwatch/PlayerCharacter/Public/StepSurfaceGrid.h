@@ -0,0 +1,105 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "StepSurfaceGrid.generated.h"
+
+class UBoxComponent;
+class UPhysicalMaterial;
+
+/** A single baked cell of a step surface grid. */
+USTRUCT()
+struct FStepSurfaceCell
+{
+	GENERATED_BODY()
+
+	/** The world space height of the surface in this cell. */
+	UPROPERTY()
+	float Height {0.0f};
+
+	/** Index into the grid's physical material palette. */
+	UPROPERTY()
+	uint16 PhysicalMaterialIndex {MAX_uint16};
+
+	/** Index into the grid's surface object palette. */
+	UPROPERTY()
+	uint16 ObjectIndex {MAX_uint16};
+
+	/** If false, there is no static surface in this cell and a trace is required to resolve the step. */
+	UPROPERTY()
+	bool IsStatic {false};
+};
+
+/** Axis aligned 2D grid that maps floor cells to the physical material and object underneath them.
+ *	The grid is baked in the editor by tracing down from the top of the bounds, so it only captures static geometry.
+ *	Each grid represents a single floor. Stack multiple grids on top of each other for multi-story areas. */
+UCLASS(Blueprintable, BlueprintType, ClassGroup = "PlayerCharacter", Meta = (DisplayName = "Step Surface Grid"))
+class STORMWATCH_API AStepSurfaceGrid : public AActor
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogStepSurfaceGrid, Log, All)
+
+protected:
+	/** The area that is covered by the grid. Rotation is ignored. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Components")
+	UBoxComponent* Bounds;
+
+	/** The size of a single cell. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Step Surface Grid", Meta = (DisplayName = "Cell Size", Units = "Centimeters",
+		ClampMin = "5", ClampMax = "200", UIMin = "5", UIMax = "200"))
+	float CellSize {25.0f};
+
+	/** The maximum height difference between a step and the baked surface for the sample to be considered valid. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Step Surface Grid", Meta = (DisplayName = "Max Step Height", Units = "Centimeters",
+		ClampMin = "0", UIMin = "0", UIMax = "100"))
+	float MaxStepHeight {50.0f};
+
+private:
+	/** The world space corner of the grid with the lowest X and Y coordinates at the time of baking. */
+	UPROPERTY()
+	FVector2D Origin {FVector2D::ZeroVector};
+
+	UPROPERTY()
+	int32 CellCountX {0};
+
+	UPROPERTY()
+	int32 CellCountY {0};
+
+	/** Row major array of baked cells. */
+	UPROPERTY()
+	TArray<FStepSurfaceCell> Cells;
+
+	/** The unique physical materials referenced by the cells. */
+	UPROPERTY()
+	TArray<UPhysicalMaterial*> PhysicalMaterials;
+
+	/** The unique surface objects referenced by the cells. These can live in other streamed levels,
+	 *	so they are soft references that don't keep the objects alive and resolve to null while their level is unloaded. */
+	UPROPERTY()
+	TArray<TSoftObjectPtr<AActor>> SurfaceObjects;
+
+public:
+	AStepSurfaceGrid();
+
+	/** Samples the grid at a location.
+	 *	@Return True if the location is inside the grid and there is a static surface within step height underneath it,
+	 *	whose object is loaded. */
+	bool Sample(const FVector& Location, UPhysicalMaterial*& OutPhysicalMaterial, AActor*& OutObject) const;
+
+	/** Returns whether the grid contains baked data. */
+	FORCEINLINE bool IsBaked() const { return !Cells.IsEmpty(); }
+
+#if WITH_EDITOR
+	/** Bakes the static surfaces inside the bounds into the grid. */
+	UFUNCTION(CallInEditor, Category = "Step Surface Grid")
+	void BakeSurfaceGrid();
+
+	/** Clears all baked data. */
+	UFUNCTION(CallInEditor, Category = "Step Surface Grid")
+	void ClearSurfaceGrid();
+#endif
+};
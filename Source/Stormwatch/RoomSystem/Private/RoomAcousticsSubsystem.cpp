@@ -0,0 +1,494 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "RoomAcousticsSubsystem.h"
+#include "RoomVolume.h"
+#include "RoomLookupSubsystem.h"
+#include "SlidingDoor.h"
+#include "Components/AudioComponent.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_CLASS(URoomAcousticsSubsystem, LogRoomAcoustics);
+
+void URoomAcousticsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	RoomLookupSubsystem = Collection.InitializeDependency<URoomLookupSubsystem>();
+}
+
+void URoomAcousticsSubsystem::Deinitialize()
+{
+	for (const FRoomAcousticPortal& Portal : Portals)
+	{
+		if (ASlidingDoor* Door {Portal.Door.Get()})
+		{
+			Door->OnDoorStateChanged.RemoveDynamic(this, &URoomAcousticsSubsystem::HandleDoorStateChanged);
+		}
+	}
+
+	OnRoomGraphRebuilt.Clear();
+	OnListenerRoomChanged.Clear();
+
+	RoomLookupSubsystem = nullptr;
+
+	Rooms.Empty();
+	RoomIndices.Empty();
+	Portals.Empty();
+	RoomPortals.Empty();
+	PlayerRooms.Empty();
+	Sources.Empty();
+
+	Super::Deinitialize();
+}
+
+void URoomAcousticsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (IsGraphDirty)
+	{
+		RebuildGraph();
+	}
+	if (IsSolutionDirty)
+	{
+		SolvePaths();
+	}
+
+	/** The listener is updated even without sources, so that CalculatePropagation always starts from the current listener location. */
+	const APlayerController* PlayerController {GetWorld()->GetFirstPlayerController()};
+	if (!PlayerController) { return; }
+
+	FVector FrontDirection;
+	FVector RightDirection;
+	PlayerController->GetAudioListenerPosition(ListenerLocation, FrontDirection, RightDirection);
+
+	if (Sources.IsEmpty()) { return; }
+
+	Sources.RemoveAllSwap([](const FRoomAcousticSource& Source) { return !Source.AudioComponent.IsValid(); });
+
+	for (FRoomAcousticSource& Source : Sources)
+	{
+		UAudioComponent* AudioComponent {Source.AudioComponent.Get()};
+		const FVector Location {AudioComponent->GetComponentLocation()};
+
+		if (!Source.HasRoom || FVector::DistSquared(Location, Source.RoomLocation) > FMath::Square(SourceRoomUpdateDistance))
+		{
+			Source.Room = FindRoomIndexAtLocation(Location);
+			Source.RoomLocation = Location;
+			Source.HasRoom = true;
+		}
+
+		const FRoomSoundPropagation Propagation {CalculatePropagation(Location, Source.Room)};
+		const bool IsChanged {!FMath::IsNearlyEqual(Propagation.Occlusion, Source.Propagation.Occlusion, 0.01f)
+			|| !FMath::IsNearlyEqual(Propagation.Obstruction, Source.Propagation.Obstruction, 0.01f)};
+		if (!IsChanged)
+		{
+			/** Keep the applied occlusion, so that slow drift is still applied once it exceeds the tolerance. */
+			Source.Propagation.ApparentLocation = Propagation.ApparentLocation;
+			Source.Propagation.PathDistance = Propagation.PathDistance;
+			continue;
+		}
+		Source.Propagation = Propagation;
+
+		AudioComponent->SetFloatParameter(TEXT("Room_Occlusion"), Propagation.Occlusion);
+		AudioComponent->SetFloatParameter(TEXT("Room_Obstruction"), Propagation.Obstruction);
+		AudioComponent->SetLowPassFilterEnabled(true);
+		AudioComponent->SetLowPassFilterFrequency(FMath::Lerp(UnoccludedLowPassFrequency, OccludedLowPassFrequency, Propagation.Occlusion));
+	}
+}
+
+TStatId URoomAcousticsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URoomAcousticsSubsystem, STATGROUP_Tickables);
+}
+
+void URoomAcousticsSubsystem::RegisterRoom(ARoomVolume* Room)
+{
+	if (!Room || RoomIndices.Contains(Room)) { return; }
+
+	if (Rooms.IsEmpty())
+	{
+		Rooms.Add(nullptr);
+	}
+	RoomIndices.Add(Room, Rooms.Add(Room));
+	IsGraphDirty = true;
+}
+
+void URoomAcousticsSubsystem::UnregisterRoom(ARoomVolume* Room)
+{
+	const int32* Index {RoomIndices.Find(Room)};
+	if (!Index) { return; }
+
+	/** The room is only removed from the list when the graph is rebuilt, so that the indices stay valid until then. */
+	Rooms[*Index] = nullptr;
+	RoomIndices.Remove(Room);
+	PlayerRooms.Remove(Room);
+	IsGraphDirty = true;
+}
+
+void URoomAcousticsSubsystem::HandlePlayerEnterRoom(ARoomVolume* Room)
+{
+	PlayerRooms.Remove(Room);
+	PlayerRooms.Add(Room);
+	UpdateListenerRoom();
+}
+
+void URoomAcousticsSubsystem::HandlePlayerLeaveRoom(ARoomVolume* Room)
+{
+	PlayerRooms.Remove(Room);
+	UpdateListenerRoom();
+}
+
+void URoomAcousticsSubsystem::RegisterSource(UAudioComponent* AudioComponent)
+{
+	if (!AudioComponent) { return; }
+	if (Sources.ContainsByPredicate([AudioComponent](const FRoomAcousticSource& Source) { return Source.AudioComponent == AudioComponent; })) { return; }
+
+	FRoomAcousticSource& Source {Sources.AddDefaulted_GetRef()};
+	Source.AudioComponent = AudioComponent;
+}
+
+void URoomAcousticsSubsystem::UnregisterSource(UAudioComponent* AudioComponent)
+{
+	Sources.RemoveAllSwap([AudioComponent](const FRoomAcousticSource& Source) { return Source.AudioComponent == AudioComponent; });
+}
+
+FRoomSoundPropagation URoomAcousticsSubsystem::GetSourcePropagation(const UAudioComponent* AudioComponent) const
+{
+	const FRoomAcousticSource* Source {Sources.FindByPredicate([AudioComponent](const FRoomAcousticSource& Source)
+	{
+		return Source.AudioComponent == AudioComponent;
+	})};
+	return Source ? Source->Propagation : FRoomSoundPropagation();
+}
+
+FRoomSoundPropagation URoomAcousticsSubsystem::CalculatePropagation(const FVector& Location) const
+{
+	return CalculatePropagation(Location, FindRoomIndexAtLocation(Location));
+}
+
+ARoomVolume* URoomAcousticsSubsystem::FindRoomAtLocation(const FVector& Location) const
+{
+	const int32 Room {FindRoomIndexAtLocation(Location)};
+	return Room > 0 ? Rooms[Room].Get() : nullptr;
+}
+
+ARoomVolume* URoomAcousticsSubsystem::GetListenerRoom() const
+{
+	return ListenerRoom > 0 && Rooms.IsValidIndex(ListenerRoom) ? Rooms[ListenerRoom].Get() : nullptr;
+}
+
+void URoomAcousticsSubsystem::FindRoomsWithinPortals(const ARoomVolume* Room, const int32 PortalCount, TSet<const ARoomVolume*>& OutRooms) const
+{
+	const int32* StartRoom {Room ? RoomIndices.Find(Room) : nullptr};
+	if (Room && !StartRoom) { return; }
+
+	/** Breadth first search over the rooms, one ring of portals at a time. */
+	TArray<int32> Depths;
+	Depths.Init(INDEX_NONE, FMath::Max(Rooms.Num(), 1));
+	TArray<int32> Queue {StartRoom ? *StartRoom : 0};
+	Depths[Queue[0]] = 0;
+
+	for (int32 QueueIndex {0}; QueueIndex < Queue.Num(); ++QueueIndex)
+	{
+		const int32 CurrentRoom {Queue[QueueIndex]};
+		OutRooms.Add(CurrentRoom > 0 ? Rooms[CurrentRoom].Get() : nullptr);
+
+		if (Depths[CurrentRoom] >= PortalCount || !RoomPortals.IsValidIndex(CurrentRoom)) { continue; }
+
+		for (const int32 PortalIndex : RoomPortals[CurrentRoom])
+		{
+			const FRoomAcousticPortal& Portal {Portals[PortalIndex]};
+			const int32 NextRoom {Portal.RoomA == CurrentRoom ? Portal.RoomB : Portal.RoomA};
+			if (Depths[NextRoom] != INDEX_NONE) { continue; }
+
+			Depths[NextRoom] = Depths[CurrentRoom] + 1;
+			Queue.Add(NextRoom);
+		}
+	}
+}
+
+void URoomAcousticsSubsystem::FindRoomsConnectedByDoor(const ASlidingDoor* Door, TArray<const ARoomVolume*>& OutRooms) const
+{
+	for (const FRoomAcousticPortal& Portal : Portals)
+	{
+		if (Portal.Door.Get() != Door) { continue; }
+
+		OutRooms.AddUnique(Portal.RoomA > 0 ? Rooms[Portal.RoomA].Get() : nullptr);
+		OutRooms.AddUnique(Portal.RoomB > 0 ? Rooms[Portal.RoomB].Get() : nullptr);
+	}
+}
+
+void URoomAcousticsSubsystem::RebuildGraph()
+{
+	IsGraphDirty = false;
+
+	for (const FRoomAcousticPortal& Portal : Portals)
+	{
+		if (ASlidingDoor* Door {Portal.Door.Get()})
+		{
+			Door->OnDoorStateChanged.RemoveDynamic(this, &URoomAcousticsSubsystem::HandleDoorStateChanged);
+		}
+	}
+
+	/** Index 0 is the exterior, so stale rooms are only removed after it. */
+	for (int32 Index {Rooms.Num() - 1}; Index > 0; --Index)
+	{
+		if (!Rooms[Index].IsValid())
+		{
+			Rooms.RemoveAt(Index);
+		}
+	}
+
+	RoomIndices.Reset();
+	for (int32 Index {1}; Index < Rooms.Num(); ++Index)
+	{
+		RoomIndices.Add(Rooms[Index].Get(), Index);
+	}
+
+	Portals.Reset();
+	RoomPortals.Reset();
+	RoomPortals.SetNum(FMath::Max(Rooms.Num(), 1));
+
+	/** Portals only have to be added to one of the two rooms they connect, so portals added to both are merged. */
+	constexpr float PortalMergeDistance {50.0f};
+
+	for (int32 RoomIndex {1}; RoomIndex < Rooms.Num(); ++RoomIndex)
+	{
+		const ARoomVolume* Room {Rooms[RoomIndex].Get()};
+		for (const FRoomPortal& RoomPortal : Room->GetPortals())
+		{
+			int32 ConnectedRoomIndex {0};
+			if (!RoomPortal.ConnectedRoom.IsNull())
+			{
+				const int32* Index {RoomIndices.Find(RoomPortal.ConnectedRoom.Get())};
+				if (!Index)
+				{
+					UE_LOG(LogRoomAcoustics, Verbose, TEXT("Skipped a portal of room '%s' because its connected room is not loaded."), *Room->GetName());
+					continue;
+				}
+				ConnectedRoomIndex = *Index;
+			}
+			if (ConnectedRoomIndex == RoomIndex) { continue; }
+
+			const FVector Location {Room->GetActorTransform().TransformPosition(RoomPortal.Location)};
+
+			const bool IsDuplicate {RoomPortals[RoomIndex].ContainsByPredicate([&](const int32 PortalIndex)
+			{
+				const FRoomAcousticPortal& Portal {Portals[PortalIndex]};
+				return (Portal.RoomA == ConnectedRoomIndex || Portal.RoomB == ConnectedRoomIndex)
+					&& FVector::DistSquared(Portal.Location, Location) < FMath::Square(PortalMergeDistance);
+			})};
+			if (IsDuplicate) { continue; }
+
+			FRoomAcousticPortal Portal;
+			Portal.Location = Location;
+			Portal.RoomA = RoomIndex;
+			Portal.RoomB = ConnectedRoomIndex;
+			Portal.Door = RoomPortal.Door.Get();
+			Portal.OpenOcclusion = RoomPortal.OpenOcclusion;
+			Portal.ClosedOcclusion = RoomPortal.ClosedOcclusion;
+
+			if (ASlidingDoor* Door {Portal.Door.Get()})
+			{
+				Door->OnDoorStateChanged.AddUniqueDynamic(this, &URoomAcousticsSubsystem::HandleDoorStateChanged);
+			}
+
+			const int32 PortalIndex {Portals.Add(Portal)};
+			RoomPortals[RoomIndex].Add(PortalIndex);
+			RoomPortals[ConnectedRoomIndex].Add(PortalIndex);
+		}
+	}
+
+	/** Room indices may have shifted, so every source has to find its room again. */
+	for (FRoomAcousticSource& Source : Sources)
+	{
+		Source.HasRoom = false;
+	}
+
+	UpdateListenerRoom();
+	IsSolutionDirty = true;
+
+	UE_LOG(LogRoomAcoustics, Verbose, TEXT("Rebuilt the room graph with %d rooms and %d portals."), Rooms.Num() - 1, Portals.Num());
+
+	OnRoomGraphRebuilt.Broadcast();
+}
+
+void URoomAcousticsSubsystem::UpdateListenerRoom()
+{
+	int32 Room {0};
+	for (int32 Index {PlayerRooms.Num() - 1}; Index >= 0; --Index)
+	{
+		if (const int32* RoomIndex {RoomIndices.Find(PlayerRooms[Index].Get())})
+		{
+			Room = *RoomIndex;
+			break;
+		}
+	}
+
+	if (Room != ListenerRoom)
+	{
+		ListenerRoom = Room;
+		IsSolutionDirty = true;
+		OnListenerRoomChanged.Broadcast();
+	}
+}
+
+void URoomAcousticsSubsystem::SolvePaths()
+{
+	IsSolutionDirty = false;
+
+	for (FRoomAcousticPortal& Portal : Portals)
+	{
+		const ASlidingDoor* Door {Portal.Door.Get()};
+		if (!Door)
+		{
+			Portal.Occlusion = Portal.OpenOcclusion;
+			continue;
+		}
+
+		switch (Door->GetDoorState())
+		{
+		case EDoorState::Open:
+			Portal.Occlusion = Portal.OpenOcclusion;
+			break;
+		case EDoorState::Closed:
+			Portal.Occlusion = Portal.ClosedOcclusion;
+			break;
+		default:
+			Portal.Occlusion = (Portal.OpenOcclusion + Portal.ClosedOcclusion) * 0.5f;
+			break;
+		}
+	}
+
+	ListenerPortals = RoomPortals.IsValidIndex(ListenerRoom) ? RoomPortals[ListenerRoom] : TArray<int32>();
+
+	const int32 PortalCount {Portals.Num()};
+	const int32 PathCount {ListenerPortals.Num() * PortalCount};
+	PathCosts.Init(MAX_flt, PathCount);
+	PathDistances.Init(0.0f, PathCount);
+	PathTransmissions.Init(0.0f, PathCount);
+
+	struct FPathNode
+	{
+		float Cost;
+		int32 Portal;
+
+		bool operator<(const FPathNode& Other) const { return Cost < Other.Cost; }
+	};
+	TArray<FPathNode> Heap;
+
+	/** Solve the cheapest path from every portal of the listener's room to every portal in the graph.
+	 *	A path costs the distance it covers, plus a penalty for the occlusion of every portal it passes through. */
+	for (int32 ListenerPortalIndex {0}; ListenerPortalIndex < ListenerPortals.Num(); ++ListenerPortalIndex)
+	{
+		const int32 Offset {ListenerPortalIndex * PortalCount};
+		const int32 StartPortal {ListenerPortals[ListenerPortalIndex]};
+
+		PathCosts[Offset + StartPortal] = Portals[StartPortal].Occlusion * ClosedPortalCost;
+		PathTransmissions[Offset + StartPortal] = 1.0f - Portals[StartPortal].Occlusion;
+
+		Heap.Reset();
+		Heap.HeapPush({PathCosts[Offset + StartPortal], StartPortal});
+
+		while (!Heap.IsEmpty())
+		{
+			FPathNode Node;
+			Heap.HeapPop(Node);
+			if (Node.Cost > PathCosts[Offset + Node.Portal]) { continue; }
+
+			const FRoomAcousticPortal& Portal {Portals[Node.Portal]};
+			for (const int32 Room : {Portal.RoomA, Portal.RoomB})
+			{
+				for (const int32 NextPortal : RoomPortals[Room])
+				{
+					if (NextPortal == Node.Portal) { continue; }
+
+					const FRoomAcousticPortal& Next {Portals[NextPortal]};
+					const float Distance {static_cast<float>(FVector::Dist(Portal.Location, Next.Location))};
+					const float Cost {Node.Cost + Distance + Next.Occlusion * ClosedPortalCost};
+					if (Cost >= PathCosts[Offset + NextPortal]) { continue; }
+
+					PathCosts[Offset + NextPortal] = Cost;
+					PathDistances[Offset + NextPortal] = PathDistances[Offset + Node.Portal] + Distance;
+					PathTransmissions[Offset + NextPortal] = PathTransmissions[Offset + Node.Portal] * (1.0f - Next.Occlusion);
+					Heap.HeapPush({Cost, NextPortal});
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogRoomAcoustics, VeryVerbose, TEXT("Solved %d paths from %d listener portals."), PathCount, ListenerPortals.Num());
+}
+
+int32 URoomAcousticsSubsystem::FindRoomIndexAtLocation(const FVector& Location) const
+{
+	const ARoomVolume* Room {RoomLookupSubsystem ? RoomLookupSubsystem->FindRoomAtLocation(Location) : nullptr};
+	const int32* Index {Room ? RoomIndices.Find(Room) : nullptr};
+	return Index ? *Index : 0;
+}
+
+FRoomSoundPropagation URoomAcousticsSubsystem::CalculatePropagation(const FVector& Location, const int32 Room) const
+{
+	FRoomSoundPropagation Propagation;
+	Propagation.ApparentLocation = Location;
+	Propagation.PathDistance = FVector::Dist(ListenerLocation, Location);
+
+	if (Room == ListenerRoom) { return Propagation; }
+
+	const int32 PortalCount {Portals.Num()};
+	if (!RoomPortals.IsValidIndex(Room) || PathCosts.Num() != ListenerPortals.Num() * PortalCount)
+	{
+		Propagation.Occlusion = 1.0f;
+		return Propagation;
+	}
+
+	/** Find the listener portal and source room portal pair with the cheapest path between them. */
+	float BestCost {MAX_flt};
+	int32 BestListenerPortal {INDEX_NONE};
+	int32 BestPath {INDEX_NONE};
+	float BestDistance {0.0f};
+
+	for (int32 ListenerPortalIndex {0}; ListenerPortalIndex < ListenerPortals.Num(); ++ListenerPortalIndex)
+	{
+		const FVector& ListenerPortalLocation {Portals[ListenerPortals[ListenerPortalIndex]].Location};
+		const float ListenerDistance {static_cast<float>(FVector::Dist(ListenerLocation, ListenerPortalLocation))};
+
+		for (const int32 SourcePortal : RoomPortals[Room])
+		{
+			const int32 Path {ListenerPortalIndex * PortalCount + SourcePortal};
+			if (PathCosts[Path] == MAX_flt) { continue; }
+
+			const float SourceDistance {static_cast<float>(FVector::Dist(Portals[SourcePortal].Location, Location))};
+			const float Cost {ListenerDistance + PathCosts[Path] + SourceDistance};
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				BestListenerPortal = ListenerPortals[ListenerPortalIndex];
+				BestPath = Path;
+				BestDistance = ListenerDistance + PathDistances[Path] + SourceDistance;
+			}
+		}
+	}
+
+	if (BestPath == INDEX_NONE)
+	{
+		Propagation.Occlusion = 1.0f;
+		return Propagation;
+	}
+
+	const FVector PortalDirection {(Portals[BestListenerPortal].Location - ListenerLocation).GetSafeNormal()};
+	const FVector SourceDirection {(Location - ListenerLocation).GetSafeNormal()};
+
+	Propagation.Occlusion = FMath::Clamp(1.0f - PathTransmissions[BestPath], 0.0f, 1.0f);
+	Propagation.Obstruction = FMath::Clamp(0.5f * (1.0f - static_cast<float>(FVector::DotProduct(SourceDirection, PortalDirection))), 0.0f, 1.0f);
+	Propagation.PathDistance = BestDistance;
+	Propagation.ApparentLocation = ListenerLocation + PortalDirection * BestDistance;
+	return Propagation;
+}
+
+void URoomAcousticsSubsystem::HandleDoorStateChanged(EDoorState State)
+{
+	IsSolutionDirty = true;
+}
@@ -2,7 +2,8 @@
 // Written by Tim Verberne.
 
 #include "RoomAudioComponent.h"
-#include "SubmixEffects/SubmixEffectConvolutionReverb.h"
+#include "RoomVolume.h"
+#include "RoomReverbSubsystem.h"
 
 URoomAudioComponent::URoomAudioComponent()
 {
@@ -12,59 +13,37 @@ URoomAudioComponent::URoomAudioComponent()
 void URoomAudioComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	/** Rooms that were placed before the match was stored still have to be matched. */
+	if (!ReverbConvolutionReverbPreset)
+	{
+		ConstructComponent();
+	}
 }
 
 void URoomAudioComponent::ConstructComponent()
 {
 	Super::ConstructComponent();
 
-	// ReverbConvolutionReverbPreset = FindMatchingImpulseResponseFromDataTable(ReverbTypes, );
+	if (const ARoomVolume* RoomVolume {Cast<ARoomVolume>(GetOwner())})
+	{
+		ReverbConvolutionReverbPreset = FindMatchingImpulseResponseFromDataTable(ReverbTypes, RoomVolume->GetVolume(),
+			RoomVolume->GetRoomRatio(), RoomVolume->GetReflectivity());
+	}
 }
 
 USubmixEffectConvolutionReverbPreset* URoomAudioComponent::FindMatchingImpulseResponseFromDataTable(UDataTable* DataTable, const float Volume, const float ShapeRatio, const float Reflectivity)
 {
 	if (!DataTable) { return nullptr; }
 
-	TArray<FName> RowNames {DataTable->GetRowNames()};
-	int Index {-1};
-	float MinDifference {FLT_MAX};
-	
-	for (int32 i {0}; i < RowNames.Num(); i++)
+	const UWorld* World {GetWorld()};
+	if (URoomReverbSubsystem* Subsystem {World ? World->GetSubsystem<URoomReverbSubsystem>() : nullptr})
 	{
-		const FName CurrentRowName {RowNames[i]};
-
-		if (const FRoomReverbSettings* CurrentRow {DataTable->FindRow<FRoomReverbSettings>(CurrentRowName, FString(""))})
-		{
-			/** weights for each parameter. */
-			constexpr float VolumeWeight = 3.0f;
-			constexpr float RatioWeight = 1.0f;
-			constexpr float ReflectivityWeight = 1.0f;
-
-			/** Value for volume normalization. */
-			constexpr float MaxVolume = 500.0f;
-			
-			const float VolumeDifference {FMath::Abs(FMath::Clamp(Volume, 0, MaxVolume) - CurrentRow->RoomVolume) / MaxVolume};
-			const float RatioDifference {FMath::Abs(ShapeRatio - CurrentRow->ShapeRatio)};
-			const float ReflectivityDifference {FMath::Abs(Reflectivity - CurrentRow->Reflectivity)};
-
-			const float TotalDifference {VolumeDifference * VolumeWeight + RatioDifference * RatioWeight + ReflectivityDifference * ReflectivityWeight};
-
-			if (TotalDifference < MinDifference)
-			{
-				MinDifference = TotalDifference;
-				Index = i;
-			}
-		}
+		return Subsystem->FindMatchingImpulseResponse(DataTable, Volume, ShapeRatio, Reflectivity);
 	}
 
-	if (Index >= 0 && Index < RowNames.Num())
-	{
-		const FName MatchedRowName {RowNames[Index]};
-		if (const FRoomReverbSettings* MatchedRow {DataTable->FindRow<FRoomReverbSettings>(MatchedRowName, FString(""))})
-		{
-			return MatchedRow->ImpulseResponseA;
-		}
-	}
-	return nullptr;
+	/** Worlds without subsystems, like those of asset previews, match against a temporary index. */
+	FRoomReverbIndex Index;
+	Index.Build(DataTable);
+	return Index.FindNearest(Volume, ShapeRatio, Reflectivity);
 }
-
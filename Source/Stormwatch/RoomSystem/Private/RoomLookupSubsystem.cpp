@@ -0,0 +1,264 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "RoomLookupSubsystem.h"
+#include "RoomVolume.h"
+#include "EngineUtils.h"
+#include "Components/BoxComponent.h"
+
+DEFINE_LOG_CATEGORY_CLASS(URoomLookupSubsystem, LogRoomLookup);
+
+void URoomLookupSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	/** Rooms register themselves on BeginPlay, which happens after this, so the rooms of the level are gathered here to build the hierarchy once. */
+	for (TActorIterator<ARoomVolume> It(&InWorld); It; ++It)
+	{
+		FRoomLookupEntry& Entry {Entries.AddDefaulted_GetRef()};
+		Entry.Room = *It;
+	}
+
+	RebuildHierarchy();
+	HasWorldBegunPlay = true;
+}
+
+void URoomLookupSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	Nodes.Empty();
+	TrackedActors.Empty();
+
+	Super::Deinitialize();
+}
+
+void URoomLookupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TrackedActors.RemoveAllSwap([](const FRoomTrackedActor& TrackedActor) { return !TrackedActor.Actor.IsValid(); });
+
+	for (FRoomTrackedActor& TrackedActor : TrackedActors)
+	{
+		AActor* Actor {TrackedActor.Actor.Get()};
+		const FVector Location {Actor->GetActorLocation()};
+
+		/** An actor that is still inside a room that no other room overlaps cannot have changed room. */
+		if (Entries.IsValidIndex(TrackedActor.Entry))
+		{
+			const FRoomLookupEntry& Entry {Entries[TrackedActor.Entry]};
+			const ARoomVolume* Room {Entry.Room.Get()};
+			if (Room && !Entry.HasOverlappingRooms && Room->IsLocationInRoom(Location)) { continue; }
+		}
+
+		const int32 EntryIndex {FindEntryAtLocation(Location)};
+		ARoomVolume* NewRoom {EntryIndex != INDEX_NONE ? Entries[EntryIndex].Room.Get() : nullptr};
+		TrackedActor.Entry = EntryIndex;
+
+		ARoomVolume* PreviousRoom {TrackedActor.Room.Get()};
+		if (NewRoom == PreviousRoom) { continue; }
+
+		TrackedActor.Room = NewRoom;
+		OnActorRoomChanged.Broadcast(Actor, PreviousRoom, NewRoom);
+	}
+}
+
+TStatId URoomLookupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URoomLookupSubsystem, STATGROUP_Tickables);
+}
+
+void URoomLookupSubsystem::RegisterRoom(ARoomVolume* Room)
+{
+	if (!Room || Entries.ContainsByPredicate([Room](const FRoomLookupEntry& Entry) { return Entry.Room == Room; })) { return; }
+
+	FRoomLookupEntry& Entry {Entries.AddDefaulted_GetRef()};
+	Entry.Room = Room;
+
+	if (HasWorldBegunPlay)
+	{
+		RebuildHierarchy();
+	}
+}
+
+void URoomLookupSubsystem::UnregisterRoom(ARoomVolume* Room)
+{
+	/** Everything is cleared on deinitialization, so there is no need to rebuild for every room while the world is torn down. */
+	if (GetWorld()->bIsTearingDown) { return; }
+
+	const int32 Index {Entries.IndexOfByPredicate([Room](const FRoomLookupEntry& Entry) { return Entry.Room == Room; })};
+	if (Index == INDEX_NONE) { return; }
+
+	Entries.RemoveAt(Index);
+	RebuildHierarchy();
+}
+
+ARoomVolume* URoomLookupSubsystem::FindRoomAtLocation(const FVector& Location) const
+{
+	const int32 EntryIndex {FindEntryAtLocation(Location)};
+	return EntryIndex != INDEX_NONE ? Entries[EntryIndex].Room.Get() : nullptr;
+}
+
+void URoomLookupSubsystem::FindRoomsInBox(const FBox& Box, TArray<ARoomVolume*>& OutRooms) const
+{
+	if (Nodes.IsEmpty()) { return; }
+
+	TArray<int32, TInlineAllocator<32>> Stack {0};
+	while (!Stack.IsEmpty())
+	{
+		const FRoomLookupNode& Node {Nodes[Stack.Pop(false)]};
+		if (!Node.Bounds.Intersect(Box)) { continue; }
+
+		if (Node.RoomCount == 0)
+		{
+			Stack.Add(Node.Index);
+			Stack.Add(Node.Index + 1);
+			continue;
+		}
+
+		for (int32 Index {Node.Index}; Index < Node.Index + Node.RoomCount; ++Index)
+		{
+			ARoomVolume* Room {Entries[Index].Room.Get()};
+			if (Room && Entries[Index].Bounds.Intersect(Box))
+			{
+				OutRooms.Add(Room);
+			}
+		}
+	}
+}
+
+void URoomLookupSubsystem::TrackActor(AActor* Actor)
+{
+	if (!Actor || TrackedActors.ContainsByPredicate([Actor](const FRoomTrackedActor& TrackedActor) { return TrackedActor.Actor == Actor; })) { return; }
+
+	FRoomTrackedActor& TrackedActor {TrackedActors.AddDefaulted_GetRef()};
+	TrackedActor.Actor = Actor;
+	TrackedActor.Entry = FindEntryAtLocation(Actor->GetActorLocation());
+	TrackedActor.Room = TrackedActor.Entry != INDEX_NONE ? Entries[TrackedActor.Entry].Room.Get() : nullptr;
+}
+
+void URoomLookupSubsystem::UntrackActor(AActor* Actor)
+{
+	TrackedActors.RemoveAllSwap([Actor](const FRoomTrackedActor& TrackedActor) { return TrackedActor.Actor == Actor; });
+}
+
+ARoomVolume* URoomLookupSubsystem::GetActorRoom(const AActor* Actor) const
+{
+	if (!Actor) { return nullptr; }
+
+	if (const FRoomTrackedActor* TrackedActor {TrackedActors.FindByPredicate([Actor](const FRoomTrackedActor& TrackedActor)
+	{
+		return TrackedActor.Actor == Actor;
+	})})
+	{
+		return TrackedActor->Room.Get();
+	}
+	return FindRoomAtLocation(Actor->GetActorLocation());
+}
+
+void URoomLookupSubsystem::RebuildHierarchy()
+{
+	Entries.RemoveAll([](const FRoomLookupEntry& Entry) { return !Entry.Room.IsValid(); });
+
+	for (FRoomLookupEntry& Entry : Entries)
+	{
+		const UBoxComponent* BoxComponent {Cast<UBoxComponent>(Entry.Room->GetCollisionComponent())};
+		Entry.Bounds = BoxComponent ? BoxComponent->Bounds.GetBox() : Entry.Room->GetComponentsBoundingBox(true);
+		Entry.Volume = BoxComponent ? 8.0 * BoxComponent->GetScaledBoxExtent().X * BoxComponent->GetScaledBoxExtent().Y * BoxComponent->GetScaledBoxExtent().Z
+			: Entry.Bounds.GetVolume();
+		Entry.HasOverlappingRooms = false;
+	}
+
+	Nodes.Reset();
+	if (!Entries.IsEmpty())
+	{
+		Nodes.Reserve(Entries.Num() * 2);
+		Nodes.AddDefaulted();
+		BuildNode(0, 0, Entries.Num());
+	}
+
+	TArray<ARoomVolume*> OverlappingRooms;
+	for (FRoomLookupEntry& Entry : Entries)
+	{
+		OverlappingRooms.Reset();
+		FindRoomsInBox(Entry.Bounds.ExpandBy(-1.0), OverlappingRooms);
+		Entry.HasOverlappingRooms = OverlappingRooms.Num() > 1;
+	}
+
+	/** Entry indices have changed, so every tracked actor has to look up its room again. */
+	for (FRoomTrackedActor& TrackedActor : TrackedActors)
+	{
+		TrackedActor.Entry = INDEX_NONE;
+	}
+
+	UE_LOG(LogRoomLookup, Verbose, TEXT("Built the room hierarchy with %d rooms and %d nodes."), Entries.Num(), Nodes.Num());
+}
+
+void URoomLookupSubsystem::BuildNode(const int32 NodeIndex, const int32 Begin, const int32 End)
+{
+	FBox Bounds {ForceInit};
+	for (int32 Index {Begin}; Index < End; ++Index)
+	{
+		Bounds += Entries[Index].Bounds;
+	}
+	Nodes[NodeIndex].Bounds = Bounds;
+
+	if (End - Begin <= MaxLeafRoomCount)
+	{
+		Nodes[NodeIndex].Index = Begin;
+		Nodes[NodeIndex].RoomCount = End - Begin;
+		return;
+	}
+
+	/** Split at the median along the longest axis of the bounds. */
+	const FVector Size {Bounds.GetSize()};
+	const int32 Axis {Size.X >= Size.Y && Size.X >= Size.Z ? 0 : (Size.Y >= Size.Z ? 1 : 2)};
+	MakeArrayView(Entries.GetData() + Begin, End - Begin).Sort([Axis](const FRoomLookupEntry& A, const FRoomLookupEntry& B)
+	{
+		return A.Bounds.GetCenter()[Axis] < B.Bounds.GetCenter()[Axis];
+	});
+
+	/** The children are added next to each other, so a node only has to store the first. */
+	const int32 Middle {(Begin + End) / 2};
+	const int32 FirstChild {Nodes.AddDefaulted(2)};
+	Nodes[NodeIndex].Index = FirstChild;
+
+	BuildNode(FirstChild, Begin, Middle);
+	BuildNode(FirstChild + 1, Middle, End);
+}
+
+int32 URoomLookupSubsystem::FindEntryAtLocation(const FVector& Location) const
+{
+	if (Nodes.IsEmpty()) { return INDEX_NONE; }
+
+	int32 BestEntry {INDEX_NONE};
+	double BestVolume {TNumericLimits<double>::Max()};
+
+	TArray<int32, TInlineAllocator<32>> Stack {0};
+	while (!Stack.IsEmpty())
+	{
+		const FRoomLookupNode& Node {Nodes[Stack.Pop(false)]};
+		if (!Node.Bounds.IsInsideOrOn(Location)) { continue; }
+
+		if (Node.RoomCount == 0)
+		{
+			Stack.Add(Node.Index);
+			Stack.Add(Node.Index + 1);
+			continue;
+		}
+
+		for (int32 Index {Node.Index}; Index < Node.Index + Node.RoomCount; ++Index)
+		{
+			const FRoomLookupEntry& Entry {Entries[Index]};
+			if (Entry.Volume >= BestVolume || !Entry.Bounds.IsInsideOrOn(Location)) { continue; }
+
+			const ARoomVolume* Room {Entry.Room.Get()};
+			if (Room && Room->IsLocationInRoom(Location))
+			{
+				BestEntry = Index;
+				BestVolume = Entry.Volume;
+			}
+		}
+	}
+	return BestEntry;
+}
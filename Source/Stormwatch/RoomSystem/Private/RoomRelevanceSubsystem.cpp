@@ -0,0 +1,212 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "RoomRelevanceSubsystem.h"
+#include "RoomAcousticsSubsystem.h"
+#include "RoomRelevantObjectInterface.h"
+#include "RoomVolume.h"
+#include "SlidingDoor.h"
+#include "Components/PrimitiveComponent.h"
+
+DEFINE_LOG_CATEGORY_CLASS(URoomRelevanceSubsystem, LogRoomRelevance);
+
+void URoomRelevanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	RoomAcousticsSubsystem = Collection.InitializeDependency<URoomAcousticsSubsystem>();
+	if (RoomAcousticsSubsystem)
+	{
+		RoomAcousticsSubsystem->OnRoomGraphRebuilt.AddUObject(this, &URoomRelevanceSubsystem::HandleRoomGraphRebuilt);
+		RoomAcousticsSubsystem->OnListenerRoomChanged.AddUObject(this, &URoomRelevanceSubsystem::UpdateRelevance);
+	}
+}
+
+void URoomRelevanceSubsystem::Deinitialize()
+{
+	if (RoomAcousticsSubsystem)
+	{
+		RoomAcousticsSubsystem->OnRoomGraphRebuilt.RemoveAll(this);
+		RoomAcousticsSubsystem->OnListenerRoomChanged.RemoveAll(this);
+		RoomAcousticsSubsystem = nullptr;
+	}
+
+	for (FRoomRelevantActor& RelevantActor : Actors)
+	{
+		ResumeActor(RelevantActor);
+	}
+	Actors.Empty();
+	RelevantRooms.Empty();
+
+	Super::Deinitialize();
+}
+
+void URoomRelevanceSubsystem::RegisterActor(AActor* Actor)
+{
+	if (!Actor) { return; }
+	if (Actors.ContainsByPredicate([Actor](const FRoomRelevantActor& RelevantActor) { return RelevantActor.Actor == Actor; })) { return; }
+
+	FRoomRelevantActor& RelevantActor {Actors.AddDefaulted_GetRef()};
+	RelevantActor.Actor = Actor;
+	UpdateActor(RelevantActor);
+}
+
+void URoomRelevanceSubsystem::UnregisterActor(AActor* Actor)
+{
+	const int32 Index {Actors.IndexOfByPredicate([Actor](const FRoomRelevantActor& RelevantActor) { return RelevantActor.Actor == Actor; })};
+	if (Index == INDEX_NONE) { return; }
+
+	ResumeActor(Actors[Index]);
+	Actors.RemoveAtSwap(Index);
+}
+
+void URoomRelevanceSubsystem::SetRelevantPortalCount(const int32 PortalCount)
+{
+	if (PortalCount == RelevantPortalCount) { return; }
+
+	RelevantPortalCount = FMath::Max(0, PortalCount);
+	UpdateRelevance();
+}
+
+bool URoomRelevanceSubsystem::IsActorSuspended(const AActor* Actor) const
+{
+	const FRoomRelevantActor* RelevantActor {Actors.FindByPredicate([Actor](const FRoomRelevantActor& RelevantActor)
+	{
+		return RelevantActor.Actor == Actor;
+	})};
+	return RelevantActor && RelevantActor->IsSuspended;
+}
+
+void URoomRelevanceSubsystem::HandleRoomGraphRebuilt()
+{
+	HasRoomGraph = true;
+
+	for (FRoomRelevantActor& RelevantActor : Actors)
+	{
+		RelevantActor.HasRooms = false;
+	}
+	UpdateRelevance();
+}
+
+void URoomRelevanceSubsystem::UpdateRelevance()
+{
+	if (!RoomAcousticsSubsystem || !HasRoomGraph) { return; }
+
+	RelevantRooms.Reset();
+	RoomAcousticsSubsystem->FindRoomsWithinPortals(RoomAcousticsSubsystem->GetListenerRoom(), RelevantPortalCount, RelevantRooms);
+
+	Actors.RemoveAllSwap([](const FRoomRelevantActor& RelevantActor) { return !RelevantActor.Actor.IsValid(); });
+
+	int32 SuspendedCount {0};
+	for (FRoomRelevantActor& RelevantActor : Actors)
+	{
+		UpdateActor(RelevantActor);
+		SuspendedCount += RelevantActor.IsSuspended;
+	}
+
+	UE_LOG(LogRoomRelevance, Verbose, TEXT("%d relevant rooms, %d of %d actors suspended."), RelevantRooms.Num(), SuspendedCount, Actors.Num());
+}
+
+void URoomRelevanceSubsystem::UpdateActor(FRoomRelevantActor& RelevantActor)
+{
+	if (!RoomAcousticsSubsystem || !HasRoomGraph) { return; }
+
+	const AActor* Actor {RelevantActor.Actor.Get()};
+	if (!Actor) { return; }
+
+	if (!RelevantActor.HasRooms)
+	{
+		RelevantActor.Rooms.Reset();
+		if (const ASlidingDoor* Door {Cast<ASlidingDoor>(Actor)})
+		{
+			RoomAcousticsSubsystem->FindRoomsConnectedByDoor(Door, RelevantActor.Rooms);
+		}
+		if (RelevantActor.Rooms.IsEmpty())
+		{
+			RelevantActor.Rooms.Add(RoomAcousticsSubsystem->FindRoomAtLocation(Actor->GetActorLocation()));
+		}
+		RelevantActor.HasRooms = true;
+	}
+
+	const bool IsRelevant {RelevantActor.Rooms.ContainsByPredicate([this](const ARoomVolume* Room) { return RelevantRooms.Contains(Room); })};
+	if (IsRelevant)
+	{
+		ResumeActor(RelevantActor);
+	}
+	else
+	{
+		SuspendActor(RelevantActor);
+	}
+}
+
+void URoomRelevanceSubsystem::SuspendActor(FRoomRelevantActor& RelevantActor)
+{
+	AActor* Actor {RelevantActor.Actor.Get()};
+	if (!Actor || RelevantActor.IsSuspended) { return; }
+
+	RelevantActor.IsSuspended = true;
+
+	RelevantActor.IsActorTickSuspended = Actor->IsActorTickEnabled();
+	Actor->SetActorTickEnabled(false);
+
+	TInlineComponentArray<UActorComponent*> Components;
+	Actor->GetComponents(Components);
+	for (UActorComponent* Component : Components)
+	{
+		if (Component->IsComponentTickEnabled())
+		{
+			Component->SetComponentTickEnabled(false);
+			RelevantActor.SuspendedTickComponents.Add(Component);
+		}
+
+		UPrimitiveComponent* PrimitiveComponent {Cast<UPrimitiveComponent>(Component)};
+		if (PrimitiveComponent && PrimitiveComponent->BodyInstance.bNotifyRigidBodyCollision)
+		{
+			PrimitiveComponent->SetNotifyRigidBodyCollision(false);
+			RelevantActor.SuspendedHitComponents.Add(PrimitiveComponent);
+		}
+	}
+
+	if (Actor->Implements<URoomRelevantObject>())
+	{
+		IRoomRelevantObject::Execute_OnRoomSuspended(Actor);
+	}
+}
+
+void URoomRelevanceSubsystem::ResumeActor(FRoomRelevantActor& RelevantActor)
+{
+	AActor* Actor {RelevantActor.Actor.Get()};
+	if (!Actor || !RelevantActor.IsSuspended) { return; }
+
+	RelevantActor.IsSuspended = false;
+
+	if (RelevantActor.IsActorTickSuspended)
+	{
+		Actor->SetActorTickEnabled(true);
+	}
+
+	for (const TWeakObjectPtr<UActorComponent>& Component : RelevantActor.SuspendedTickComponents)
+	{
+		if (Component.IsValid())
+		{
+			Component->SetComponentTickEnabled(true);
+		}
+	}
+
+	for (const TWeakObjectPtr<UPrimitiveComponent>& PrimitiveComponent : RelevantActor.SuspendedHitComponents)
+	{
+		if (PrimitiveComponent.IsValid())
+		{
+			PrimitiveComponent->SetNotifyRigidBodyCollision(true);
+		}
+	}
+
+	RelevantActor.IsActorTickSuspended = false;
+	RelevantActor.SuspendedTickComponents.Reset();
+	RelevantActor.SuspendedHitComponents.Reset();
+
+	if (Actor->Implements<URoomRelevantObject>())
+	{
+		IRoomRelevantObject::Execute_OnRoomResumed(Actor);
+	}
+}
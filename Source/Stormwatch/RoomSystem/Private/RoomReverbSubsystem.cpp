@@ -0,0 +1,141 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "RoomReverbSubsystem.h"
+#include "RoomAudioComponent.h"
+#include "SubmixEffects/SubmixEffectConvolutionReverb.h"
+
+void URoomReverbSubsystem::Deinitialize()
+{
+#if WITH_EDITOR
+	for (TPair<UDataTable*, FRoomReverbIndex>& Pair : Indices)
+	{
+		if (Pair.Key)
+		{
+			Pair.Key->OnDataTableChanged().Remove(Pair.Value.DataTableChangedHandle);
+		}
+	}
+#endif
+	Indices.Empty();
+
+	Super::Deinitialize();
+}
+
+USubmixEffectConvolutionReverbPreset* URoomReverbSubsystem::FindMatchingImpulseResponse(UDataTable* DataTable, const float Volume,
+	const float ShapeRatio, const float Reflectivity)
+{
+	if (!DataTable) { return nullptr; }
+
+	FRoomReverbIndex* Index {Indices.Find(DataTable)};
+	if (!Index)
+	{
+		Index = &Indices.Add(DataTable);
+		Index->Build(DataTable);
+
+#if WITH_EDITOR
+		Index->DataTableChangedHandle = DataTable->OnDataTableChanged().AddUObject(this, &URoomReverbSubsystem::HandleDataTableChanged, DataTable);
+#endif
+	}
+
+	return Index->FindNearest(Volume, ShapeRatio, Reflectivity);
+}
+
+#if WITH_EDITOR
+void URoomReverbSubsystem::HandleDataTableChanged(UDataTable* DataTable)
+{
+	if (FRoomReverbIndex* Index {Indices.Find(DataTable)})
+	{
+		Index->Build(DataTable);
+	}
+}
+#endif
+
+FVector3f FRoomReverbIndex::MakePoint(const float Volume, const float ShapeRatio, const float Reflectivity)
+{
+	/** weights for each parameter. */
+	constexpr float VolumeWeight = 3.0f;
+	constexpr float RatioWeight = 1.0f;
+	constexpr float ReflectivityWeight = 1.0f;
+
+	/** Value for volume normalization. */
+	constexpr float MaxVolume = 500.0f;
+
+	return FVector3f(FMath::Clamp(Volume, 0.0f, MaxVolume) / MaxVolume * VolumeWeight, ShapeRatio * RatioWeight, Reflectivity * ReflectivityWeight);
+}
+
+void FRoomReverbIndex::Build(const UDataTable* DataTable)
+{
+	Points.Reset();
+	ImpulseResponses.Reset();
+
+	TArray<TPair<FVector3f, USubmixEffectConvolutionReverbPreset*>> Rows;
+	DataTable->ForeachRow<FRoomReverbSettings>(TEXT("FRoomReverbIndex::Build"), [&Rows](const FName& Key, const FRoomReverbSettings& Row)
+	{
+		Rows.Emplace(MakePoint(Row.RoomVolume, Row.ShapeRatio, Row.Reflectivity), Row.ImpulseResponseA);
+	});
+
+	/** Sort every range on the axis of its depth, so that its middle element splits it in half. */
+	TFunction<void(int32, int32, int32)> SortRange;
+	SortRange = [&Rows, &SortRange](const int32 Begin, const int32 End, const int32 Axis)
+	{
+		if (End - Begin < 2) { return; }
+
+		TArrayView<TPair<FVector3f, USubmixEffectConvolutionReverbPreset*>> Range {MakeArrayView(Rows.GetData() + Begin, End - Begin)};
+		Range.Sort([Axis](const auto& A, const auto& B) { return A.Key[Axis] < B.Key[Axis]; });
+
+		const int32 Middle {(Begin + End) / 2};
+		SortRange(Begin, Middle, (Axis + 1) % 3);
+		SortRange(Middle + 1, End, (Axis + 1) % 3);
+	};
+	SortRange(0, Rows.Num(), 0);
+
+	Points.Reserve(Rows.Num());
+	ImpulseResponses.Reserve(Rows.Num());
+	for (const TPair<FVector3f, USubmixEffectConvolutionReverbPreset*>& Row : Rows)
+	{
+		Points.Add(Row.Key);
+		ImpulseResponses.Add(Row.Value);
+	}
+}
+
+USubmixEffectConvolutionReverbPreset* FRoomReverbIndex::FindNearest(const float Volume, const float ShapeRatio, const float Reflectivity) const
+{
+	if (Points.IsEmpty()) { return nullptr; }
+
+	const FVector3f Target {MakePoint(Volume, ShapeRatio, Reflectivity)};
+	int32 BestIndex {INDEX_NONE};
+	float BestDifference {MAX_flt};
+
+	/** The difference is the sum of the absolute differences of the parameters,
+	 *	so the far side of a split only has to be visited if the split is closer than the best match. */
+	TFunction<void(int32, int32, int32)> SearchRange;
+	SearchRange = [&](const int32 Begin, const int32 End, const int32 Axis)
+	{
+		if (Begin >= End) { return; }
+
+		const int32 Middle {(Begin + End) / 2};
+		const FVector3f& Point {Points[Middle]};
+		const float Difference {FMath::Abs(Point.X - Target.X) + FMath::Abs(Point.Y - Target.Y) + FMath::Abs(Point.Z - Target.Z)};
+		if (Difference < BestDifference)
+		{
+			BestDifference = Difference;
+			BestIndex = Middle;
+		}
+
+		const float SplitDifference {Target[Axis] - Point[Axis]};
+		const int32 NextAxis {(Axis + 1) % 3};
+		if (SplitDifference < 0.0f)
+		{
+			SearchRange(Begin, Middle, NextAxis);
+			if (-SplitDifference < BestDifference) { SearchRange(Middle + 1, End, NextAxis); }
+		}
+		else
+		{
+			SearchRange(Middle + 1, End, NextAxis);
+			if (SplitDifference < BestDifference) { SearchRange(Begin, Middle, NextAxis); }
+		}
+	};
+	SearchRange(0, Points.Num(), 0);
+
+	return ImpulseResponses[BestIndex];
+}
@@ -0,0 +1,205 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#include "RoomStreamingSubsystem.h"
+#include "RoomAcousticsSubsystem.h"
+#include "RoomLookupSubsystem.h"
+#include "RoomVolume.h"
+#include "EngineUtils.h"
+#include "Engine/LevelStreaming.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_STATS_GROUP(TEXT("Room Streaming"), STATGROUP_RoomStreaming, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Update Streaming"), STAT_RoomStreamingUpdate, STATGROUP_RoomStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loaded Levels"), STAT_RoomStreamingLoadedLevels, STATGROUP_RoomStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pending Levels"), STAT_RoomStreamingPendingLevels, STATGROUP_RoomStreaming);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Last Load Time"), STAT_RoomStreamingLastLoadTime, STATGROUP_RoomStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitches"), STAT_RoomStreamingHitches, STATGROUP_RoomStreaming);
+DECLARE_MEMORY_STAT(TEXT("Used Physical Memory"), STAT_RoomStreamingUsedPhysical, STATGROUP_RoomStreaming);
+
+DEFINE_LOG_CATEGORY_CLASS(URoomStreamingSubsystem, LogRoomStreaming);
+
+void URoomStreamingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	RoomLookupSubsystem = Collection.InitializeDependency<URoomLookupSubsystem>();
+	RoomAcousticsSubsystem = Collection.InitializeDependency<URoomAcousticsSubsystem>();
+	if (RoomAcousticsSubsystem)
+	{
+		RoomAcousticsSubsystem->OnRoomGraphRebuilt.AddWeakLambda(this, [this]() { HasRoomGraph = true; });
+	}
+}
+
+void URoomStreamingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	/** Map every room with a streaming level to the streaming level of the world with the same package. */
+	for (TActorIterator<ARoomVolume> It(&InWorld); It; ++It)
+	{
+		const TSoftObjectPtr<UWorld>& StreamingLevel {It->GetStreamingLevel()};
+		if (StreamingLevel.IsNull()) { continue; }
+
+		const FName PackageName {*StreamingLevel.GetLongPackageName()};
+		ULevelStreaming* const* Level {InWorld.GetStreamingLevels().FindByPredicate([PackageName](const ULevelStreaming* Level)
+		{
+			return Level && Level->GetWorldAssetPackageFName() == PackageName;
+		})};
+		if (!Level)
+		{
+			UE_LOG(LogRoomStreaming, Warning, TEXT("Room '%s' references level '%s', which is not a streaming level of the world."),
+				*It->GetName(), *PackageName.ToString());
+			continue;
+		}
+
+		FRoomStreamingLevel* RoomLevel {Levels.FindByPredicate([Level](const FRoomStreamingLevel& RoomLevel) { return RoomLevel.Level == *Level; })};
+		if (!RoomLevel)
+		{
+			RoomLevel = &Levels.AddDefaulted_GetRef();
+			RoomLevel->Level = *Level;
+		}
+		RoomLevel->Rooms.Add(*It);
+	}
+
+	UE_LOG(LogRoomStreaming, Log, TEXT("Streaming %d room levels."), Levels.Num());
+}
+
+void URoomStreamingSubsystem::Deinitialize()
+{
+	if (RoomAcousticsSubsystem)
+	{
+		RoomAcousticsSubsystem->OnRoomGraphRebuilt.RemoveAll(this);
+		RoomAcousticsSubsystem = nullptr;
+	}
+	RoomLookupSubsystem = nullptr;
+	Levels.Empty();
+
+	Super::Deinitialize();
+}
+
+void URoomStreamingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Levels.IsEmpty()) { return; }
+
+	UpdateInstrumentation(DeltaTime);
+
+	UpdateTimer += DeltaTime;
+	if (UpdateTimer < UpdateInterval) { return; }
+	UpdateTimer = 0.0f;
+
+	UpdateStreaming();
+}
+
+TStatId URoomStreamingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URoomStreamingSubsystem, STATGROUP_Tickables);
+}
+
+void URoomStreamingSubsystem::UpdateStreaming()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RoomStreamingUpdate);
+
+	if (!HasRoomGraph || !RoomAcousticsSubsystem) { return; }
+
+	const APlayerController* PlayerController {GetWorld()->GetFirstPlayerController()};
+	const APawn* Pawn {PlayerController ? PlayerController->GetPawn() : nullptr};
+	if (!Pawn) { return; }
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector Location {Pawn->GetActorLocation()};
+
+	/** Load the rooms around the player, and around where the player is heading and looking. */
+	TSet<const ARoomVolume*> RequiredRooms;
+	AddRoomsAroundLocation(Location, LoadPortalCount, RequiredRooms);
+	AddRoomsAroundLocation(Location + Pawn->GetVelocity() * PrefetchTime, LoadPortalCount, RequiredRooms);
+	AddRoomsAroundLocation(ViewLocation + ViewRotation.Vector() * PrefetchViewDistance, LoadPortalCount, RequiredRooms);
+
+	TSet<const ARoomVolume*> KeptRooms {RequiredRooms};
+	AddRoomsAroundLocation(Location, FMath::Max(UnloadPortalCount, LoadPortalCount), KeptRooms);
+
+	for (FRoomStreamingLevel& RoomLevel : Levels)
+	{
+		ULevelStreaming* Level {RoomLevel.Level.Get()};
+		if (!Level) { continue; }
+
+		auto IsAnyRoomIn = [&RoomLevel](const TSet<const ARoomVolume*>& Rooms)
+		{
+			return RoomLevel.Rooms.ContainsByPredicate([&Rooms](const TWeakObjectPtr<ARoomVolume>& Room) { return Rooms.Contains(Room.Get()); });
+		};
+
+		if (!Level->ShouldBeLoaded() && IsAnyRoomIn(RequiredRooms))
+		{
+			Level->SetShouldBeLoaded(true);
+			Level->SetShouldBeVisible(true);
+			RoomLevel.LoadStartTime = FPlatformTime::Seconds();
+			RoomLevel.LoadStartMemory = FPlatformMemory::GetStats().UsedPhysical;
+			UE_LOG(LogRoomStreaming, Verbose, TEXT("Loading level '%s'."), *Level->GetWorldAssetPackageName());
+		}
+		else if (Level->ShouldBeLoaded() && !IsAnyRoomIn(KeptRooms))
+		{
+			Level->SetShouldBeVisible(false);
+			Level->SetShouldBeLoaded(false);
+			RoomLevel.LoadStartTime = -1.0;
+			UE_LOG(LogRoomStreaming, Verbose, TEXT("Unloading level '%s'."), *Level->GetWorldAssetPackageName());
+		}
+	}
+}
+
+void URoomStreamingSubsystem::UpdateInstrumentation(const float DeltaTime)
+{
+	int32 LoadedLevelCount {0};
+	int32 PendingLevelCount {0};
+
+	for (FRoomStreamingLevel& RoomLevel : Levels)
+	{
+		const ULevelStreaming* Level {RoomLevel.Level.Get()};
+		if (!Level) { continue; }
+
+		const bool IsVisible {Level->IsLevelVisible()};
+		LoadedLevelCount += Level->IsLevelLoaded();
+		PendingLevelCount += Level->ShouldBeVisible() != IsVisible || Level->ShouldBeLoaded() != Level->IsLevelLoaded();
+
+		if (RoomLevel.LoadStartTime < 0.0 || !IsVisible) { continue; }
+
+		const uint64 UsedPhysical {FPlatformMemory::GetStats().UsedPhysical};
+		Stats.LastLoadTime = FPlatformTime::Seconds() - RoomLevel.LoadStartTime;
+		Stats.MaxLoadTime = FMath::Max(Stats.MaxLoadTime, Stats.LastLoadTime);
+		Stats.LastLoadMemory = (static_cast<double>(UsedPhysical) - static_cast<double>(RoomLevel.LoadStartMemory)) / (1024.0 * 1024.0);
+		RoomLevel.LoadStartTime = -1.0;
+
+		SET_FLOAT_STAT(STAT_RoomStreamingLastLoadTime, Stats.LastLoadTime);
+		SET_MEMORY_STAT(STAT_RoomStreamingUsedPhysical, UsedPhysical);
+		UE_LOG(LogRoomStreaming, Log, TEXT("Loaded level '%s' in %.2f s, used physical memory changed by %.1f MB."),
+			*Level->GetWorldAssetPackageName(), Stats.LastLoadTime, Stats.LastLoadMemory);
+	}
+
+	/** Frames are checked while levels are streaming, and for one frame after, since making a level visible finishes at the end of a frame. */
+	if (PendingLevelCount > 0 || IsHitchCheckPending)
+	{
+		if (DeltaTime > HitchThreshold)
+		{
+			++Stats.HitchCount;
+			Stats.LongestHitch = FMath::Max(Stats.LongestHitch, DeltaTime);
+			UE_LOG(LogRoomStreaming, Warning, TEXT("Frame took %.1f ms while %d room levels were streaming."), DeltaTime * 1000.0f, PendingLevelCount);
+		}
+	}
+	IsHitchCheckPending = PendingLevelCount > 0;
+
+	Stats.LoadedLevelCount = LoadedLevelCount;
+	Stats.PendingLevelCount = PendingLevelCount;
+	SET_DWORD_STAT(STAT_RoomStreamingLoadedLevels, LoadedLevelCount);
+	SET_DWORD_STAT(STAT_RoomStreamingPendingLevels, PendingLevelCount);
+	SET_DWORD_STAT(STAT_RoomStreamingHitches, Stats.HitchCount);
+}
+
+void URoomStreamingSubsystem::AddRoomsAroundLocation(const FVector& Location, const int32 PortalCount, TSet<const ARoomVolume*>& OutRooms) const
+{
+	const ARoomVolume* Room {RoomLookupSubsystem ? RoomLookupSubsystem->FindRoomAtLocation(Location) : nullptr};
+	RoomAcousticsSubsystem->FindRoomsWithinPortals(Room, PortalCount, OutRooms);
+}
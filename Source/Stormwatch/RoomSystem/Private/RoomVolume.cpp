@@ -4,7 +4,9 @@
 #include "RoomVolume.h"
 #include "LogCategories.h"
 #include "RoomComponent.h"
-#include "Components/ShapeComponent.h"
+#include "RoomAcousticsSubsystem.h"
+#include "RoomLookupSubsystem.h"
+#include "Components/BoxComponent.h"
 
 ARoomVolume::ARoomVolume()
 {
@@ -23,6 +25,159 @@ void ARoomVolume::PostInitProperties()
 	}
 }
 
+void ARoomVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (URoomLookupSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<URoomLookupSubsystem>() : nullptr})
+	{
+		Subsystem->RegisterRoom(this);
+	}
+	if (URoomAcousticsSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<URoomAcousticsSubsystem>() : nullptr})
+	{
+		Subsystem->RegisterRoom(this);
+	}
+}
+
+void ARoomVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (URoomAcousticsSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<URoomAcousticsSubsystem>() : nullptr})
+	{
+		Subsystem->UnregisterRoom(this);
+	}
+	if (URoomLookupSubsystem* Subsystem {GetWorld() ? GetWorld()->GetSubsystem<URoomLookupSubsystem>() : nullptr})
+	{
+		Subsystem->UnregisterRoom(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ARoomVolume::IsLocationInRoom(const FVector& Location) const
+{
+	const UBoxComponent* BoxComponent {Cast<UBoxComponent>(GetCollisionComponent())};
+	if (!BoxComponent) { return false; }
+
+	const FVector LocalLocation {BoxComponent->GetComponentTransform().InverseTransformPosition(Location)};
+	const FVector Extent {BoxComponent->GetUnscaledBoxExtent()};
+	return FMath::Abs(LocalLocation.X) <= Extent.X && FMath::Abs(LocalLocation.Y) <= Extent.Y && FMath::Abs(LocalLocation.Z) <= Extent.Z;
+}
+
+#if WITH_EDITOR
+void ARoomVolume::AnalyzeRoom()
+{
+	UWorld* World {GetWorld()};
+	const UBoxComponent* BoxComponent {Cast<UBoxComponent>(GetCollisionComponent())};
+	if (!World || !BoxComponent) { return; }
+
+	const FTransform& BoxTransform {BoxComponent->GetComponentTransform()};
+	const FVector Extent {BoxComponent->GetUnscaledBoxExtent()};
+
+	/** Rays are spread evenly over the sphere with a Fibonacci lattice. The six box axes are traced separately for the shape ratio. */
+	constexpr int32 RayCount {128};
+	TArray<FVector> RayDirections;
+	RayDirections.Reserve(RayCount);
+	for (int32 Index {0}; Index < RayCount; ++Index)
+	{
+		const float Z {1.0f - (2.0f * Index + 1.0f) / RayCount};
+		const float Radius {FMath::Sqrt(1.0f - Z * Z)};
+		const float Angle {Index * PI * (3.0f - FMath::Sqrt(5.0f))};
+		RayDirections.Add(FVector(Radius * FMath::Cos(Angle), Radius * FMath::Sin(Angle), Z));
+	}
+
+	const FVector AxisDirections[6] {BoxTransform.GetUnitAxis(EAxis::X), -BoxTransform.GetUnitAxis(EAxis::X), BoxTransform.GetUnitAxis(EAxis::Y),
+		-BoxTransform.GetUnitAxis(EAxis::Y), BoxTransform.GetUnitAxis(EAxis::Z), -BoxTransform.GetUnitAxis(EAxis::Z)};
+
+	FCollisionQueryParams Params {SCENE_QUERY_STAT(AnalyzeRoom), false, this};
+
+	/** Returns the distance from a location to the edge of the box along a world direction, and traces it. */
+	auto TraceRay = [&](const FVector& Start, const FVector& Direction, bool& OutIsHit) -> double
+	{
+		const FVector LocalStart {BoxTransform.InverseTransformPosition(Start)};
+		const FVector LocalDirection {BoxTransform.InverseTransformVector(Direction)};
+
+		double ExitDistance {TNumericLimits<double>::Max()};
+		for (int32 Axis {0}; Axis < 3; ++Axis)
+		{
+			if (FMath::IsNearlyZero(LocalDirection[Axis])) { continue; }
+			const double Boundary {LocalDirection[Axis] > 0.0 ? Extent[Axis] : -Extent[Axis]};
+			ExitDistance = FMath::Min(ExitDistance, (Boundary - LocalStart[Axis]) / LocalDirection[Axis]);
+		}
+
+		FHitResult HitResult;
+		OutIsHit = World->LineTraceSingleByChannel(HitResult, Start, Start + Direction * ExitDistance, ECC_Visibility, Params);
+		return OutIsHit ? HitResult.Distance : ExitDistance;
+	};
+
+	/** Sample from a 3x3x3 grid of locations in the inner half of the room, skipping locations that are inside geometry. */
+	constexpr int32 GridSize {3};
+	double VolumeSum {0.0};
+	double RatioSum {0.0};
+	double ReflectivitySum {0.0};
+	int32 SampleCount {0};
+
+	for (int32 X {0}; X < GridSize; ++X)
+	{
+		for (int32 Y {0}; Y < GridSize; ++Y)
+		{
+			for (int32 Z {0}; Z < GridSize; ++Z)
+			{
+				const FVector LocalLocation {FVector(X, Y, Z) / (GridSize - 1) * 2.0 - FVector::OneVector};
+				const FVector Location {BoxTransform.TransformPosition(LocalLocation * Extent * 0.5)};
+
+				if (World->OverlapAnyTestByChannel(Location, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(5.0f), Params)) { continue; }
+
+				/** The volume visible from a location is the integral of a third of the cubed distance over the sphere. */
+				double CubedDistanceSum {0.0};
+				int32 HitCount {0};
+				for (const FVector& Direction : RayDirections)
+				{
+					bool IsHit {false};
+					CubedDistanceSum += FMath::Pow(TraceRay(Location, Direction, IsHit), 3.0);
+					HitCount += IsHit;
+				}
+
+				double AxisDistances[6];
+				for (int32 Axis {0}; Axis < 6; ++Axis)
+				{
+					bool IsHit {false};
+					AxisDistances[Axis] = TraceRay(Location, AxisDirections[Axis], IsHit);
+				}
+				const FVector Dimensions {AxisDistances[0] + AxisDistances[1], AxisDistances[2] + AxisDistances[3], AxisDistances[4] + AxisDistances[5]};
+
+				VolumeSum += 4.0 / 3.0 * PI * CubedDistanceSum / RayCount;
+				RatioSum += Dimensions.GetMax() > 0.0 ? Dimensions.GetMin() / Dimensions.GetMax() : 0.0;
+				ReflectivitySum += static_cast<double>(HitCount) / RayCount;
+				++SampleCount;
+			}
+		}
+	}
+
+	if (SampleCount == 0)
+	{
+		UE_LOG(LogRoomVolume, Warning, TEXT("Could not analyze room '%s' because every sample location is inside geometry."), *GetName());
+		return;
+	}
+
+	Modify();
+
+	/** Convert from cubic centimeters to cubic meters. */
+	Volume = VolumeSum / SampleCount / 1000000.0;
+	RoomRatio = RatioSum / SampleCount;
+	Reflectivity = ReflectivitySum / SampleCount;
+
+	UE_LOG(LogRoomVolume, Log, TEXT("Analyzed room '%s': volume %.1f m3, ratio %.2f, reflectivity %.2f."), *GetName(), Volume, RoomRatio, Reflectivity);
+
+	TArray<URoomComponent*> RoomComponents;
+	GetComponents(RoomComponents);
+	for (URoomComponent* RoomComponent : RoomComponents)
+	{
+		RoomComponent->Modify();
+		RoomComponent->ConstructComponent();
+	}
+}
+#endif
+
 void ARoomVolume::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
@@ -47,6 +202,13 @@ void ARoomVolume::NotifyActorBeginOverlap(AActor* OtherActor)
 	{
 		OverlappingPawns.AddUnique(OverlappingPawn);
 		OnPawnEnter.Broadcast(OverlappingPawn);
+		if (OverlappingPawn->IsPlayerControlled())
+		{
+			if (URoomAcousticsSubsystem* Subsystem {GetWorld()->GetSubsystem<URoomAcousticsSubsystem>()})
+			{
+				Subsystem->HandlePlayerEnterRoom(this);
+			}
+		}
 		UE_LOG(LogRoomVolume, Verbose, TEXT("Pawn '%s' has entered room '%s'."), *OtherActor->GetName(), *this->GetName());
 	}
 }
@@ -59,6 +221,13 @@ void ARoomVolume::NotifyActorEndOverlap(AActor* OtherActor)
 	{
 		OverlappingPawns.Remove(OverlappingPawn);
 		OnPawnLeave.Broadcast(OverlappingPawn);
+		if (OverlappingPawn->IsPlayerControlled())
+		{
+			if (URoomAcousticsSubsystem* Subsystem {GetWorld()->GetSubsystem<URoomAcousticsSubsystem>()})
+			{
+				Subsystem->HandlePlayerLeaveRoom(this);
+			}
+		}
 		UE_LOG(LogRoomVolume, Verbose, TEXT("Pawn '%s' has left room '%s'."), *OtherActor->GetName(), *this->GetName());
 	}
 }
@@ -0,0 +1,194 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RoomAcousticsSubsystem.generated.h"
+
+class ARoomVolume;
+class ASlidingDoor;
+class UAudioComponent;
+class URoomLookupSubsystem;
+enum class EDoorState : uint8;
+
+DECLARE_MULTICAST_DELEGATE(FOnRoomGraphChangedDelegate);
+
+/** How a sound reaches the listener through the room graph. */
+USTRUCT(BlueprintType)
+struct FRoomSoundPropagation
+{
+	GENERATED_BODY()
+
+	/** How much the sound is muffled by the rooms and closed doors it passes through, between 0 and 1. */
+	UPROPERTY(BlueprintReadOnly, Category = "Propagation")
+	float Occlusion {0.0f};
+
+	/** How far the sound has to bend around the portal it arrives through, between 0 and 1. */
+	UPROPERTY(BlueprintReadOnly, Category = "Propagation")
+	float Obstruction {0.0f};
+
+	/** The location the sound appears to come from: along the first portal on the path, at the distance the sound travels. */
+	UPROPERTY(BlueprintReadOnly, Category = "Propagation")
+	FVector ApparentLocation {FVector::ZeroVector};
+
+	/** The distance the sound travels through the portals to reach the listener. */
+	UPROPERTY(BlueprintReadOnly, Category = "Propagation", Meta = (Units = "Centimeters"))
+	float PathDistance {0.0f};
+};
+
+/** A portal in the room graph. Portals connect two rooms, where room 0 is the exterior. */
+struct FRoomAcousticPortal
+{
+	FVector Location {FVector::ZeroVector};
+	int32 RoomA {0};
+	int32 RoomB {0};
+	TWeakObjectPtr<ASlidingDoor> Door;
+	float OpenOcclusion {0.0f};
+	float ClosedOcclusion {0.0f};
+
+	/** The occlusion of the portal for the current state of its door. */
+	float Occlusion {0.0f};
+};
+
+/** A sound source that the subsystem updates every frame. */
+struct FRoomAcousticSource
+{
+	TWeakObjectPtr<UAudioComponent> AudioComponent;
+
+	/** The room the source is in, and the location at which that was determined. */
+	int32 Room {0};
+	FVector RoomLocation {FVector::ZeroVector};
+	bool HasRoom {false};
+
+	FRoomSoundPropagation Propagation;
+};
+
+/** Propagates sound through the graph of rooms and portals.
+ *	Paths from the portals of the listener's room to every other portal are solved only when the listener changes room or a door changes state.
+ *	Evaluating a source is then a lookup over the portals of its room, so it costs no traces. */
+UCLASS(ClassGroup = "Room System", Meta = (DisplayName = "Room Acoustics Subsystem"))
+class STORMWATCH_API URoomAcousticsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogRoomAcoustics, Log, All)
+
+public:
+	/** Delegate that is broadcast after the rooms and portals of the graph have been rebuilt. */
+	FOnRoomGraphChangedDelegate OnRoomGraphRebuilt;
+
+	/** Delegate that is broadcast when the listener has moved to another room. */
+	FOnRoomGraphChangedDelegate OnListenerRoomChanged;
+
+private:
+	UPROPERTY()
+	URoomLookupSubsystem* RoomLookupSubsystem;
+
+	/** The rooms in the graph. Index 0 is reserved for the exterior. */
+	TArray<TWeakObjectPtr<ARoomVolume>> Rooms;
+	TMap<const ARoomVolume*, int32> RoomIndices;
+
+	TArray<FRoomAcousticPortal> Portals;
+
+	/** The indices of the portals of every room. */
+	TArray<TArray<int32>> RoomPortals;
+
+	/** The room the listener is in, and the rooms the player has entered but not left yet, in the order they were entered. */
+	int32 ListenerRoom {0};
+	TArray<TWeakObjectPtr<ARoomVolume>> PlayerRooms;
+
+	FVector ListenerLocation {FVector::ZeroVector};
+
+	/** The portals of the listener's room, and for each of them the path cost, distance and transmission to every portal in the graph. */
+	TArray<int32> ListenerPortals;
+	TArray<float> PathCosts;
+	TArray<float> PathDistances;
+	TArray<float> PathTransmissions;
+
+	TArray<FRoomAcousticSource> Sources;
+
+	/** If true, the graph is rebuilt from the rooms on the next tick. */
+	bool IsGraphDirty {false};
+
+	/** If true, the paths are solved again on the next tick. */
+	bool IsSolutionDirty {false};
+
+	/** The distance a closed portal adds to a path, so that open paths are preferred. */
+	static constexpr float ClosedPortalCost {1500.0f};
+
+	/** The distance a source has to move before the room it is in is determined again. */
+	static constexpr float SourceRoomUpdateDistance {50.0f};
+
+	/** The low pass filter frequency of a source without and with full occlusion. */
+	static constexpr float UnoccludedLowPassFrequency {20000.0f};
+	static constexpr float OccludedLowPassFrequency {600.0f};
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Adds a room to the graph. Called by the room on BeginPlay. */
+	void RegisterRoom(ARoomVolume* Room);
+
+	/** Removes a room from the graph. Called by the room on EndPlay. */
+	void UnregisterRoom(ARoomVolume* Room);
+
+	/** Called by a room when the player enters or leaves it. */
+	void HandlePlayerEnterRoom(ARoomVolume* Room);
+	void HandlePlayerLeaveRoom(ARoomVolume* Room);
+
+	/** Registers an audio component, so that its occlusion is updated every frame.
+	 *	The occlusion is applied as a low pass filter, and as the Room_Occlusion and Room_Obstruction parameters of the sound. */
+	UFUNCTION(BlueprintCallable, Category = "Room Acoustics")
+	void RegisterSource(UAudioComponent* AudioComponent);
+
+	UFUNCTION(BlueprintCallable, Category = "Room Acoustics")
+	void UnregisterSource(UAudioComponent* AudioComponent);
+
+	/** Returns the propagation of a registered source as of the last update. */
+	UFUNCTION(BlueprintPure, Category = "Room Acoustics")
+	FRoomSoundPropagation GetSourcePropagation(const UAudioComponent* AudioComponent) const;
+
+	/** Calculates how a sound at a location reaches the listener. */
+	UFUNCTION(BlueprintCallable, Category = "Room Acoustics")
+	FRoomSoundPropagation CalculatePropagation(const FVector& Location) const;
+
+	/** Returns the room that contains a location, or nullptr if the location is outside. */
+	UFUNCTION(BlueprintPure, Category = "Room Acoustics")
+	ARoomVolume* FindRoomAtLocation(const FVector& Location) const;
+
+	/** Returns the room the listener is in, or nullptr if the listener is outside. */
+	UFUNCTION(BlueprintPure, Category = "Room Acoustics")
+	ARoomVolume* GetListenerRoom() const;
+
+	/** Finds the rooms that can be reached from a room by passing through at most a number of portals, including the room itself.
+	 *	The exterior is represented by nullptr. */
+	void FindRoomsWithinPortals(const ARoomVolume* Room, const int32 PortalCount, TSet<const ARoomVolume*>& OutRooms) const;
+
+	/** Finds the rooms on either side of the portals that are closed by a door. The exterior is represented by nullptr. */
+	void FindRoomsConnectedByDoor(const ASlidingDoor* Door, TArray<const ARoomVolume*>& OutRooms) const;
+
+private:
+	/** Rebuilds the rooms and portals of the graph from the registered rooms. */
+	void RebuildGraph();
+
+	/** Determines the listener room from the rooms the player is in. */
+	void UpdateListenerRoom();
+
+	/** Updates the occlusion of every portal from its door, and solves the paths from the portals of the listener's room. */
+	void SolvePaths();
+
+	/** Returns the index of the room that contains a location, or 0 if the location is outside. */
+	int32 FindRoomIndexAtLocation(const FVector& Location) const;
+
+	/** Calculates how a sound at a location in a room reaches the listener. */
+	FRoomSoundPropagation CalculatePropagation(const FVector& Location, const int32 Room) const;
+
+	UFUNCTION()
+	void HandleDoorStateChanged(EDoorState State);
+};
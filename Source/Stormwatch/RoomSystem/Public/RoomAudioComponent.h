@@ -30,6 +30,8 @@ protected:
 	virtual void ConstructComponent() override;
 
 private:
+	/** Returns the impulse response in a data table that best matches the room parameters.
+	 *	The data table is indexed by the room reverb subsystem the first time it is used, after which every match is a tree lookup. */
 	UFUNCTION(BlueprintCallable)
 	USubmixEffectConvolutionReverbPreset* FindMatchingImpulseResponseFromDataTable(UDataTable* DataTable, const float Volume, const float ShapeRatio, const float Reflectivity);
 };
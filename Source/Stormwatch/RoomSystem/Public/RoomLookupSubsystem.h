@@ -0,0 +1,115 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RoomLookupSubsystem.generated.h"
+
+class ARoomVolume;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnActorRoomChangedDelegate, AActor*, Actor, ARoomVolume*, PreviousRoom, ARoomVolume*, NewRoom);
+
+/** A node of the room bounding volume hierarchy. A node is either a leaf with a range of rooms, or has two children. */
+struct FRoomLookupNode
+{
+	FBox Bounds {ForceInit};
+
+	/** The index of the first child, or of the first room for a leaf. The second child always follows the first. */
+	int32 Index {0};
+
+	/** The amount of rooms in a leaf, or zero for an inner node. */
+	int32 RoomCount {0};
+};
+
+/** A room in the bounding volume hierarchy. */
+struct FRoomLookupEntry
+{
+	TWeakObjectPtr<ARoomVolume> Room;
+	FBox Bounds {ForceInit};
+
+	/** The volume of the room, used to prefer the innermost room when rooms are nested. */
+	double Volume {0.0};
+
+	/** If true, other rooms overlap this one, so an actor inside it might also be inside another room. */
+	bool HasOverlappingRooms {false};
+};
+
+/** An actor whose room membership is tracked. */
+struct FRoomTrackedActor
+{
+	TWeakObjectPtr<AActor> Actor;
+	TWeakObjectPtr<ARoomVolume> Room;
+	int32 Entry {INDEX_NONE};
+};
+
+/** Answers which room a location is in without physics overlaps.
+ *	The room volumes are stored in a static bounding volume hierarchy that is built when the level starts, and rebuilt when rooms stream in or out.
+ *	Tracked actors only query the hierarchy when they leave the bounds of their cached room. */
+UCLASS(ClassGroup = "Room System", Meta = (DisplayName = "Room Lookup Subsystem"))
+class STORMWATCH_API URoomLookupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogRoomLookup, Log, All)
+
+public:
+	/** Delegate that is broadcast when a tracked actor moves to another room. A null room is the exterior. */
+	UPROPERTY(BlueprintAssignable, Category = "Delegates")
+	FOnActorRoomChangedDelegate OnActorRoomChanged;
+
+private:
+	TArray<FRoomLookupEntry> Entries;
+	TArray<FRoomLookupNode> Nodes;
+
+	TArray<FRoomTrackedActor> TrackedActors;
+
+	/** If true, the world has begun play and rooms that register afterwards cause a rebuild. */
+	bool HasWorldBegunPlay {false};
+
+	/** The maximum amount of rooms in a leaf node. */
+	static constexpr int32 MaxLeafRoomCount {2};
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Adds a room that has streamed in. Called by the room on BeginPlay. */
+	void RegisterRoom(ARoomVolume* Room);
+
+	/** Removes a room that is streaming out. Called by the room on EndPlay. */
+	void UnregisterRoom(ARoomVolume* Room);
+
+	/** Returns the innermost room that contains a location, or nullptr if the location is outside. */
+	UFUNCTION(BlueprintPure, Category = "Room Lookup")
+	ARoomVolume* FindRoomAtLocation(const FVector& Location) const;
+
+	/** Finds the rooms whose bounds overlap a box. */
+	UFUNCTION(BlueprintCallable, Category = "Room Lookup")
+	void FindRoomsInBox(const FBox& Box, TArray<ARoomVolume*>& OutRooms) const;
+
+	/** Starts tracking the room an actor is in. */
+	UFUNCTION(BlueprintCallable, Category = "Room Lookup")
+	void TrackActor(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable, Category = "Room Lookup")
+	void UntrackActor(AActor* Actor);
+
+	/** Returns the cached room of a tracked actor, or looks up the room of an untracked actor. */
+	UFUNCTION(BlueprintPure, Category = "Room Lookup")
+	ARoomVolume* GetActorRoom(const AActor* Actor) const;
+
+private:
+	/** Rebuilds the hierarchy from the rooms in the entries. */
+	void RebuildHierarchy();
+
+	/** Builds a node and its children for a range of entries. */
+	void BuildNode(const int32 NodeIndex, const int32 Begin, const int32 End);
+
+	/** Returns the index of the innermost entry that contains a location, or INDEX_NONE if the location is outside. */
+	int32 FindEntryAtLocation(const FVector& Location) const;
+};
@@ -0,0 +1,89 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RoomRelevanceSubsystem.generated.h"
+
+class ARoomVolume;
+class URoomAcousticsSubsystem;
+
+/** An actor whose activity depends on whether the player is near its room. */
+struct FRoomRelevantActor
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	/** The rooms the actor belongs to. The exterior is represented by nullptr. Doors belong to the rooms on both sides. */
+	TArray<const ARoomVolume*> Rooms;
+	bool HasRooms {false};
+
+	bool IsSuspended {false};
+
+	/** The state that was disabled on suspension, so that only that state is restored on resumption. */
+	bool IsActorTickSuspended {false};
+	TArray<TWeakObjectPtr<UActorComponent>> SuspendedTickComponents;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> SuspendedHitComponents;
+};
+
+/** Suspends registered actors in rooms that are too far from the player's room to be seen or heard.
+ *	Rooms are relevant if they can be reached from the player's room through a limited number of portals of the room graph.
+ *	Suspended actors have their ticks and hit notifications disabled, and are notified through the room relevant object interface
+ *	so they can pause their timers. */
+UCLASS(ClassGroup = "Room System", Meta = (DisplayName = "Room Relevance Subsystem"))
+class STORMWATCH_API URoomRelevanceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogRoomRelevance, Log, All)
+
+private:
+	UPROPERTY()
+	URoomAcousticsSubsystem* RoomAcousticsSubsystem;
+
+	TArray<FRoomRelevantActor> Actors;
+
+	/** The rooms that are currently relevant. The exterior is represented by nullptr. */
+	TSet<const ARoomVolume*> RelevantRooms;
+
+	/** The amount of portals between the player's room and the furthest relevant room. */
+	int32 RelevantPortalCount {1};
+
+	/** If false, the room graph has not been built yet and every actor is kept relevant. */
+	bool HasRoomGraph {false};
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Registers an actor, so that it is suspended when the player is too far away from its room.
+	 *	Only register actors that do not move between rooms. */
+	UFUNCTION(BlueprintCallable, Category = "Room Relevance")
+	void RegisterActor(AActor* Actor);
+
+	/** Unregisters an actor and resumes it if it was suspended. */
+	UFUNCTION(BlueprintCallable, Category = "Room Relevance")
+	void UnregisterActor(AActor* Actor);
+
+	/** Sets the amount of portals between the player's room and the furthest room that is kept active. */
+	UFUNCTION(BlueprintCallable, Category = "Room Relevance")
+	void SetRelevantPortalCount(const int32 PortalCount);
+
+	/** Returns whether an actor is currently suspended. */
+	UFUNCTION(BlueprintPure, Category = "Room Relevance")
+	bool IsActorSuspended(const AActor* Actor) const;
+
+private:
+	/** Called when the room graph has been rebuilt. Every actor has to find its rooms again. */
+	void HandleRoomGraphRebuilt();
+
+	/** Updates the relevant rooms, and suspends or resumes every actor accordingly. */
+	void UpdateRelevance();
+
+	/** Updates the state of a single actor. */
+	void UpdateActor(FRoomRelevantActor& RelevantActor);
+
+	void SuspendActor(FRoomRelevantActor& RelevantActor);
+	void ResumeActor(FRoomRelevantActor& RelevantActor);
+};
@@ -0,0 +1,65 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RoomReverbSubsystem.generated.h"
+
+class UDataTable;
+class USubmixEffectConvolutionReverbPreset;
+
+/** A k-d tree over the rows of a room reverb data table, for finding the impulse response that best matches a room.
+ *	The tree is stored implicitly: the node of a range is its middle element, and its children are the halves on either side. */
+USTRUCT()
+struct FRoomReverbIndex
+{
+	GENERATED_BODY()
+
+	/** The weighted room parameters of every row. */
+	UPROPERTY()
+	TArray<FVector3f> Points;
+
+	/** The impulse response of every row, indexed the same as Points. */
+	UPROPERTY()
+	TArray<USubmixEffectConvolutionReverbPreset*> ImpulseResponses;
+
+	/** The handle of the change delegate of the data table the tree was built from. */
+	FDelegateHandle DataTableChangedHandle;
+
+	/** Builds the tree from the rows of a data table with FRoomReverbSettings rows. */
+	void Build(const UDataTable* DataTable);
+
+	/** Returns the impulse response of the row closest to the room parameters, or nullptr if the tree is empty. */
+	USubmixEffectConvolutionReverbPreset* FindNearest(const float Volume, const float ShapeRatio, const float Reflectivity) const;
+
+	/** Converts room parameters to a point in the tree, weighted so that the distance between points is the match difference. */
+	static FVector3f MakePoint(const float Volume, const float ShapeRatio, const float Reflectivity);
+};
+
+/** Matches rooms against the impulse responses in room reverb data tables.
+ *	Every data table is indexed the first time it is matched against, after which every match is a tree lookup.
+ *	The indices live as long as the world, so they never outlive a play session. */
+UCLASS(ClassGroup = "Room System", Meta = (DisplayName = "Room Reverb Subsystem"))
+class STORMWATCH_API URoomReverbSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+private:
+	/** The index of every data table that has been matched against. */
+	UPROPERTY()
+	TMap<UDataTable*, FRoomReverbIndex> Indices;
+
+public:
+	virtual void Deinitialize() override;
+
+	/** Returns the impulse response in a data table that best matches the room parameters. */
+	USubmixEffectConvolutionReverbPreset* FindMatchingImpulseResponse(UDataTable* DataTable, const float Volume, const float ShapeRatio, const float Reflectivity);
+
+private:
+#if WITH_EDITOR
+	/** Rows can be edited while the editor is running, so the index of a data table is rebuilt when it changes. */
+	void HandleDataTableChanged(UDataTable* DataTable);
+#endif
+};
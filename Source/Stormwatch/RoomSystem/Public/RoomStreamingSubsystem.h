@@ -0,0 +1,133 @@
+// Copyright (c) 2022-present Barrelhouse. All rights reserved.
+// Written by Tim Verberne.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RoomStreamingSubsystem.generated.h"
+
+class ARoomVolume;
+class ULevelStreaming;
+class URoomAcousticsSubsystem;
+class URoomLookupSubsystem;
+
+/** Instrumentation of the room streaming. */
+USTRUCT(BlueprintType)
+struct FRoomStreamingStats
+{
+	GENERATED_BODY()
+
+	/** The amount of room sublevels that are loaded. */
+	UPROPERTY(BlueprintReadOnly, Category = "Room Streaming")
+	int32 LoadedLevelCount {0};
+
+	/** The amount of room sublevels that are loading or unloading. */
+	UPROPERTY(BlueprintReadOnly, Category = "Room Streaming")
+	int32 PendingLevelCount {0};
+
+	/** The time between requesting the last sublevel and it becoming visible. */
+	UPROPERTY(BlueprintReadOnly, Category = "Room Streaming", Meta = (Units = "Seconds"))
+	float LastLoadTime {0.0f};
+
+	UPROPERTY(BlueprintReadOnly, Category = "Room Streaming", Meta = (Units = "Seconds"))
+	float MaxLoadTime {0.0f};
+
+	/** The change in used physical memory while the last sublevel was loading. Other allocations in that time are included. */
+	UPROPERTY(BlueprintReadOnly, Category = "Room Streaming", Meta = (Units = "Megabytes"))
+	float LastLoadMemory {0.0f};
+
+	/** The amount of frames that exceeded the hitch threshold while sublevels were streaming. */
+	UPROPERTY(BlueprintReadOnly, Category = "Room Streaming")
+	int32 HitchCount {0};
+
+	UPROPERTY(BlueprintReadOnly, Category = "Room Streaming", Meta = (Units = "Seconds"))
+	float LongestHitch {0.0f};
+};
+
+/** A streaming sublevel that is owned by one or more rooms. */
+struct FRoomStreamingLevel
+{
+	TWeakObjectPtr<ULevelStreaming> Level;
+	TArray<TWeakObjectPtr<ARoomVolume>> Rooms;
+
+	/** The time and used physical memory at which the level was requested to load, or a negative time if it is not loading. */
+	double LoadStartTime {-1.0};
+	uint64 LoadStartMemory {0};
+};
+
+/** Streams the sublevels of rooms in and out based on the room the player is in.
+ *	The rooms within a number of portals of the player's room are loaded, and so are the rooms around the location the player is heading to.
+ *	Rooms are only unloaded once they are further away than the unload distance, so that walking back and forth over a portal does not thrash. */
+UCLASS(Config = Game, ClassGroup = "Room System", Meta = (DisplayName = "Room Streaming Subsystem"))
+class STORMWATCH_API URoomStreamingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	DECLARE_LOG_CATEGORY_CLASS(LogRoomStreaming, Log, All)
+
+private:
+	/** The amount of portals between the player's room and the furthest room that is loaded. */
+	UPROPERTY(Config)
+	int32 LoadPortalCount {1};
+
+	/** Rooms that are more portals away from the player's room than this are unloaded. Should exceed the load portal count. */
+	UPROPERTY(Config)
+	int32 UnloadPortalCount {2};
+
+	/** How far ahead the player's velocity is extrapolated to prefetch the rooms the player is heading to. */
+	UPROPERTY(Config)
+	float PrefetchTime {1.0f};
+
+	/** How far along the player's view direction rooms are prefetched. */
+	UPROPERTY(Config)
+	float PrefetchViewDistance {500.0f};
+
+	/** The time between two streaming updates. */
+	UPROPERTY(Config)
+	float UpdateInterval {0.2f};
+
+	/** Frames that take longer than this while sublevels are streaming are counted as hitches. */
+	UPROPERTY(Config)
+	float HitchThreshold {0.05f};
+
+	UPROPERTY()
+	URoomAcousticsSubsystem* RoomAcousticsSubsystem;
+
+	UPROPERTY()
+	URoomLookupSubsystem* RoomLookupSubsystem;
+
+	TArray<FRoomStreamingLevel> Levels;
+
+	FRoomStreamingStats Stats;
+
+	float UpdateTimer {0.0f};
+
+	/** If false, the room graph has not been built yet and no levels are streamed. */
+	bool HasRoomGraph {false};
+
+	/** If true, the frame after the last streaming change is still checked for a hitch. */
+	bool IsHitchCheckPending {false};
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Returns the instrumentation of the room streaming. */
+	UFUNCTION(BlueprintPure, Category = "Room Streaming")
+	FORCEINLINE FRoomStreamingStats GetStreamingStats() const { return Stats; }
+
+private:
+	/** Determines which levels should be loaded and requests the changes. */
+	void UpdateStreaming();
+
+	/** Tracks the levels that are loading and the hitches they cause. */
+	void UpdateInstrumentation(const float DeltaTime);
+
+	/** Adds the rooms around a location to a set of rooms. */
+	void AddRoomsAroundLocation(const FVector& Location, const int32 PortalCount, TSet<const ARoomVolume*>& OutRooms) const;
+};
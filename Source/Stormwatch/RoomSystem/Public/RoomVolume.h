@@ -9,10 +9,39 @@
 
 class APlayerCharacter;
 class ANightstalker;
+class ASlidingDoor;
+class ARoomVolume;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPawnEnterDelegate, APawn*, Pawn);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnpawnLeaveDelegate, APawn*, Pawn);
 
+/** An opening through which sound travels from one room to another. */
+USTRUCT(BlueprintType)
+struct FRoomPortal
+{
+	GENERATED_BODY()
+
+	/** The room on the other side of the portal. If not set, the portal leads to the exterior. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Portal")
+	TSoftObjectPtr<ARoomVolume> ConnectedRoom;
+
+	/** The location of the portal, relative to the room. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Portal", Meta = (MakeEditWidget))
+	FVector Location {FVector::ZeroVector};
+
+	/** The door that closes the portal, if any. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Portal")
+	TSoftObjectPtr<ASlidingDoor> Door;
+
+	/** The occlusion that sound picks up when it passes through the portal while it is open. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Portal", Meta = (ClampMin = "0", ClampMax = "1", UIMin = "0", UIMax = "1"))
+	float OpenOcclusion {0.1f};
+
+	/** The occlusion that sound picks up when it passes through the portal while its door is closed. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Portal", Meta = (ClampMin = "0", ClampMax = "1", UIMin = "0", UIMax = "1"))
+	float ClosedOcclusion {0.85f};
+};
+
 UCLASS(Abstract, Blueprintable, BlueprintType, ClassGroup = "Room System")
 class ARoomVolume : public ATriggerBox
 {
@@ -28,12 +57,27 @@ public:
 	FOnpawnLeaveDelegate OnPawnLeave;
 
 protected:
+	/** The air volume of the room. Computed by analyzing the room. */
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Category = "Volume", Meta = (ForceUnits = "m3"))
 	float Volume {0.0f};
 
+	/** The ratio between the shortest and longest dimension of the room. Computed by analyzing the room. */
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Category = "Volume")
 	float RoomRatio {0.0f};
 
+	/** The fraction of sound that stays inside the room, rather than escaping through openings. Computed by analyzing the room. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Category = "Volume")
+	float Reflectivity {0.5f};
+
+	/** The portals through which sound travels to adjacent rooms. Portals only have to be added to one of the two rooms they connect. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Acoustics")
+	TArray<FRoomPortal> Portals;
+
+	/** The streaming sublevel that contains the contents of the room. The sublevel is loaded when the player is near the room.
+	 *	The room volume itself has to be placed in the persistent level. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Streaming")
+	TSoftObjectPtr<UWorld> StreamingLevel;
+
 private:
 	UPROPERTY(BlueprintGetter = GetOverlappingPawns)
 	TArray<APawn*> OverlappingPawns;
@@ -43,13 +87,35 @@ public:
 
 protected:
 	virtual void PostInitProperties() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnConstruction(const FTransform& Transform) override;
 	virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
 	virtual void NotifyActorEndOverlap(AActor* OtherActor) override;
 
 public:
 	UFUNCTION(BlueprintGetter)
-	FORCEINLINE TArray<APawn*> GetOverlappingPawns() const { return OverlappingPawns; }
+	FORCEINLINE const TArray<APawn*>& GetOverlappingPawns() const { return OverlappingPawns; }
+
+	FORCEINLINE float GetVolume() const { return Volume; }
+	FORCEINLINE float GetRoomRatio() const { return RoomRatio; }
+	FORCEINLINE float GetReflectivity() const { return Reflectivity; }
+
+	FORCEINLINE const TSoftObjectPtr<UWorld>& GetStreamingLevel() const { return StreamingLevel; }
+
+	/** Returns the portals of the room. Portal locations are relative to the room. */
+	FORCEINLINE const TArray<FRoomPortal>& GetPortals() const { return Portals; }
+
+	/** Returns whether a world location is inside the room. */
+	UFUNCTION(BlueprintPure, Category = "Room")
+	bool IsLocationInRoom(const FVector& Location) const;
+
+#if WITH_EDITOR
+	/** Computes the volume, shape ratio and reflectivity of the room by tracing the geometry inside it,
+	 *	and reconstructs the room components so they can match the result. */
+	UFUNCTION(CallInEditor, Category = "Volume")
+	void AnalyzeRoom();
+#endif
 };
 
 